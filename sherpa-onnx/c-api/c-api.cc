@@ -28,6 +28,7 @@
 #include "sherpa-onnx/csrc/online-punctuation.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/resample.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/speaker-embedding-extractor.h"
 #include "sherpa-onnx/csrc/speaker-embedding-manager.h"
 #include "sherpa-onnx/csrc/spoken-language-identification.h"
@@ -219,6 +220,12 @@ void SherpaOnnxOnlineStreamAcceptWaveform(const SherpaOnnxOnlineStream *stream,
   stream->impl->AcceptWaveform(sample_rate, samples, n);
 }
 
+void SherpaOnnxOnlineStreamAcceptWaveformInt16(
+    const SherpaOnnxOnlineStream *stream, int32_t sample_rate,
+    const int16_t *samples, int32_t n) {
+  stream->impl->AcceptWaveform(sample_rate, samples, n);
+}
+
 int32_t SherpaOnnxIsOnlineStreamReady(
     const SherpaOnnxOnlineRecognizer *recognizer,
     const SherpaOnnxOnlineStream *stream) {
@@ -345,6 +352,27 @@ int32_t SherpaOnnxOnlineStreamIsEndpoint(
   return recognizer->impl->IsEndpoint(stream->impl.get());
 }
 
+void SherpaOnnxOnlineRecognizerEnableStats(
+    const SherpaOnnxOnlineRecognizer *recognizer, int32_t enable) {
+  recognizer->impl->EnableStats(enable != 0);
+}
+
+const char *SherpaOnnxOnlineRecognizerGetStatsAsJson(
+    const SherpaOnnxOnlineRecognizer *recognizer) {
+  std::string json = recognizer->impl->GetStats().ToString();
+  char *pJson = new char[json.size() + 1];
+  std::copy(json.begin(), json.end(), pJson);
+  pJson[json.size()] = 0;
+  return pJson;
+}
+
+void SherpaOnnxOnlineRecognizerFreeStatsJson(const char *s) { delete[] s; }
+
+void SherpaOnnxOnlineRecognizerResetStats(
+    const SherpaOnnxOnlineRecognizer *recognizer) {
+  recognizer->impl->ResetStats();
+}
+
 const SherpaOnnxDisplay *SherpaOnnxCreateDisplay(int32_t max_word_per_line) {
   SherpaOnnxDisplay *ans = new SherpaOnnxDisplay;
   ans->impl = std::make_unique<sherpa_onnx::Display>(max_word_per_line);
@@ -575,6 +603,12 @@ void SherpaOnnxAcceptWaveformOffline(const SherpaOnnxOfflineStream *stream,
   stream->impl->AcceptWaveform(sample_rate, samples, n);
 }
 
+void SherpaOnnxAcceptWaveformOfflineInt16(const SherpaOnnxOfflineStream *stream,
+                                          int32_t sample_rate,
+                                          const int16_t *samples, int32_t n) {
+  stream->impl->AcceptWaveform(sample_rate, samples, n);
+}
+
 void SherpaOnnxDecodeOfflineStream(
     const SherpaOnnxOfflineRecognizer *recognizer,
     const SherpaOnnxOfflineStream *stream) {
@@ -1992,6 +2026,18 @@ int32_t SherpaOnnxFileExists(const char *filename) {
   return sherpa_onnx::FileExists(filename);
 }
 
+int32_t SherpaOnnxInitOrtGlobalContext(int32_t num_threads,
+                                       int32_t share_prepacked_weights) {
+  sherpa_onnx::OrtGlobalContextConfig config;
+  config.num_threads = num_threads;
+  config.share_prepacked_weights = share_prepacked_weights;
+  return sherpa_onnx::InitOrtGlobalContext(config);
+}
+
+void SherpaOnnxSetOptimizedModelCacheDir(const char *dir) {
+  sherpa_onnx::SetOptimizedModelCacheDir(SHERPA_ONNX_OR(dir, ""));
+}
+
 struct SherpaOnnxOfflineSpeechDenoiser {
   std::unique_ptr<sherpa_onnx::OfflineSpeechDenoiser> impl;
 };
@@ -261,6 +261,13 @@ SHERPA_ONNX_API void SherpaOnnxOnlineStreamAcceptWaveform(
     const SherpaOnnxOnlineStream *stream, int32_t sample_rate,
     const float *samples, int32_t n);
 
+/// Same as SherpaOnnxOnlineStreamAcceptWaveform() except that the samples
+/// are 16-bit PCM, i.e., in the range [-32768, 32767]. They are converted
+/// to float inside sherpa-onnx, so you don't need to convert them yourself.
+SHERPA_ONNX_API void SherpaOnnxOnlineStreamAcceptWaveformInt16(
+    const SherpaOnnxOnlineStream *stream, int32_t sample_rate,
+    const int16_t *samples, int32_t n);
+
 /// Return 1 if there are enough number of feature frames for decoding.
 /// Return 0 otherwise.
 ///
@@ -352,6 +359,29 @@ SHERPA_ONNX_API int32_t
 SherpaOnnxOnlineStreamIsEndpoint(const SherpaOnnxOnlineRecognizer *recognizer,
                                  const SherpaOnnxOnlineStream *stream);
 
+/// Enable or disable the latency statistics of the recognizer.
+/// It is disabled by default.
+///
+/// @param recognizer A pointer returned by SherpaOnnxCreateOnlineRecognizer().
+/// @param enable 1 to enable. 0 to disable.
+SHERPA_ONNX_API void SherpaOnnxOnlineRecognizerEnableStats(
+    const SherpaOnnxOnlineRecognizer *recognizer, int32_t enable);
+
+/// Return the latency statistics collected so far as a json string, which
+/// contains p50/p95/p99 latencies and the real-time factor of each stage
+/// of decoding.
+///
+/// The user has to invoke SherpaOnnxOnlineRecognizerFreeStatsJson()
+/// to free the returned pointer to avoid memory leak
+SHERPA_ONNX_API const char *SherpaOnnxOnlineRecognizerGetStatsAsJson(
+    const SherpaOnnxOnlineRecognizer *recognizer);
+
+SHERPA_ONNX_API void SherpaOnnxOnlineRecognizerFreeStatsJson(const char *s);
+
+/// Clear the latency statistics collected so far.
+SHERPA_ONNX_API void SherpaOnnxOnlineRecognizerResetStats(
+    const SherpaOnnxOnlineRecognizer *recognizer);
+
 // for displaying results on Linux/macOS.
 SHERPA_ONNX_API typedef struct SherpaOnnxDisplay SherpaOnnxDisplay;
 
@@ -536,6 +566,14 @@ SHERPA_ONNX_API void SherpaOnnxDestroyOfflineStream(
 SHERPA_ONNX_API void SherpaOnnxAcceptWaveformOffline(
     const SherpaOnnxOfflineStream *stream, int32_t sample_rate,
     const float *samples, int32_t n);
+
+/// Same as SherpaOnnxAcceptWaveformOffline() except that the samples
+/// are 16-bit PCM, i.e., in the range [-32768, 32767].
+///
+/// @caution: For each offline stream, please invoke this function only once!
+SHERPA_ONNX_API void SherpaOnnxAcceptWaveformOfflineInt16(
+    const SherpaOnnxOfflineStream *stream, int32_t sample_rate,
+    const int16_t *samples, int32_t n);
 /// Decode an offline stream.
 ///
 /// We assume you have invoked SherpaOnnxAcceptWaveformOffline() for the given
@@ -1531,6 +1569,26 @@ SHERPA_ONNX_API int32_t SherpaOnnxLinearResamplerResampleGetOutputSampleRate(
 // Return 1 if the file exists; return 0 if the file does not exist.
 SHERPA_ONNX_API int32_t SherpaOnnxFileExists(const char *filename);
 
+// Enable a process-wide ONNX Runtime context shared by all models, e.g.,
+// recognizers, VAD, punctuation and speaker embedding extractors.
+//
+// All sessions use global thread pools with num_threads threads, instead
+// of one thread pool per session. If share_prepacked_weights is 1,
+// sessions loading the same model keep only one copy of prepacked weights.
+//
+// It must be called before creating any model.
+// Return 1 on success; return 0 otherwise.
+SHERPA_ONNX_API int32_t SherpaOnnxInitOrtGlobalContext(
+    int32_t num_threads, int32_t share_prepacked_weights);
+
+// Cache models with the hardware independent optimizations of ONNX Runtime
+// in the given existing directory, so that later loads of the same models
+// are faster. NULL or an empty string disables the cache. If it is never
+// called, the environment variable SHERPA_ONNX_MODEL_CACHE_DIR is used.
+//
+// It should be called before creating any model.
+SHERPA_ONNX_API void SherpaOnnxSetOptimizedModelCacheDir(const char *dir);
+
 // =========================================================================
 // For offline speaker diarization (i.e., non-streaming speaker diarization)
 // =========================================================================
@@ -41,6 +41,11 @@ void OnlineStream::AcceptWaveform(int32_t sample_rate, const float *samples,
   SherpaOnnxOnlineStreamAcceptWaveform(p_, sample_rate, samples, n);
 }
 
+void OnlineStream::AcceptWaveform(int32_t sample_rate, const int16_t *samples,
+                                  int32_t n) const {
+  SherpaOnnxOnlineStreamAcceptWaveformInt16(p_, sample_rate, samples, n);
+}
+
 void OnlineStream::InputFinished() const {
   SherpaOnnxOnlineStreamInputFinished(p_);
 }
@@ -140,6 +145,21 @@ bool OnlineRecognizer::IsEndpoint(const OnlineStream *s) const {
   return SherpaOnnxOnlineStreamIsEndpoint(p_, s->Get());
 }
 
+void OnlineRecognizer::EnableStats(bool enable /*= true*/) const {
+  SherpaOnnxOnlineRecognizerEnableStats(p_, enable);
+}
+
+std::string OnlineRecognizer::GetStatsAsJson() const {
+  const char *s = SherpaOnnxOnlineRecognizerGetStatsAsJson(p_);
+  std::string ans = s;
+  SherpaOnnxOnlineRecognizerFreeStatsJson(s);
+  return ans;
+}
+
+void OnlineRecognizer::ResetStats() const {
+  SherpaOnnxOnlineRecognizerResetStats(p_);
+}
+
 void OnlineRecognizer::Decode(const OnlineStream *ss, int32_t n) const {
   if (n <= 0) {
     return;
@@ -192,6 +212,11 @@ void OfflineStream::AcceptWaveform(int32_t sample_rate, const float *samples,
   SherpaOnnxAcceptWaveformOffline(p_, sample_rate, samples, n);
 }
 
+void OfflineStream::AcceptWaveform(int32_t sample_rate, const int16_t *samples,
+                                   int32_t n) const {
+  SherpaOnnxAcceptWaveformOfflineInt16(p_, sample_rate, samples, n);
+}
+
 OfflineRecognizer OfflineRecognizer::Create(
     const OfflineRecognizerConfig &config) {
   struct SherpaOnnxOfflineRecognizerConfig c;
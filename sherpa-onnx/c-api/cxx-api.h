@@ -165,6 +165,10 @@ class SHERPA_ONNX_API OnlineStream
   void AcceptWaveform(int32_t sample_rate, const float *samples,
                       int32_t n) const;
 
+  // samples are 16-bit PCM, i.e., in the range [-32768, 32767]
+  void AcceptWaveform(int32_t sample_rate, const int16_t *samples,
+                      int32_t n) const;
+
   void InputFinished() const;
 
   void Destroy(const SherpaOnnxOnlineStream *p) const;
@@ -193,6 +197,13 @@ class SHERPA_ONNX_API OnlineRecognizer
 
   bool IsEndpoint(const OnlineStream *s) const;
 
+  void EnableStats(bool enable = true) const;
+
+  // Return the latency statistics as a json string
+  std::string GetStatsAsJson() const;
+
+  void ResetStats() const;
+
  private:
   explicit OnlineRecognizer(const SherpaOnnxOnlineRecognizer *p);
 };
@@ -309,6 +320,10 @@ class SHERPA_ONNX_API OfflineStream
   void AcceptWaveform(int32_t sample_rate, const float *samples,
                       int32_t n) const;
 
+  // samples are 16-bit PCM, i.e., in the range [-32768, 32767]
+  void AcceptWaveform(int32_t sample_rate, const int16_t *samples,
+                      int32_t n) const;
+
   void Destroy(const SherpaOnnxOfflineStream *p) const;
 };
 
@@ -0,0 +1,51 @@
+// sherpa-onnx/csrc/cpu-affinity-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/cpu-affinity.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(ParseCpuList, Valid) {
+  EXPECT_EQ(ParseCpuList("3"), std::vector<int32_t>({3}));
+  EXPECT_EQ(ParseCpuList("0-3"), std::vector<int32_t>({0, 1, 2, 3}));
+  EXPECT_EQ(ParseCpuList("8,0-1, 10-11\n"),
+            std::vector<int32_t>({0, 1, 8, 10, 11}));
+
+  // Duplicates are removed
+  EXPECT_EQ(ParseCpuList("1-2,2"), std::vector<int32_t>({1, 2}));
+}
+
+TEST(ParseCpuList, Invalid) {
+  EXPECT_TRUE(ParseCpuList("").empty());
+  EXPECT_TRUE(ParseCpuList("a").empty());
+  EXPECT_TRUE(ParseCpuList("3-1").empty());
+  EXPECT_TRUE(ParseCpuList("1,,2").empty());
+  EXPECT_TRUE(ParseCpuList("-1").empty());
+  EXPECT_TRUE(ParseCpuList("1-").empty());
+}
+
+TEST(ScopedThreadAffinity, Restore) {
+  std::vector<int32_t> saved;
+  if (!GetThreadAffinity(&saved)) {
+    GTEST_SKIP() << "Not supported on this platform";
+  }
+
+  {
+    ScopedThreadAffinity affinity({saved[0]});
+
+    std::vector<int32_t> cpus;
+    ASSERT_TRUE(GetThreadAffinity(&cpus));
+    EXPECT_EQ(cpus, std::vector<int32_t>({saved[0]}));
+  }
+
+  std::vector<int32_t> cpus;
+  ASSERT_TRUE(GetThreadAffinity(&cpus));
+  EXPECT_EQ(cpus, saved);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,146 @@
+// sherpa-onnx/csrc/cpu-affinity.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/cpu-affinity.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace sherpa_onnx {
+
+// Parse a non-negative integer. Return -1 on error.
+static int32_t ParseCpuId(const std::string &s) {
+  if (s.empty() || s.size() > 6 ||
+      !std::all_of(s.begin(), s.end(),
+                   [](char c) { return c >= '0' && c <= '9'; })) {
+    return -1;
+  }
+
+  return std::stoi(s);
+}
+
+std::vector<int32_t> ParseCpuList(const std::string &s) {
+  std::vector<int32_t> ans;
+
+  std::istringstream is(s);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    // Allow spaces and the trailing newline in the files from /sys
+    item.erase(std::remove_if(item.begin(), item.end(),
+                              [](char c) {
+                                return c == ' ' || c == '\n' || c == '\t';
+                              }),
+               item.end());
+    if (item.empty()) {
+      return {};
+    }
+
+    auto pos = item.find('-');
+    int32_t first = ParseCpuId(item.substr(0, pos));
+    int32_t last =
+        pos == std::string::npos ? first : ParseCpuId(item.substr(pos + 1));
+
+    if (first < 0 || last < first) {
+      return {};
+    }
+
+    for (int32_t i = first; i <= last; ++i) {
+      ans.push_back(i);
+    }
+  }
+
+  std::sort(ans.begin(), ans.end());
+  ans.erase(std::unique(ans.begin(), ans.end()), ans.end());
+
+  return ans;
+}
+
+int32_t GetNumNumaNodes() {
+#if defined(__linux__)
+  int32_t n = 0;
+  while (!GetNumaNodeCpus(n).empty()) {
+    ++n;
+  }
+  return n;
+#else
+  return 0;
+#endif
+}
+
+std::vector<int32_t> GetNumaNodeCpus(int32_t node) {
+#if defined(__linux__)
+  std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) +
+                   "/cpulist");
+  std::string s;
+  if (!std::getline(is, s)) {
+    return {};
+  }
+
+  return ParseCpuList(s);
+#else
+  return {};
+#endif
+}
+
+bool SetThreadAffinity(const std::vector<int32_t> &cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto i : cpus) {
+    if (i >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(i, &set);
+  }
+
+  // On Linux, pid 0 refers to the calling thread instead of the process
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool GetThreadAffinity(std::vector<int32_t> *cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return false;
+  }
+
+  cpus->clear();
+  for (int32_t i = 0; i != CPU_SETSIZE; ++i) {
+    if (CPU_ISSET(i, &set)) {
+      cpus->push_back(i);
+    }
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+ScopedThreadAffinity::ScopedThreadAffinity(const std::vector<int32_t> &cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+
+  restore_ = GetThreadAffinity(&saved_) && SetThreadAffinity(cpus);
+}
+
+ScopedThreadAffinity::~ScopedThreadAffinity() {
+  if (restore_) {
+    SetThreadAffinity(saved_);
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,62 @@
+// sherpa-onnx/csrc/cpu-affinity.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_CPU_AFFINITY_H_
+#define SHERPA_ONNX_CSRC_CPU_AFFINITY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Parse a list of CPUs in the format used by taskset -c and
+ * /sys/devices/system/node/node<N>/cpulist, e.g., "0-3,8,10-11".
+ *
+ * @return Return the sorted CPU IDs without duplicates. Return an empty
+ *         vector if s is malformed.
+ */
+std::vector<int32_t> ParseCpuList(const std::string &s);
+
+// Return the number of NUMA nodes, or 0 if it is unknown on this platform
+int32_t GetNumNumaNodes();
+
+// Return the CPUs of the given NUMA node. Return an empty vector if it is
+// unknown on this platform.
+std::vector<int32_t> GetNumaNodeCpus(int32_t node);
+
+/** Bind the calling thread to the given CPUs. Threads created by the
+ * calling thread afterwards inherit the binding.
+ *
+ * @return Return false if it fails or is not supported on this platform.
+ */
+bool SetThreadAffinity(const std::vector<int32_t> &cpus);
+
+/** Get the CPUs the calling thread is bound to.
+ *
+ * @return Return false if it fails or is not supported on this platform.
+ */
+bool GetThreadAffinity(std::vector<int32_t> *cpus);
+
+/** Bind the calling thread to the given CPUs in the constructor and restore
+ * its previous binding in the destructor. It does nothing if cpus is empty.
+ *
+ * It is used to create thread pools, e.g., the intra-op thread pool of
+ * onnxruntime, whose threads inherit the binding.
+ */
+class ScopedThreadAffinity {
+ public:
+  explicit ScopedThreadAffinity(const std::vector<int32_t> &cpus);
+  ~ScopedThreadAffinity();
+
+  ScopedThreadAffinity(const ScopedThreadAffinity &) = delete;
+  ScopedThreadAffinity &operator=(const ScopedThreadAffinity &) = delete;
+
+ private:
+  std::vector<int32_t> saved_;
+  bool restore_ = false;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_CPU_AFFINITY_H_
@@ -12,6 +12,7 @@
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
 #include "sherpa-onnx/csrc/resample.h"
 
 namespace sherpa_onnx {
@@ -77,6 +78,24 @@ class FeatureExtractor::Impl {
     }
   }
 
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) {
+    // kaldi-native-fbank expects samples in the range [-32768, 32767]
+    // when normalize_samples is false, so the int16 samples need only the
+    // conversion to float and no rescaling
+    float scale = config_.normalize_samples ? 1.0f / 32768 : 1.0f;
+
+    // Convert in chunks on the stack to avoid allocating a float copy of
+    // the whole input
+    constexpr int32_t kChunkSize = 1024;
+    float buf[kChunkSize];
+    for (int32_t i = 0; i < n; i += kChunkSize) {
+      int32_t k = std::min(kChunkSize, n - i);
+      VecInt16ToFloat(waveform + i, k, scale, buf);
+      AcceptWaveformImpl(sampling_rate, buf, k);
+    }
+  }
+
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
                           int32_t n) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -151,7 +170,7 @@ class FeatureExtractor::Impl {
     return fbank_->IsLastFrame(frame);
   }
 
-  std::vector<float> GetFrames(int32_t frame_index, int32_t n) {
+  void GetFrames(int32_t frame_index, int32_t n, float *out) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (frame_index + n > fbank_->NumFramesReady()) {
       SHERPA_ONNX_LOGE("%d + %d > %d\n", frame_index, n,
@@ -168,9 +187,8 @@ class FeatureExtractor::Impl {
     fbank_->Pop(discard_num);
 
     int32_t feature_dim = fbank_->Dim();
-    std::vector<float> features(feature_dim * n);
 
-    float *p = features.data();
+    float *p = out;
 
     for (int32_t i = 0; i != n; ++i) {
       const float *f = fbank_->GetFrame(i + frame_index);
@@ -179,8 +197,6 @@ class FeatureExtractor::Impl {
     }
 
     last_frame_index_ = frame_index;
-
-    return features;
   }
 
   int32_t FeatureDim() const {
@@ -251,6 +267,12 @@ void FeatureExtractor::AcceptWaveform(int32_t sampling_rate,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void FeatureExtractor::AcceptWaveform(int32_t sampling_rate,
+                                      const int16_t *waveform,
+                                      int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
 void FeatureExtractor::InputFinished() const { impl_->InputFinished(); }
 
 int32_t FeatureExtractor::NumFramesReady() const {
@@ -263,7 +285,14 @@ bool FeatureExtractor::IsLastFrame(int32_t frame) const {
 
 std::vector<float> FeatureExtractor::GetFrames(int32_t frame_index,
                                                int32_t n) const {
-  return impl_->GetFrames(frame_index, n);
+  std::vector<float> features(FeatureDim() * n);
+  impl_->GetFrames(frame_index, n, features.data());
+  return features;
+}
+
+void FeatureExtractor::GetFrames(int32_t frame_index, int32_t n,
+                                 float *out) const {
+  impl_->GetFrames(frame_index, n, out);
 }
 
 int32_t FeatureExtractor::FeatureDim() const { return impl_->FeatureDim(); }
@@ -100,6 +100,12 @@ class FeatureExtractor {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  // Same as above except that the input is 16-bit PCM, i.e., samples are
+  // in the range [-32768, 32767]. They are converted to float in chunks
+  // as they are fed to the feature computer.
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /**
    * InputFinished() tells the class you won't be providing any
    * more waveform.  This will help flush out the last frame or two
@@ -124,6 +130,17 @@ class FeatureExtractor {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  /** Same as the above one except that it writes the frames to the given
+   * buffer, which avoids an allocation and a copy in the caller.
+   *
+   * @param frame_index  The starting frame index
+   * @param n  Number of frames to get.
+   * @param out  Pointer to a buffer of size n * FeatureDim(). On return,
+   *             it contains a 2-D tensor of shape (n, feature_dim) in
+   *             row major.
+   */
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const;
+
   /// Return feature dim of this extractor
   int32_t FeatureDim() const;
 
@@ -0,0 +1,55 @@
+// sherpa-onnx/csrc/file-utils-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(MappedFile, SameAsReadFile) {
+  std::string filename = "file-utils-test-mapped-file.bin";
+  std::vector<char> data(100000);
+  for (size_t i = 0; i != data.size(); ++i) {
+    data[i] = static_cast<char>(i * 7);
+  }
+
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os.write(data.data(), data.size());
+  }
+
+  {
+    MappedFile f(filename);
+    EXPECT_EQ(f.size(), data.size());
+    EXPECT_EQ(std::vector<char>(f.begin(), f.end()), ReadFile(filename));
+
+    // Writing to it does not change the file
+    f.data()[0] += 1;
+  }
+  EXPECT_EQ(ReadFile(filename), data);
+
+  std::remove(filename.c_str());
+}
+
+TEST(MappedFile, EmptyOrMissingFile) {
+  std::string filename = "file-utils-test-empty-file.bin";
+  { std::ofstream os(filename, std::ios::binary); }
+
+  MappedFile empty(filename);
+  EXPECT_TRUE(empty.empty());
+  EXPECT_FALSE(empty.IsMapped());
+
+  std::remove(filename.c_str());
+
+  MappedFile missing("file-utils-test-missing-file.bin");
+  EXPECT_TRUE(missing.empty());
+}
+
+}  // namespace sherpa_onnx
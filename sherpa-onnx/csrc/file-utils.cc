@@ -4,6 +4,18 @@
 
 #include "sherpa-onnx/csrc/file-utils.h"
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -30,6 +42,78 @@ std::vector<char> ReadFile(const std::string &filename) {
   return buffer;
 }
 
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string &filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+      if (mapping) {
+        void *p = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        if (p) {
+          data_ = static_cast<char *>(p);
+          size_ = static_cast<std::size_t>(file_size.QuadPart);
+          mapping_ = mapping;
+          mapped_ = true;
+        } else {
+          CloseHandle(mapping);
+        }
+      }
+    }
+    // The mapping keeps a reference to the file
+    CloseHandle(file);
+  }
+
+  if (!mapped_) {
+    buffer_ = ReadFile(filename);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (mapped_) {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd != -1) {
+    struct stat st;
+    // mmap() fails for an empty file
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void *p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        data_ = static_cast<char *>(p);
+        size_ = static_cast<std::size_t>(st.st_size);
+        mapped_ = true;
+      }
+    }
+    // The mapping keeps a reference to the file
+    close(fd);
+  }
+
+  if (!mapped_) {
+    buffer_ = ReadFile(filename);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (mapped_) {
+    munmap(data_, size_);
+  }
+}
+#endif
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename) {
   AAsset *asset = AAssetManager_open(mgr, filename.c_str(), AASSET_MODE_BUFFER);
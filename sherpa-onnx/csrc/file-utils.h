@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_FILE_UTILS_H_
 #define SHERPA_ONNX_CSRC_FILE_UTILS_H_
 
+#include <cstddef>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -35,6 +36,50 @@ void AssertFileExists(const std::string &filename);
 
 std::vector<char> ReadFile(const std::string &filename);
 
+/** The content of a file, memory-mapped if possible.
+ *
+ * Unlike ReadFile(), it does not copy the file into the heap. Pages are
+ * loaded on demand from the page cache, so processes loading the same
+ * model share them. Use it for model files that are passed to
+ * Ort::Session as a buffer.
+ *
+ * The mapping is private (copy-on-write), so writing to data() never
+ * changes the file. If the file cannot be mapped, it falls back to
+ * ReadFile(). For a file that does not exist, size() is 0, the same as
+ * ReadFile().
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  char *data() { return data_; }
+  const char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const char *begin() const { return data_; }
+  const char *end() const { return data_ + size_; }
+
+  // True if the file is memory-mapped; false if it is read into memory
+  bool IsMapped() const { return mapped_; }
+
+ private:
+  char *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+
+#if defined(_WIN32)
+  void *mapping_ = nullptr;  // HANDLE of the file mapping object
+#endif
+
+  // Used only when the file is not memory-mapped
+  std::vector<char> buffer_;
+};
+
 #if __ANDROID_API__ >= 9
 std::vector<char> ReadFile(AAssetManager *mgr, const std::string &filename);
 #endif
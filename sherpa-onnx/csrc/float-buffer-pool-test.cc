@@ -0,0 +1,58 @@
+// sherpa-onnx/csrc/float-buffer-pool-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
+
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(FloatBufferPool, Reuse) {
+  FloatBufferPool pool;
+  EXPECT_EQ(pool.NumIdleBuffers(), 0);
+
+  const float *p = nullptr;
+  {
+    auto buf = pool.Acquire(100);
+    EXPECT_EQ(buf.Size(), 100);
+    p = buf.Data();
+    EXPECT_EQ(pool.NumIdleBuffers(), 0);
+  }
+  EXPECT_EQ(pool.NumIdleBuffers(), 1);
+
+  {
+    // A smaller request reuses the same memory
+    auto buf = pool.Acquire(50);
+    EXPECT_EQ(buf.Size(), 50);
+    EXPECT_EQ(buf.Data(), p);
+    EXPECT_EQ(pool.NumIdleBuffers(), 0);
+  }
+  EXPECT_EQ(pool.NumIdleBuffers(), 1);
+}
+
+TEST(FloatBufferPool, Concurrent) {
+  FloatBufferPool pool;
+  {
+    auto a = pool.Acquire(10);
+    auto b = pool.Acquire(20);
+    EXPECT_NE(a.Data(), b.Data());
+
+    auto c = std::move(a);
+    EXPECT_EQ(c.Size(), 10);
+  }
+  EXPECT_EQ(pool.NumIdleBuffers(), 2);
+}
+
+TEST(FloatBufferPool, MaxBuffers) {
+  FloatBufferPool pool(1);
+  {
+    auto a = pool.Acquire(10);
+    auto b = pool.Acquire(20);
+  }
+  EXPECT_EQ(pool.NumIdleBuffers(), 1);
+}
+
+}  // namespace sherpa_onnx
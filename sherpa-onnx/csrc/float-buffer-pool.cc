@@ -0,0 +1,50 @@
+// sherpa-onnx/csrc/float-buffer-pool.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
+
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+FloatBufferPool::Buffer FloatBufferPool::Acquire(int32_t size) {
+  std::vector<float> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_.empty()) {
+      // Prefer the largest idle buffer so that we don't need to reallocate.
+      // The pool is small, so a linear scan is fine.
+      int32_t best = 0;
+      for (int32_t i = 1; i < static_cast<int32_t>(idle_.size()); ++i) {
+        if (idle_[i].capacity() > idle_[best].capacity()) {
+          best = i;
+        }
+      }
+
+      data = std::move(idle_[best]);
+      idle_[best] = std::move(idle_.back());
+      idle_.pop_back();
+    }
+  }
+
+  // It does not reallocate if the capacity is large enough
+  data.resize(size);
+
+  return Buffer(this, std::move(data));
+}
+
+int32_t FloatBufferPool::NumIdleBuffers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int32_t>(idle_.size());
+}
+
+void FloatBufferPool::Release(std::vector<float> data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<int32_t>(idle_.size()) < max_buffers_) {
+    idle_.push_back(std::move(data));
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,80 @@
+// sherpa-onnx/csrc/float-buffer-pool.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_FLOAT_BUFFER_POOL_H_
+#define SHERPA_ONNX_CSRC_FLOAT_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** A pool of float buffers that are reused across calls.
+ *
+ * It is used, e.g., for the batched feature input of the encoder in
+ * DecodeStreams(). Since DecodeStreams() can be called concurrently from
+ * several threads, each call borrows a buffer from the pool and the buffer
+ * is returned to the pool when it goes out of scope.
+ */
+class FloatBufferPool {
+ public:
+  class Buffer {
+   public:
+    Buffer(FloatBufferPool *pool, std::vector<float> data)
+        : pool_(pool), data_(std::move(data)) {}
+
+    Buffer(const Buffer &) = delete;
+    Buffer &operator=(const Buffer &) = delete;
+
+    Buffer(Buffer &&other) noexcept
+        : pool_(other.pool_), data_(std::move(other.data_)) {
+      other.pool_ = nullptr;
+    }
+
+    Buffer &operator=(Buffer &&) = delete;
+
+    ~Buffer() {
+      if (pool_) {
+        pool_->Release(std::move(data_));
+      }
+    }
+
+    float *Data() { return data_.data(); }
+    int32_t Size() const { return static_cast<int32_t>(data_.size()); }
+
+   private:
+    FloatBufferPool *pool_;  // not owned
+    std::vector<float> data_;
+  };
+
+  /**
+   * @param max_buffers  Max number of idle buffers kept in the pool.
+   *                     Extra buffers are freed when they are returned.
+   */
+  explicit FloatBufferPool(int32_t max_buffers = 8)
+      : max_buffers_(max_buffers) {}
+
+  /** Borrow a buffer containing `size` floats.
+   *
+   * The content of the returned buffer is unspecified. It reallocates
+   * memory only if all idle buffers are smaller than `size`.
+   */
+  Buffer Acquire(int32_t size);
+
+  // Number of idle buffers in the pool. Used only for testing.
+  int32_t NumIdleBuffers() const;
+
+ private:
+  void Release(std::vector<float> data);
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<std::vector<float>> idle_;
+  int32_t max_buffers_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_FLOAT_BUFFER_POOL_H_
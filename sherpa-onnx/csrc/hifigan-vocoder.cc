@@ -31,7 +31,7 @@ class HifiganVocoder::Impl {
       : env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(num_threads, provider)),
         allocator_{} {
-    auto buf = ReadFile(model);
+    MappedFile buf(model);
     Init(buf.data(), buf.size());
   }
 
@@ -64,8 +64,7 @@ class HifiganVocoder::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
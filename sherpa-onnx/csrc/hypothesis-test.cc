@@ -0,0 +1,64 @@
+// sherpa-onnx/csrc/hypothesis-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/hypothesis.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(Hypothesis, Hash) {
+  Hypothesis a({0, 0, 3, 5}, 0);
+  Hypothesis b({0, 0, 3}, 0);
+  EXPECT_NE(a.Hash(), b.Hash());
+
+  b.AppendToken(5);
+  EXPECT_EQ(a.Hash(), b.Hash());
+
+  Hypothesis c = b;
+  c.AppendToken(8);
+  EXPECT_NE(c.Hash(), b.Hash());
+  EXPECT_EQ(c.Hash(), Hypothesis({0, 0, 3, 5, 8}, 0).Hash());
+
+  // ys may be replaced by a sequence of any length
+  c.SetYs({0, 0});
+  EXPECT_EQ(c.Hash(), Hypothesis({0, 0}, 0).Hash());
+
+  c.SetYs({1, 2});
+  EXPECT_EQ(c.Hash(), Hypothesis({1, 2}, 0).Hash());
+
+  c.SetYs({1, 2, 3, 4, 5, 6});
+  EXPECT_EQ(c.Hash(), Hypothesis({1, 2, 3, 4, 5, 6}, 0).Hash());
+  EXPECT_EQ(c.Hash(), Hypothesis::ComputeHash(c.ys));
+}
+
+TEST(Hypothesis, ExtendHash) {
+  Hypothesis a({3, 5}, 0);
+  Hypothesis b({3, 5, 8}, 0);
+  EXPECT_EQ(Hypothesis::ExtendHash(a.Hash(), 8), b.Hash());
+
+  Hypothesis empty;
+  EXPECT_EQ(Hypothesis::ExtendHash(empty.Hash(), 3),
+            Hypothesis({3}, 0).Hash());
+}
+
+TEST(Hypotheses, Add) {
+  Hypotheses hyps;
+  hyps.Add(Hypothesis({0, 0, 3}, -1));
+  hyps.Add(Hypothesis({0, 0, 5}, -2));
+  hyps.Add(Hypothesis({0, 0, 3}, -1));
+  EXPECT_EQ(hyps.Size(), 2);
+
+  auto best = hyps.GetMostProbable(false);
+  EXPECT_EQ(best.ys, (std::vector<int64_t>{0, 0, 3}));
+  EXPECT_NEAR(best.log_prob, LogAdd<double>()(-1, -1), 1e-6);
+
+  Hypotheses hyps2(std::vector<Hypothesis>{Hypothesis({0, 0, 3}, -1),
+                                           Hypothesis({0, 0, 3}, -3)});
+  EXPECT_EQ(hyps2.Size(), 1);
+}
+
+}  // namespace sherpa_onnx
@@ -10,11 +10,30 @@
 
 namespace sherpa_onnx {
 
+uint64_t Hypothesis::ComputeHash(const std::vector<int64_t> &tokens) {
+  uint64_t hash = kHashOffsetBasis;
+  for (auto i : tokens) {
+    hash = ExtendHash(hash, i);
+  }
+  return hash;
+}
+
+Hypotheses::Map::iterator Hypotheses::Find(const Hypothesis &hyp,
+                                           uint64_t hash) {
+  auto range = hyps_dict_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.ys == hyp.ys) {
+      return it;
+    }
+  }
+  return hyps_dict_.end();
+}
+
 void Hypotheses::Add(Hypothesis hyp) {
-  auto key = hyp.Key();
-  auto it = hyps_dict_.find(key);
+  auto hash = hyp.Hash();
+  auto it = Find(hyp, hash);
   if (it == hyps_dict_.end()) {
-    hyps_dict_[key] = std::move(hyp);
+    hyps_dict_.emplace(hash, std::move(hyp));
   } else {
     it->second.log_prob = LogAdd<double>()(it->second.log_prob, hyp.log_prob);
   }
@@ -7,6 +7,9 @@
 #ifndef SHERPA_ONNX_CSRC_HYPOTHESIS_H_
 #define SHERPA_ONNX_CSRC_HYPOTHESIS_H_
 
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -20,10 +23,37 @@
 
 namespace sherpa_onnx {
 
+// Scores and states of an RNN LM after feeding it a token sequence.
+//
+// It is immutable once created and is shared by all hypotheses with
+// the same token sequence, so copying a Hypothesis does not copy LM states.
+// It is freed when no hypothesis refers to it any more, i.e., when the
+// token sequence has fallen out of the beam.
+struct LMState {
+  // The nn lm score for the next token. Used only in shallow fusion.
+  Ort::Value scores{nullptr};
+
+  std::vector<Ort::Value> states;
+
+  // States after feeding one more token, keyed by the token.
+  // It is a cache that lets hypotheses extending the same prefix with
+  // the same token share one run of the LM. Used only in shallow fusion.
+  //
+  // A tree of LMState is reachable only from the hypotheses of one stream,
+  // so it is never accessed by two threads at the same time.
+  mutable std::unordered_map<int64_t, std::weak_ptr<const LMState>> children;
+};
+
 struct Hypothesis {
   // The predicted tokens so far. Newly predicated tokens are appended.
+  //
+  // Caution: Use AppendToken() or SetYs() to change it so that ys_hash
+  // is kept in sync.
   std::vector<int64_t> ys;
 
+  // Hash of ys. See Hash()
+  uint64_t ys_hash = kHashOffsetBasis;
+
   // timestamps[i] contains the frame number after subsampling
   // on which ys[i] is decoded.
   std::vector<int32_t> timestamps;
@@ -51,15 +81,20 @@ struct Hypothesis {
   // LM log prob if any.
   double lm_log_prob = 0;
 
-  // the nn lm score for next token given the current ys,
-  // when using shallow fusion
-  CopyableOrtValue nn_lm_scores;
+  // Used only in CTC prefix beam search. They are the log probs of all
+  // alignments of ys that end with a blank and with a non-blank,
+  // respectively. log_prob is their log-sum-exp.
+  double log_prob_blank = 0;
+  double log_prob_non_blank = -std::numeric_limits<double>::infinity();
 
-  // cur scored tokens by RNN LM, when rescoring
+  // cur scored tokens by RNN LM, when rescoring.
+  // For shallow fusion, it is the number of tokens (excluding the leading
+  // blanks) that have been fed into the RNN LM.
   int32_t cur_scored_pos = 0;
 
-  // the nn lm states
-  std::vector<CopyableOrtValue> nn_lm_states;
+  // the nn lm scores and states after the first `cur_scored_pos` tokens.
+  // It is shared with other hyps and must not be modified.
+  std::shared_ptr<const LMState> nn_lm_state;
 
   const ContextState *context_state;
 
@@ -72,14 +107,29 @@ struct Hypothesis {
   Hypothesis() = default;
   Hypothesis(const std::vector<int64_t> &ys, double log_prob,
              const ContextState *context_state = nullptr)
-      : ys(ys), log_prob(log_prob), context_state(context_state) {}
+      : ys(ys),
+        ys_hash(ComputeHash(ys)),
+        log_prob(log_prob),
+        context_state(context_state) {}
+
+  // Append a token to ys and update ys_hash in O(1)
+  void AppendToken(int64_t token) {
+    ys.push_back(token);
+    ys_hash = ExtendHash(ys_hash, token);
+  }
+
+  // Replace ys with the given tokens
+  void SetYs(std::vector<int64_t> tokens) {
+    ys = std::move(tokens);
+    ys_hash = ComputeHash(ys);
+  }
 
   double TotalLogProb() const { return log_prob + lm_log_prob; }
 
   // If two Hypotheses have the same `Key`, then they contain
-  // the same token sequence.
+  // the same token sequence. Used only for debugging. Please use
+  // Hash() for lookups.
   std::string Key() const {
-    // TODO(fangjun): Use a hash function?
     std::ostringstream os;
     std::string sep;
     for (auto i : ys) {
@@ -95,20 +145,48 @@ struct Hypothesis {
     os << "(" << Key() << ", " << log_prob << ")";
     return os.str();
   }
+
+  // A hash of ys. If two Hypotheses contain the same token sequence,
+  // then they have the same hash. It is updated incrementally as tokens
+  // are appended, so it costs O(1) regardless of the length of ys.
+  uint64_t Hash() const { return ys_hash; }
+
+  // 64-bit FNV-1a over the tokens
+  static constexpr uint64_t kHashOffsetBasis = 0xcbf29ce484222325ULL;
+  static constexpr uint64_t kHashPrime = 0x100000001b3ULL;
+
+  // Return the hash of ys with `token` appended, given `hash` of ys.
+  // It lets callers look up an extension of a hypothesis without
+  // copying it.
+  static uint64_t ExtendHash(uint64_t hash, int64_t token) {
+    return (hash ^ static_cast<uint64_t>(token)) * kHashPrime;
+  }
+
+  // Return the hash of the given tokens from scratch
+  static uint64_t ComputeHash(const std::vector<int64_t> &tokens);
 };
 
 class Hypotheses {
  public:
+  // Hypotheses are keyed by Hypothesis::Hash(). Different token sequences
+  // may have the same hash, so we use a multimap and compare ys on lookup.
+  using Map = std::unordered_multimap<uint64_t, Hypothesis>;
+
   Hypotheses() = default;
 
   explicit Hypotheses(std::vector<Hypothesis> hyps) {
     for (auto &h : hyps) {
-      hyps_dict_[h.Key()] = std::move(h);
+      auto hash = h.Hash();
+      auto it = Find(h, hash);
+      if (it == hyps_dict_.end()) {
+        hyps_dict_.emplace(hash, std::move(h));
+      } else {
+        it->second = std::move(h);
+      }
     }
   }
 
-  explicit Hypotheses(std::unordered_map<std::string, Hypothesis> hyps_dict)
-      : hyps_dict_(std::move(hyps_dict)) {}
+  explicit Hypotheses(Map hyps_dict) : hyps_dict_(std::move(hyps_dict)) {}
 
   // Add hyp to this object. If it already exists, its log_prob
   // is updated with the given hyp using log-sum-exp.
@@ -153,7 +231,11 @@ class Hypotheses {
   }
 
  private:
-  using Map = std ::unordered_map<std::string, Hypothesis>;
+  // Return the hyp containing the same token sequence as the given one,
+  // whose Hash() is `hash`. Return end() if there is no such hyp.
+  Map::iterator Find(const Hypothesis &hyp, uint64_t hash);
+
+ private:
   Map hyps_dict_;
 };
 
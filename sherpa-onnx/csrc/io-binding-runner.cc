@@ -0,0 +1,144 @@
+// sherpa-onnx/csrc/io-binding-runner.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/io-binding-runner.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
+
+namespace sherpa_onnx {
+
+struct IoBindingRunner::PerThread {
+  explicit PerThread(Ort::Session &sess) : binding(sess) {}  // NOLINT
+
+  Ort::IoBinding binding;
+
+  // If true, outputs are allocated by onnxruntime, e.g., because an output
+  // is not batched along its first dimension.
+  bool disabled = false;
+
+  // Shapes, types and buffers of the outputs. shapes[k][0] is the capacity
+  // in rows of buffers[k].
+  std::vector<std::vector<int64_t>> shapes;
+  std::vector<ONNXTensorElementDataType> types;
+  std::vector<int64_t> row_bytes;
+  std::vector<Ort::Value> buffers;
+  int64_t capacity = 0;
+};
+
+IoBindingRunner::IoBindingRunner(Ort::Session *sess,
+                                 const std::vector<const char *> &input_names,
+                                 const std::vector<const char *> &output_names)
+    : sess_(sess),
+      input_names_(input_names),
+      output_names_(output_names),
+      memory_info_(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator,
+                                              OrtMemTypeDefault)) {}
+
+IoBindingRunner::~IoBindingRunner() = default;
+
+IoBindingRunner::PerThread *IoBindingRunner::GetPerThread() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &p = per_thread_[std::this_thread::get_id()];
+  if (!p) {
+    p = std::make_unique<PerThread>(*sess_);
+  }
+  return p.get();
+}
+
+void IoBindingRunner::Grow(PerThread *t, int64_t batch_size) {
+  t->buffers.clear();
+  for (int32_t k = 0; k != static_cast<int32_t>(t->shapes.size()); ++k) {
+    t->shapes[k][0] = batch_size;
+    t->buffers.push_back(Ort::Value::CreateTensor(
+        allocator_, t->shapes[k].data(), t->shapes[k].size(), t->types[k]));
+  }
+  t->capacity = batch_size;
+}
+
+std::vector<Ort::Value> IoBindingRunner::Run(const Ort::Value *inputs,
+                                             int32_t num_inputs) {
+  PerThread *t = GetPerThread();
+
+  t->binding.ClearBoundInputs();
+  t->binding.ClearBoundOutputs();
+
+  for (int32_t i = 0; i != num_inputs; ++i) {
+    t->binding.BindInput(input_names_[i], inputs[i]);
+  }
+
+  int64_t batch_size = inputs[0].GetTensorTypeAndShapeInfo().GetShape()[0];
+
+  if (t->disabled || t->shapes.empty()) {
+    // Let onnxruntime allocate the outputs. For the first call in this
+    // thread, we also use them to find the output shapes.
+    for (const auto &name : output_names_) {
+      t->binding.BindOutput(name, memory_info_);
+    }
+
+    sess_->Run(Ort::RunOptions{nullptr}, t->binding);
+
+    std::vector<Ort::Value> ans = t->binding.GetOutputValues();
+    if (t->disabled) {
+      return ans;
+    }
+
+    for (const auto &v : ans) {
+      auto info = v.GetTensorTypeAndShapeInfo();
+      std::vector<int64_t> shape = info.GetShape();
+      auto type = info.GetElementType();
+
+      if (shape.empty() || shape[0] != batch_size || batch_size <= 0 ||
+          GetElementSize(type) == 0) {
+        SHERPA_ONNX_LOGE(
+            "Output is not batched along the first dimension or has an "
+            "unsupported type. Disable pre-allocated outputs for it.");
+        t->disabled = true;
+        t->shapes.clear();
+        t->types.clear();
+        t->row_bytes.clear();
+        return ans;
+      }
+
+      int64_t row_elements = info.GetElementCount() / batch_size;
+
+      t->shapes.push_back(std::move(shape));
+      t->types.push_back(type);
+      t->row_bytes.push_back(row_elements * GetElementSize(type));
+    }
+
+    Grow(t, batch_size);
+
+    return ans;
+  }
+
+  if (batch_size > t->capacity) {
+    Grow(t, batch_size);
+  }
+
+  std::vector<Ort::Value> ans;
+  ans.reserve(t->buffers.size());
+
+  for (int32_t k = 0; k != static_cast<int32_t>(t->buffers.size()); ++k) {
+    std::vector<int64_t> shape = t->shapes[k];
+    shape[0] = batch_size;
+
+    ans.push_back(Ort::Value::CreateTensor(
+        memory_info_, t->buffers[k].GetTensorMutableRawData(),
+        batch_size * t->row_bytes[k], shape.data(), shape.size(),
+        t->types[k]));
+
+    t->binding.BindOutput(output_names_[k], ans.back());
+  }
+
+  sess_->Run(Ort::RunOptions{nullptr}, t->binding);
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,76 @@
+// sherpa-onnx/csrc/io-binding-runner.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
+#define SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
+
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+/** Run a session through Ort::IoBinding so that outputs are written into
+ * pre-allocated buffers instead of being allocated by onnxruntime on every
+ * call.
+ *
+ * It requires that every output has the batch size as its first dimension
+ * and that all other dimensions do not change across calls, which holds for
+ * the decoder and the joiner of transducer models. The batch size is taken
+ * from the first dimension of the first input. Output buffers are sized for
+ * the largest batch seen so far.
+ *
+ * Each thread gets its own binding and output buffers, so Run() can be
+ * called concurrently.
+ *
+ * Caution: The returned values do not own their memory. They are valid
+ * until the next call to Run() of this object from the same thread.
+ */
+class IoBindingRunner {
+ public:
+  /**
+   * @param sess  Not owned.
+   * @param input_names  Input names of the session. Not copied; it must
+   *                     outlive this object.
+   * @param output_names  Output names of the session. Not copied; it must
+   *                      outlive this object.
+   */
+  IoBindingRunner(Ort::Session *sess,
+                  const std::vector<const char *> &input_names,
+                  const std::vector<const char *> &output_names);
+
+  ~IoBindingRunner();
+
+  std::vector<Ort::Value> Run(const Ort::Value *inputs, int32_t num_inputs);
+
+ private:
+  struct PerThread;
+
+  PerThread *GetPerThread();
+
+  // Allocate output buffers for up to batch_size rows
+  void Grow(PerThread *t, int64_t batch_size);
+
+ private:
+  Ort::Session *sess_;  // not owned
+  const std::vector<const char *> &input_names_;
+  const std::vector<const char *> &output_names_;
+
+  Ort::MemoryInfo memory_info_;
+  Ort::AllocatorWithDefaultOptions allocator_;
+
+  // It protects per_thread_
+  std::mutex mutex_;
+
+  // Entries are never removed. The number of threads that run a model
+  // is usually small and fixed, e.g., the worker threads of a server.
+  std::unordered_map<std::thread::id, std::unique_ptr<PerThread>> per_thread_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_IO_BINDING_RUNNER_H_
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
 #include "sherpa-onnx/csrc/keyword-spotter-impl.h"
 #include "sherpa-onnx/csrc/keyword-spotter.h"
 #include "sherpa-onnx/csrc/macros.h"
@@ -216,7 +217,9 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
     int32_t feature_dim = ss[0]->FeatureDim();
 
     std::vector<TransducerKeywordResult> results(n);
-    std::vector<float> features_vec(n * chunk_size * feature_dim);
+    // Frames of all streams are written directly into this buffer, which
+    // is reused across calls
+    auto features_buf = features_pool_.Acquire(n * chunk_size * feature_dim);
     std::vector<std::vector<Ort::Value>> states_vec(n);
     std::vector<int64_t> all_processed_frames(n);
 
@@ -224,15 +227,12 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
       SHERPA_ONNX_CHECK(ss[i]->GetContextGraph() != nullptr);
 
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
+      ss[i]->GetFrames(num_processed_frames, chunk_size,
+                       features_buf.Data() + i * chunk_size * feature_dim);
 
       // Question: should num_processed_frames include chunk_shift?
       ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
-
       results[i] = std::move(ss[i]->GetKeywordResult());
       states_vec[i] = std::move(ss[i]->GetStates());
       all_processed_frames[i] = num_processed_frames;
@@ -243,8 +243,8 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
 
     std::array<int64_t, 3> x_shape{n, chunk_size, feature_dim};
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                            features_vec.size(), x_shape.data(),
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_buf.Data(),
+                                            features_buf.Size(), x_shape.data(),
                                             x_shape.size());
 
     std::array<int64_t, 1> processed_frames_shape{
@@ -365,6 +365,9 @@ class KeywordSpotterTransducerImpl : public KeywordSpotterImpl {
   std::unique_ptr<TransducerKeywordDecoder> decoder_;
   SymbolTable sym_;
   int32_t unk_id_ = -1;
+
+  // For the batched features input of the encoder
+  mutable FloatBufferPool features_pool_;
 };
 
 }  // namespace sherpa_onnx
@@ -0,0 +1,39 @@
+// sherpa-onnx/csrc/length-buckets-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/length-buckets.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(SplitIntoLengthBuckets, Ratio) {
+  std::vector<int32_t> lengths = {100, 300, 104, 50, 102, 310};
+
+  auto buckets = SplitIntoLengthBuckets(lengths, 1.05, 8);
+  ASSERT_EQ(buckets.size(), 3);
+
+  EXPECT_EQ(buckets[0], (std::vector<int32_t>{3}));
+  EXPECT_EQ(buckets[1], (std::vector<int32_t>{0, 4, 2}));
+  EXPECT_EQ(buckets[2], (std::vector<int32_t>{1, 5}));
+}
+
+TEST(SplitIntoLengthBuckets, MaxBatchSize) {
+  std::vector<int32_t> lengths(5, 10);
+
+  auto buckets = SplitIntoLengthBuckets(lengths, 1, 2);
+  ASSERT_EQ(buckets.size(), 3);
+
+  EXPECT_EQ(buckets[0], (std::vector<int32_t>{0, 1}));
+  EXPECT_EQ(buckets[1], (std::vector<int32_t>{2, 3}));
+  EXPECT_EQ(buckets[2], (std::vector<int32_t>{4}));
+}
+
+TEST(SplitIntoLengthBuckets, Empty) {
+  EXPECT_TRUE(SplitIntoLengthBuckets({}, 1.1, 4).empty());
+}
+
+}  // namespace sherpa_onnx
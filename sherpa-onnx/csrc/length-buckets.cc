@@ -0,0 +1,42 @@
+// sherpa-onnx/csrc/length-buckets.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/length-buckets.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace sherpa_onnx {
+
+std::vector<std::vector<int32_t>> SplitIntoLengthBuckets(
+    const std::vector<int32_t> &lengths, float max_ratio,
+    int32_t max_batch_size) {
+  std::vector<int32_t> order(lengths.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&lengths](int32_t a, int32_t b) {
+                     return lengths[a] < lengths[b];
+                   });
+
+  std::vector<std::vector<int32_t>> ans;
+  for (auto i : order) {
+    if (!ans.empty()) {
+      auto &last = ans.back();
+      int32_t shortest = lengths[last.front()];
+
+      if (static_cast<int32_t>(last.size()) < max_batch_size &&
+          lengths[i] <= shortest * max_ratio) {
+        last.push_back(i);
+        continue;
+      }
+    }
+
+    ans.push_back({i});
+  }
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
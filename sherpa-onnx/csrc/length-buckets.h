@@ -0,0 +1,36 @@
+// sherpa-onnx/csrc/length-buckets.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_LENGTH_BUCKETS_H_
+#define SHERPA_ONNX_CSRC_LENGTH_BUCKETS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Group items of similar lengths so that they can be padded to a common
+ * length and run through a model as a batch.
+ *
+ * It is meant for models without a padding mask, whose output for an item
+ * changes with the amount of padding. Items are sorted by length and
+ * consecutive items are put into the same bucket as long as the longest
+ * one is at most max_ratio times the shortest one. Items that have no
+ * partner within this ratio end up in a bucket of their own.
+ *
+ * @param lengths lengths[i] is the length of the i-th item.
+ * @param max_ratio Maximum ratio between the longest and the shortest
+ *                  item of a bucket. Use 1 to batch only items of equal
+ *                  length.
+ * @param max_batch_size Maximum number of items in a bucket.
+ *
+ * @return Return the buckets. Each bucket contains indexes into lengths,
+ *         sorted by length. Every index appears in exactly one bucket.
+ */
+std::vector<std::vector<int32_t>> SplitIntoLengthBuckets(
+    const std::vector<int32_t> &lengths, float max_ratio,
+    int32_t max_batch_size);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_LENGTH_BUCKETS_H_
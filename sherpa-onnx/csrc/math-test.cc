@@ -0,0 +1,173 @@
+// sherpa-onnx/csrc/math-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/math.h"
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/macros.h"
+
+namespace sherpa_onnx {
+
+// The implementation before vectorization, used as a reference
+static void ReferenceLogSoftmax(float *input, int32_t input_len) {
+  double m = *std::max_element(input, input + input_len);
+  double sum = 0;
+  for (int32_t i = 0; i < input_len; i++) {
+    sum += std::exp(input[i] - m);
+  }
+
+  double offset = m + std::log(sum);
+  for (int32_t i = 0; i < input_len; i++) {
+    input[i] -= offset;
+  }
+}
+
+static std::vector<int32_t> ReferenceTopkIndex(const float *vec, int32_t size,
+                                               int32_t topk) {
+  std::vector<int32_t> vec_index(size);
+  std::iota(vec_index.begin(), vec_index.end(), 0);
+
+  int32_t k_num = std::min<int32_t>(size, topk);
+  std::partial_sort(vec_index.begin(), vec_index.begin() + k_num,
+                    vec_index.end(), [vec](int32_t index_1, int32_t index_2) {
+                      return vec[index_1] > vec[index_2];
+                    });
+
+  return {vec_index.begin(), vec_index.begin() + k_num};
+}
+
+static std::vector<float> RandomVector(int32_t n, std::mt19937 *mt) {
+  std::normal_distribution<float> dist(0, 5);
+  std::vector<float> ans(n);
+  for (auto &f : ans) {
+    f = dist(*mt);
+  }
+  return ans;
+}
+
+TEST(LogSoftmax, Float) {
+  std::mt19937 mt(0);
+  for (int32_t n : {1, 3, 7, 8, 15, 16, 17, 100, 500, 5003}) {
+    std::vector<float> x = RandomVector(n, &mt);
+    std::vector<float> expected = x;
+
+    LogSoftmax(x.data(), n);
+    ReferenceLogSoftmax(expected.data(), n);
+
+    for (int32_t i = 0; i != n; ++i) {
+      EXPECT_NEAR(x[i], expected[i], 1e-4) << n << " " << i;
+    }
+  }
+}
+
+TEST(VecMax, Float) {
+  std::mt19937 mt(0);
+  for (int32_t n : {1, 2, 5, 8, 9, 33, 500}) {
+    std::vector<float> x = RandomVector(n, &mt);
+    EXPECT_EQ(VecMax(x.data(), n), *std::max_element(x.begin(), x.end()));
+  }
+}
+
+TEST(VecInt16ToFloat, Int16) {
+  std::mt19937 mt(0);
+  std::uniform_int_distribution<int32_t> dist(-32768, 32767);
+  for (int32_t n : {1, 3, 4, 8, 15, 16, 17, 33, 500}) {
+    std::vector<int16_t> x(n);
+    for (auto &i : x) {
+      i = dist(mt);
+    }
+    x[0] = -32768;
+    x[n - 1] = 32767;
+
+    for (float scale : {1.0f, 1.0f / 32768}) {
+      std::vector<float> y(n);
+      VecInt16ToFloat(x.data(), n, scale, y.data());
+      for (int32_t i = 0; i != n; ++i) {
+        EXPECT_EQ(y[i], x[i] * scale) << n << " " << i;
+      }
+    }
+  }
+}
+
+TEST(TopkIndex, Float) {
+  std::mt19937 mt(0);
+  for (int32_t n : {1, 5, 100, 2000}) {
+    std::vector<float> x = RandomVector(n, &mt);
+    for (int32_t k : {1, 4, 10, 32, 3000}) {
+      EXPECT_EQ(TopkIndex(x.data(), n, k), ReferenceTopkIndex(x.data(), n, k));
+    }
+  }
+
+  // Ties are broken by the index
+  std::vector<float> x = {1, 3, 2, 3, 3};
+  EXPECT_EQ(TopkIndex(x.data(), x.size(), 2), (std::vector<int32_t>{1, 3}));
+  EXPECT_TRUE(TopkIndex(x.data(), x.size(), 0).empty());
+}
+
+// LogSoftmax() and TopkIndex() on num_hyps * vocab_size floats, as in
+// modified beam search with max_active_paths == num_hyps == k.
+// It is disabled by default. Run it with
+//   ./bin/math-test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(Math, DISABLED_Benchmark) {
+  std::mt19937 mt(0);
+  int32_t num_iters = 200;
+
+  for (int32_t vocab_size : {500, 1000, 2000, 5000}) {
+    for (int32_t k : {4, 8, 16, 32}) {
+      int32_t n = vocab_size * k;
+      std::vector<float> x = RandomVector(n, &mt);
+      std::vector<float> y = x;
+
+      auto start = std::chrono::steady_clock::now();
+      for (int32_t i = 0; i != num_iters; ++i) {
+        y = x;
+        for (int32_t h = 0; h != k; ++h) {
+          ReferenceLogSoftmax(y.data() + h * vocab_size, vocab_size);
+        }
+      }
+      auto stop = std::chrono::steady_clock::now();
+      double ref_softmax_us =
+          std::chrono::duration<double, std::micro>(stop - start).count();
+
+      start = std::chrono::steady_clock::now();
+      for (int32_t i = 0; i != num_iters; ++i) {
+        y = x;
+        LogSoftmax(y.data(), vocab_size, k);
+      }
+      stop = std::chrono::steady_clock::now();
+      double softmax_us =
+          std::chrono::duration<double, std::micro>(stop - start).count();
+
+      start = std::chrono::steady_clock::now();
+      for (int32_t i = 0; i != num_iters; ++i) {
+        auto topk = ReferenceTopkIndex(y.data(), n, k);
+      }
+      stop = std::chrono::steady_clock::now();
+      double ref_topk_us =
+          std::chrono::duration<double, std::micro>(stop - start).count();
+
+      start = std::chrono::steady_clock::now();
+      for (int32_t i = 0; i != num_iters; ++i) {
+        auto topk = TopkIndex(y.data(), n, k);
+      }
+      stop = std::chrono::steady_clock::now();
+      double topk_us =
+          std::chrono::duration<double, std::micro>(stop - start).count();
+
+      SHERPA_ONNX_LOGE(
+          "vocab %d, k %d: LogSoftmax %.2f us (scalar %.2f us), "
+          "TopkIndex %.2f us (partial_sort %.2f us)",
+          vocab_size, k, softmax_us / num_iters, ref_softmax_us / num_iters,
+          topk_us / num_iters, ref_topk_us / num_iters);
+    }
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,535 @@
+// sherpa-onnx/csrc/math.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/math.h"
+
+#include <algorithm>
+#include <cmath>
+
+// With GCC and Clang on x86, the AVX-512 and AVX2 kernels are always
+// compiled, using target attributes instead of -mavx512f/-mavx2, and
+// selected at runtime according to the CPU. Other compilers use only the
+// instruction set enabled at compile time.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define SHERPA_ONNX_X86_DISPATCH 1
+#define SHERPA_ONNX_TARGET_AVX512 __attribute__((target("avx512f")))
+#define SHERPA_ONNX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define SHERPA_ONNX_TARGET_AVX512
+#define SHERPA_ONNX_TARGET_AVX2
+#endif
+
+#if defined(SHERPA_ONNX_X86_DISPATCH) || defined(__AVX512F__)
+#define SHERPA_ONNX_HAS_AVX512 1
+#endif
+
+#if defined(SHERPA_ONNX_X86_DISPATCH) || \
+    (defined(__AVX2__) && defined(__FMA__))
+#define SHERPA_ONNX_HAS_AVX2 1
+#endif
+
+#if defined(SHERPA_ONNX_HAS_AVX512) || defined(SHERPA_ONNX_HAS_AVX2) || \
+    defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The vectorized exp() below follows the one from the Cephes math library,
+// which is also used by many other projects, e.g., sse_mathfun.h.
+// Its relative error is about 1e-7 for inputs in [-87, 88].
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr float kExpHi = 88.3762626647949f;
+constexpr float kExpLo = -88.3762626647949f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kExpC1 = 0.693359375f;
+constexpr float kExpC2 = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500E-4f;
+constexpr float kExpP1 = 1.3981999507E-3f;
+constexpr float kExpP2 = 8.3334519073E-3f;
+constexpr float kExpP3 = 4.1665795894E-2f;
+constexpr float kExpP4 = 1.6666665459E-1f;
+constexpr float kExpP5 = 5.0000001201E-1f;
+
+#if defined(SHERPA_ONNX_HAS_AVX512)
+
+// The AVX-512 intrinsics of GCC 12 use _mm512_undefined_ps() and friends,
+// which trigger false -Wmaybe-uninitialized warnings once inlined. See
+// https://gcc.gnu.org/bugzilla/show_bug.cgi?id=105593
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace avx512 {
+
+constexpr int32_t kWidth = 16;
+
+SHERPA_ONNX_TARGET_AVX512
+inline __m512 Exp(__m512 x) {
+  x = _mm512_min_ps(x, _mm512_set1_ps(kExpHi));
+  x = _mm512_max_ps(x, _mm512_set1_ps(kExpLo));
+
+  __m512 fx = _mm512_fmadd_ps(x, _mm512_set1_ps(kLog2e), _mm512_set1_ps(0.5f));
+  fx = _mm512_roundscale_ps(fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC1), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC2), x);
+
+  __m512 z = _mm512_mul_ps(x, x);
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, z, x);
+  y = _mm512_add_ps(y, _mm512_set1_ps(1.0f));
+
+  __m512i n = _mm512_cvttps_epi32(fx);
+  n = _mm512_add_epi32(n, _mm512_set1_epi32(127));
+  n = _mm512_slli_epi32(n, 23);
+
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(n));
+}
+
+SHERPA_ONNX_TARGET_AVX512
+float MaxImpl(const float *x, int32_t n, int32_t *i) {
+  __m512 m = _mm512_loadu_ps(x);
+  for (*i = kWidth; *i + kWidth <= n; *i += kWidth) {
+    m = _mm512_max_ps(m, _mm512_loadu_ps(x + *i));
+  }
+  return _mm512_reduce_max_ps(m);
+}
+
+SHERPA_ONNX_TARGET_AVX512
+float SumExpImpl(const float *x, int32_t n, float shift, int32_t *i) {
+  __m512 s = _mm512_setzero_ps();
+  __m512 b = _mm512_set1_ps(shift);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    s = _mm512_add_ps(s, Exp(_mm512_sub_ps(_mm512_loadu_ps(x + *i), b)));
+  }
+  return _mm512_reduce_add_ps(s);
+}
+
+SHERPA_ONNX_TARGET_AVX512
+void AddScalarImpl(float *x, int32_t n, float c, int32_t *i) {
+  __m512 b = _mm512_set1_ps(c);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    _mm512_storeu_ps(x + *i, _mm512_add_ps(_mm512_loadu_ps(x + *i), b));
+  }
+}
+
+SHERPA_ONNX_TARGET_AVX512
+void Int16ToFloatImpl(const int16_t *x, int32_t n, float scale, float *y,
+                      int32_t *i) {
+  __m512 b = _mm512_set1_ps(scale);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + *i));
+    __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(v));
+    _mm512_storeu_ps(y + *i, _mm512_mul_ps(f, b));
+  }
+}
+
+}  // namespace avx512
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+#if defined(SHERPA_ONNX_HAS_AVX2)
+
+namespace avx2 {
+
+constexpr int32_t kWidth = 8;
+
+SHERPA_ONNX_TARGET_AVX2
+inline float HorizontalMax(__m256 v) {
+  __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+
+SHERPA_ONNX_TARGET_AVX2
+inline float HorizontalSum(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+SHERPA_ONNX_TARGET_AVX2
+inline __m256 Exp(__m256 x) {
+  x = _mm256_min_ps(x, _mm256_set1_ps(kExpHi));
+  x = _mm256_max_ps(x, _mm256_set1_ps(kExpLo));
+
+  __m256 fx = _mm256_fmadd_ps(x, _mm256_set1_ps(kLog2e), _mm256_set1_ps(0.5f));
+  fx = _mm256_floor_ps(fx);
+
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC1), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC2), x);
+
+  __m256 z = _mm256_mul_ps(x, x);
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+  y = _mm256_fmadd_ps(y, z, x);
+  y = _mm256_add_ps(y, _mm256_set1_ps(1.0f));
+
+  __m256i n = _mm256_cvttps_epi32(fx);
+  n = _mm256_add_epi32(n, _mm256_set1_epi32(127));
+  n = _mm256_slli_epi32(n, 23);
+
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(n));
+}
+
+SHERPA_ONNX_TARGET_AVX2
+float MaxImpl(const float *x, int32_t n, int32_t *i) {
+  __m256 m = _mm256_loadu_ps(x);
+  for (*i = kWidth; *i + kWidth <= n; *i += kWidth) {
+    m = _mm256_max_ps(m, _mm256_loadu_ps(x + *i));
+  }
+  return HorizontalMax(m);
+}
+
+SHERPA_ONNX_TARGET_AVX2
+float SumExpImpl(const float *x, int32_t n, float shift, int32_t *i) {
+  __m256 s = _mm256_setzero_ps();
+  __m256 b = _mm256_set1_ps(shift);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    s = _mm256_add_ps(s, Exp(_mm256_sub_ps(_mm256_loadu_ps(x + *i), b)));
+  }
+  return HorizontalSum(s);
+}
+
+SHERPA_ONNX_TARGET_AVX2
+void AddScalarImpl(float *x, int32_t n, float c, int32_t *i) {
+  __m256 b = _mm256_set1_ps(c);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    _mm256_storeu_ps(x + *i, _mm256_add_ps(_mm256_loadu_ps(x + *i), b));
+  }
+}
+
+SHERPA_ONNX_TARGET_AVX2
+void Int16ToFloatImpl(const int16_t *x, int32_t n, float scale, float *y,
+                      int32_t *i) {
+  __m256 b = _mm256_set1_ps(scale);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + *i));
+    __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+    _mm256_storeu_ps(y + *i, _mm256_mul_ps(f, b));
+  }
+}
+
+}  // namespace avx2
+
+#endif
+
+#if defined(__SSE2__)
+
+namespace sse2 {
+
+constexpr int32_t kWidth = 4;
+
+inline float HorizontalMax(__m128 m) {
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+
+inline float HorizontalSum(__m128 s) {
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+inline __m128 Exp(__m128 x) {
+  x = _mm_min_ps(x, _mm_set1_ps(kExpHi));
+  x = _mm_max_ps(x, _mm_set1_ps(kExpLo));
+
+  __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(kLog2e)), _mm_set1_ps(0.5f));
+
+  // floor() without SSE4.1
+  __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  __m128 mask = _mm_and_ps(_mm_cmpgt_ps(t, fx), _mm_set1_ps(1.0f));
+  fx = _mm_sub_ps(t, mask);
+
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(kExpC1)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(kExpC2)));
+
+  __m128 z = _mm_mul_ps(x, x);
+  __m128 y = _mm_set1_ps(kExpP0);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP1));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP2));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP3));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP4));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP5));
+  y = _mm_add_ps(_mm_mul_ps(y, z), x);
+  y = _mm_add_ps(y, _mm_set1_ps(1.0f));
+
+  __m128i n = _mm_cvttps_epi32(fx);
+  n = _mm_add_epi32(n, _mm_set1_epi32(127));
+  n = _mm_slli_epi32(n, 23);
+
+  return _mm_mul_ps(y, _mm_castsi128_ps(n));
+}
+
+float MaxImpl(const float *x, int32_t n, int32_t *i) {
+  __m128 m = _mm_loadu_ps(x);
+  for (*i = kWidth; *i + kWidth <= n; *i += kWidth) {
+    m = _mm_max_ps(m, _mm_loadu_ps(x + *i));
+  }
+  return HorizontalMax(m);
+}
+
+float SumExpImpl(const float *x, int32_t n, float shift, int32_t *i) {
+  __m128 s = _mm_setzero_ps();
+  __m128 b = _mm_set1_ps(shift);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    s = _mm_add_ps(s, Exp(_mm_sub_ps(_mm_loadu_ps(x + *i), b)));
+  }
+  return HorizontalSum(s);
+}
+
+void AddScalarImpl(float *x, int32_t n, float c, int32_t *i) {
+  __m128 b = _mm_set1_ps(c);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    _mm_storeu_ps(x + *i, _mm_add_ps(_mm_loadu_ps(x + *i), b));
+  }
+}
+
+void Int16ToFloatImpl(const int16_t *x, int32_t n, float scale, float *y,
+                      int32_t *i) {
+  __m128 b = _mm_set1_ps(scale);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(x + *i));
+
+    // SSE2 has no sign extension from 16 to 32 bits. Put each sample into
+    // the upper half of a 32-bit lane and shift it back arithmetically.
+    v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    _mm_storeu_ps(y + *i, _mm_mul_ps(_mm_cvtepi32_ps(v), b));
+  }
+}
+
+}  // namespace sse2
+
+namespace base = sse2;
+
+#elif defined(__ARM_NEON)
+
+namespace neon {
+
+constexpr int32_t kWidth = 4;
+
+inline float HorizontalMax(float32x4_t m) {
+  float32x2_t r = vpmax_f32(vget_low_f32(m), vget_high_f32(m));
+  r = vpmax_f32(r, r);
+  return vget_lane_f32(r, 0);
+}
+
+inline float HorizontalSum(float32x4_t s) {
+  float32x2_t r = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+  r = vpadd_f32(r, r);
+  return vget_lane_f32(r, 0);
+}
+
+inline float32x4_t Exp(float32x4_t x) {
+  x = vminq_f32(x, vdupq_n_f32(kExpHi));
+  x = vmaxq_f32(x, vdupq_n_f32(kExpLo));
+
+  float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(kLog2e));
+
+  // floor()
+  float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+  uint32x4_t mask = vcgtq_f32(t, fx);
+  mask = vandq_u32(mask, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)));
+  fx = vsubq_f32(t, vreinterpretq_f32_u32(mask));
+
+  x = vmlsq_f32(x, fx, vdupq_n_f32(kExpC1));
+  x = vmlsq_f32(x, fx, vdupq_n_f32(kExpC2));
+
+  float32x4_t z = vmulq_f32(x, x);
+  float32x4_t y = vdupq_n_f32(kExpP0);
+  y = vmlaq_f32(vdupq_n_f32(kExpP1), y, x);
+  y = vmlaq_f32(vdupq_n_f32(kExpP2), y, x);
+  y = vmlaq_f32(vdupq_n_f32(kExpP3), y, x);
+  y = vmlaq_f32(vdupq_n_f32(kExpP4), y, x);
+  y = vmlaq_f32(vdupq_n_f32(kExpP5), y, x);
+  y = vmlaq_f32(x, y, z);
+  y = vaddq_f32(y, vdupq_n_f32(1.0f));
+
+  int32x4_t n = vcvtq_s32_f32(fx);
+  n = vaddq_s32(n, vdupq_n_s32(127));
+  n = vshlq_n_s32(n, 23);
+
+  return vmulq_f32(y, vreinterpretq_f32_s32(n));
+}
+
+float MaxImpl(const float *x, int32_t n, int32_t *i) {
+  float32x4_t m = vld1q_f32(x);
+  for (*i = kWidth; *i + kWidth <= n; *i += kWidth) {
+    m = vmaxq_f32(m, vld1q_f32(x + *i));
+  }
+  return HorizontalMax(m);
+}
+
+float SumExpImpl(const float *x, int32_t n, float shift, int32_t *i) {
+  float32x4_t s = vdupq_n_f32(0);
+  float32x4_t b = vdupq_n_f32(shift);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    s = vaddq_f32(s, Exp(vsubq_f32(vld1q_f32(x + *i), b)));
+  }
+  return HorizontalSum(s);
+}
+
+void AddScalarImpl(float *x, int32_t n, float c, int32_t *i) {
+  float32x4_t b = vdupq_n_f32(c);
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    vst1q_f32(x + *i, vaddq_f32(vld1q_f32(x + *i), b));
+  }
+}
+
+void Int16ToFloatImpl(const int16_t *x, int32_t n, float scale, float *y,
+                      int32_t *i) {
+  for (*i = 0; *i + kWidth <= n; *i += kWidth) {
+    float32x4_t f = vcvtq_f32_s32(vmovl_s16(vld1_s16(x + *i)));
+    vst1q_f32(y + *i, vmulq_n_f32(f, scale));
+  }
+}
+
+}  // namespace neon
+
+namespace base = neon;
+
+#else
+
+// Scalar fallback. The tails are handled by the callers.
+namespace scalar {
+
+constexpr int32_t kWidth = 1;
+
+float MaxImpl(const float *x, int32_t /*n*/, int32_t *i) {
+  *i = 1;
+  return x[0];
+}
+
+float SumExpImpl(const float * /*x*/, int32_t /*n*/, float /*shift*/,
+                 int32_t *i) {
+  *i = 0;
+  return 0;
+}
+
+void AddScalarImpl(float * /*x*/, int32_t /*n*/, float /*c*/, int32_t *i) {
+  *i = 0;
+}
+
+void Int16ToFloatImpl(const int16_t * /*x*/, int32_t /*n*/, float /*scale*/,
+                      float * /*y*/, int32_t *i) {
+  *i = 0;
+}
+
+}  // namespace scalar
+
+namespace base = scalar;
+
+#endif
+
+// The kernels of one instruction set. Each of them processes x[0..*i) and
+// leaves the tail x[*i..n) to the caller.
+struct Kernels {
+  int32_t width;
+  float (*max)(const float *x, int32_t n, int32_t *i);
+  float (*sum_exp)(const float *x, int32_t n, float shift, int32_t *i);
+  void (*add_scalar)(float *x, int32_t n, float c, int32_t *i);
+  void (*int16_to_float)(const int16_t *x, int32_t n, float scale, float *y,
+                         int32_t *i);
+};
+
+const Kernels &GetKernels() {
+  static const Kernels kernels = []() -> Kernels {
+#if defined(SHERPA_ONNX_X86_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return {avx512::kWidth, avx512::MaxImpl, avx512::SumExpImpl,
+              avx512::AddScalarImpl, avx512::Int16ToFloatImpl};
+    }
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return {avx2::kWidth, avx2::MaxImpl, avx2::SumExpImpl,
+              avx2::AddScalarImpl, avx2::Int16ToFloatImpl};
+    }
+#elif defined(__AVX512F__)
+    return {avx512::kWidth, avx512::MaxImpl, avx512::SumExpImpl,
+            avx512::AddScalarImpl, avx512::Int16ToFloatImpl};
+#elif defined(__AVX2__) && defined(__FMA__)
+    return {avx2::kWidth, avx2::MaxImpl, avx2::SumExpImpl,
+            avx2::AddScalarImpl, avx2::Int16ToFloatImpl};
+#endif
+
+    return {base::kWidth, base::MaxImpl, base::SumExpImpl,
+            base::AddScalarImpl, base::Int16ToFloatImpl};
+  }();
+
+  return kernels;
+}
+
+}  // namespace
+
+float VecMax(const float *x, int32_t n) {
+  assert(n > 0);
+
+  const auto &k = GetKernels();
+  if (n < k.width) {
+    return *std::max_element(x, x + n);
+  }
+
+  int32_t i = 0;
+  float m = k.max(x, n, &i);
+  for (; i < n; ++i) {
+    m = std::max(m, x[i]);
+  }
+
+  return m;
+}
+
+float VecSumExp(const float *x, int32_t n, float shift) {
+  int32_t i = 0;
+  float s = GetKernels().sum_exp(x, n, shift, &i);
+  for (; i < n; ++i) {
+    s += std::exp(x[i] - shift);
+  }
+
+  return s;
+}
+
+void VecAddScalar(float *x, int32_t n, float c) {
+  int32_t i = 0;
+  GetKernels().add_scalar(x, n, c, &i);
+  for (; i < n; ++i) {
+    x[i] += c;
+  }
+}
+
+void VecInt16ToFloat(const int16_t *x, int32_t n, float scale, float *y) {
+  int32_t i = 0;
+  GetKernels().int16_to_float(x, n, scale, y, &i);
+  for (; i < n; ++i) {
+    y[i] = x[i] * scale;
+  }
+}
+
+}  // namespace sherpa_onnx
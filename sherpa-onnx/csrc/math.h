@@ -71,6 +71,24 @@ struct LogAdd<float> {
   }
 };
 
+// Vectorized kernels for float. They use AVX-512, AVX2 (with FMA), SSE2
+// or NEON and fall back to scalar code otherwise. With GCC and Clang on x86,
+// AVX-512 and AVX2 are selected at runtime if the CPU supports them; other
+// compilers use the instruction set enabled at compile time. See ./math.cc
+
+// Return max(x[0], x[1], ..., x[n-1]). n must be positive.
+float VecMax(const float *x, int32_t n);
+
+// Return sum_i exp(x[i] - shift)
+float VecSumExp(const float *x, int32_t n, float shift);
+
+// x[i] += c
+void VecAddScalar(float *x, int32_t n, float c);
+
+// y[i] = x[i] * scale. Use scale = 1/32768 to convert 16-bit PCM samples
+// to the range [-1, 1).
+void VecInt16ToFloat(const int16_t *x, int32_t n, float scale, float *y);
+
 template <class T>
 void LogSoftmax(T *input, int32_t input_len) {
   assert(input);
@@ -88,6 +106,16 @@ void LogSoftmax(T *input, int32_t input_len) {
   }
 }
 
+template <>
+inline void LogSoftmax<float>(float *input, int32_t input_len) {
+  assert(input);
+
+  float m = VecMax(input, input_len);
+  float sum = VecSumExp(input, input_len, m);
+
+  VecAddScalar(input, input_len, -(m + std::log(sum)));
+}
+
 template <typename T>
 void LogSoftmax(T *in, int32_t w, int32_t h) {
   for (int32_t i = 0; i != h; ++i) {
@@ -105,18 +133,40 @@ void SubtractBlank(T *in, int32_t w, int32_t h, int32_t blank_idx,
   }
 }
 
+// Return the indexes of the topk largest elements of vec, sorted by
+// value in descending order. Ties are broken by the index.
+//
+// It keeps a min-heap of the k best elements seen so far, so most elements
+// are rejected with a single comparison with the root. It does not
+// allocate memory proportional to size.
 template <class T>
 std::vector<int32_t> TopkIndex(const T *vec, int32_t size, int32_t topk) {
-  std::vector<int32_t> vec_index(size);
-  std::iota(vec_index.begin(), vec_index.end(), 0);
+  int32_t k_num = std::min<int32_t>(size, topk);
+  if (k_num <= 0) {
+    return {};
+  }
 
-  std::partial_sort(vec_index.begin(), vec_index.begin() + topk,
-                    vec_index.end(), [vec](int32_t index_1, int32_t index_2) {
-                      return vec[index_1] > vec[index_2];
-                    });
+  // Return true if vec[a] is ranked before vec[b]
+  auto better = [vec](int32_t a, int32_t b) {
+    return vec[a] > vec[b] || (vec[a] == vec[b] && a < b);
+  };
+
+  // heap.front() is the worst one among the k best elements seen so far
+  std::vector<int32_t> heap(k_num);
+  std::iota(heap.begin(), heap.end(), 0);
+  std::make_heap(heap.begin(), heap.end(), better);
+
+  for (int32_t i = k_num; i < size; ++i) {
+    if (vec[i] > vec[heap.front()]) {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = i;
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  }
 
-  int32_t k_num = std::min<int32_t>(size, topk);
-  return {vec_index.begin(), vec_index.begin() + k_num};
+  std::sort_heap(heap.begin(), heap.end(), better);
+
+  return heap;
 }
 
 template <class T>
@@ -27,6 +27,7 @@
 #include "sherpa-onnx/csrc/offline-wenet-ctc-model.h"
 #include "sherpa-onnx/csrc/offline-zipformer-ctc-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace {
 
@@ -48,9 +49,7 @@ namespace sherpa_onnx {
 static ModelType GetModelType(char *model_data, size_t model_data_length,
                               bool debug) {
   Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
   auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
                                              sess_opts);
@@ -135,7 +134,7 @@ std::unique_ptr<OfflineCtcModel> OfflineCtcModel::Create(
   }
 
   {
-    auto buffer = ReadFile(filename);
+    MappedFile buffer(filename);
 
     model_type = GetModelType(buffer.data(), buffer.size(), config.debug);
   }
@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-fire-red-asr-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <numeric>
 #include <tuple>
 #include <utility>
 
@@ -13,36 +14,29 @@
 
 namespace sherpa_onnx {
 
-// Note: this functions works only for batch size == 1 at present
 std::vector<OfflineFireRedAsrDecoderResult>
 OfflineFireRedAsrGreedySearchDecoder::Decode(Ort::Value cross_k,
                                              Ort::Value cross_v) {
   const auto &meta_data = model_->GetModelMetadata();
 
-  auto memory_info =
-      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+  int32_t batch_size = cross_k.GetTensorTypeAndShapeInfo().GetShape()[1];
 
-  // For multilingual models, initial_tokens contains [sot, language, task]
-  //   - language is English by default
-  //   - task is transcribe by default
-  //
-  // For non-multilingual models, initial_tokens contains [sot]
-  std::array<int64_t, 2> token_shape = {1, 1};
-  int64_t token = meta_data.sos_id;
+  std::array<int64_t, 2> token_shape = {batch_size, 1};
+  Ort::Value tokens = Ort::Value::CreateTensor<int64_t>(
+      model_->Allocator(), token_shape.data(), token_shape.size());
 
-  int32_t batch_size = 1;
-
-  Ort::Value tokens = Ort::Value::CreateTensor(
-      memory_info, &token, 1, token_shape.data(), token_shape.size());
+  int64_t *p_tokens = tokens.GetTensorMutableData<int64_t>();
+  std::fill_n(p_tokens, batch_size, meta_data.sos_id);
 
+  // The offset is shared by all utterances, so they advance in lockstep
   std::array<int64_t, 1> offset_shape{1};
   Ort::Value offset = Ort::Value::CreateTensor<int64_t>(
       model_->Allocator(), offset_shape.data(), offset_shape.size());
   *(offset.GetTensorMutableData<int64_t>()) = 0;
 
-  std::vector<OfflineFireRedAsrDecoderResult> ans(1);
+  std::vector<OfflineFireRedAsrDecoderResult> ans(batch_size);
 
-  auto self_kv_cache = model_->GetInitialSelfKVCache();
+  auto self_kv_cache = model_->GetInitialSelfKVCache(batch_size);
 
   std::tuple<Ort::Value, Ort::Value, Ort::Value, Ort::Value, Ort::Value,
              Ort::Value>
@@ -53,29 +47,75 @@ OfflineFireRedAsrGreedySearchDecoder::Decode(Ort::Value cross_k,
                      std::move(cross_v),
                      std::move(offset)};
 
+  // active[r] is the index of the utterance in the r-th row of the
+  // decoder input
+  std::vector<int32_t> active(batch_size);
+  std::iota(active.begin(), active.end(), 0);
+
   for (int32_t i = 0; i < meta_data.max_len; ++i) {
-    decoder_out = model_->ForwardDecoder(View(&tokens),
+    decoder_out = model_->ForwardDecoder(std::move(tokens),
                                          std::move(std::get<1>(decoder_out)),
                                          std::move(std::get<2>(decoder_out)),
                                          std::move(std::get<3>(decoder_out)),
                                          std::move(std::get<4>(decoder_out)),
                                          std::move(std::get<5>(decoder_out)));
 
+    // (num_active, 1, vocab_size)
     const auto &logits = std::get<0>(decoder_out);
     const float *p_logits = logits.GetTensorData<float>();
 
     auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
     int32_t vocab_size = logits_shape[2];
 
-    int32_t max_token_id = static_cast<int32_t>(std::distance(
-        p_logits, std::max_element(p_logits, p_logits + vocab_size)));
-    if (max_token_id == meta_data.eos_id) {
+    // Rows of the decoder input that are not finished
+    std::vector<int32_t> keep;
+    std::vector<int64_t> next_tokens;
+
+    for (int32_t r = 0; r != static_cast<int32_t>(active.size()); ++r) {
+      const float *p = p_logits + r * vocab_size;
+
+      int32_t max_token_id = static_cast<int32_t>(
+          std::distance(p, std::max_element(p, p + vocab_size)));
+      if (max_token_id == meta_data.eos_id) {
+        continue;
+      }
+
+      ans[active[r]].tokens.push_back(max_token_id);
+
+      keep.push_back(r);
+      next_tokens.push_back(max_token_id);
+    }
+
+    if (keep.empty()) {
       break;
     }
 
-    ans[0].tokens.push_back(max_token_id);
+    if (keep.size() != active.size()) {
+      // Drop the finished rows so that they are not run through the decoder
+      // any more
+      std::get<1>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<1>(decoder_out), keep);
+      std::get<2>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<2>(decoder_out), keep);
+      std::get<3>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<3>(decoder_out), keep);
+      std::get<4>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<4>(decoder_out), keep);
+
+      std::vector<int32_t> new_active;
+      new_active.reserve(keep.size());
+      for (auto r : keep) {
+        new_active.push_back(active[r]);
+      }
+      active = std::move(new_active);
+    }
+
+    token_shape = {static_cast<int64_t>(active.size()), 1};
+    tokens = Ort::Value::CreateTensor<int64_t>(
+        model_->Allocator(), token_shape.data(), token_shape.size());
 
-    token = max_token_id;
+    std::copy(next_tokens.begin(), next_tokens.end(),
+              tokens.GetTensorMutableData<int64_t>());
 
     // increment offset
     *(std::get<5>(decoder_out).GetTensorMutableData<int64_t>()) += 1;
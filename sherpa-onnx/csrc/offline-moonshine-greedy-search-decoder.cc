@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-moonshine-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <numeric>
 #include <utility>
 
 #include "sherpa-onnx/csrc/macros.h"
@@ -15,11 +16,7 @@ namespace sherpa_onnx {
 std::vector<OfflineMoonshineDecoderResult>
 OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
   auto encoder_out_shape = encoder_out.GetTensorTypeAndShapeInfo().GetShape();
-  if (encoder_out_shape[0] != 1) {
-    SHERPA_ONNX_LOGE("Support only batch size == 1. Given: %d\n",
-                     static_cast<int32_t>(encoder_out_shape[0]));
-    return {};
-  }
+  int32_t batch_size = encoder_out_shape[0];
 
   auto memory_info =
       Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -34,15 +31,18 @@ OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
 
   int32_t sos = 1;
   int32_t eos = 2;
+
+  // seq_len is shared by all utterances, so they advance in lockstep
   int32_t seq_len = 1;
 
-  std::vector<int32_t> tokens;
+  std::vector<int32_t> tokens(batch_size, sos);
 
-  std::array<int64_t, 2> token_shape = {1, 1};
+  std::array<int64_t, 2> token_shape = {batch_size, 1};
   int64_t seq_len_shape = 1;
 
-  Ort::Value token_tensor = Ort::Value::CreateTensor(
-      memory_info, &sos, 1, token_shape.data(), token_shape.size());
+  Ort::Value token_tensor =
+      Ort::Value::CreateTensor(memory_info, tokens.data(), tokens.size(),
+                               token_shape.data(), token_shape.size());
 
   Ort::Value seq_len_tensor =
       Ort::Value::CreateTensor(memory_info, &seq_len, 1, &seq_len_shape, 1);
@@ -55,20 +55,63 @@ OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
 
   int32_t vocab_size = logits.GetTensorTypeAndShapeInfo().GetShape()[2];
 
+  std::vector<OfflineMoonshineDecoderResult> ans(batch_size);
+
+  // active[r] is the index of the utterance in the r-th row of the
+  // decoder input
+  std::vector<int32_t> active(batch_size);
+  std::iota(active.begin(), active.end(), 0);
+
   for (int32_t i = 0; i != max_len; ++i) {
-    const float *p = logits.GetTensorData<float>();
+    // (num_active, 1, vocab_size)
+    const float *p_logits = logits.GetTensorData<float>();
+
+    // Rows of the decoder input that are not finished
+    std::vector<int32_t> keep;
+    tokens.clear();
+
+    for (int32_t r = 0; r != static_cast<int32_t>(active.size()); ++r) {
+      const float *p = p_logits + r * vocab_size;
+
+      int32_t max_token_id = static_cast<int32_t>(
+          std::distance(p, std::max_element(p, p + vocab_size)));
+      if (max_token_id == eos) {
+        continue;
+      }
 
-    int32_t max_token_id = static_cast<int32_t>(
-        std::distance(p, std::max_element(p, p + vocab_size)));
-    if (max_token_id == eos) {
+      ans[active[r]].tokens.push_back(max_token_id);
+
+      keep.push_back(r);
+      tokens.push_back(max_token_id);
+    }
+
+    if (keep.empty()) {
       break;
     }
-    tokens.push_back(max_token_id);
+
+    if (keep.size() != active.size()) {
+      // Drop the finished rows so that they are not run through the decoder
+      // any more. Note that the batch axis of encoder_out and of all states
+      // is 0.
+      encoder_out = IndexSelectAxis0(model_->Allocator(), &encoder_out, keep);
+      for (auto &s : states) {
+        s = IndexSelectAxis0(model_->Allocator(), &s, keep);
+      }
+
+      std::vector<int32_t> new_active;
+      new_active.reserve(keep.size());
+      for (auto r : keep) {
+        new_active.push_back(active[r]);
+      }
+      active = std::move(new_active);
+    }
 
     seq_len += 1;
 
-    token_tensor = Ort::Value::CreateTensor(
-        memory_info, &tokens.back(), 1, token_shape.data(), token_shape.size());
+    token_shape = {static_cast<int64_t>(tokens.size()), 1};
+    token_tensor =
+        Ort::Value::CreateTensor(memory_info, tokens.data(), tokens.size(),
+                                 token_shape.data(), token_shape.size());
 
     seq_len_tensor =
         Ort::Value::CreateTensor(memory_info, &seq_len, 1, &seq_len_shape, 1);
@@ -84,10 +127,7 @@ OfflineMoonshineGreedySearchDecoder::Decode(Ort::Value encoder_out) {
         std::move(tmp_states));
   }
 
-  OfflineMoonshineDecoderResult ans;
-  ans.tokens = std::move(tokens);
-
-  return {ans};
+  return ans;
 }
 
 }  // namespace sherpa_onnx
@@ -37,7 +37,8 @@ class OfflineMoonshineModel {
   /** Run the encoder model.
    *
    * @param features A float32 tensor of shape (batch_size, T, dim)
-   * @param features_len A int32 tensor of shape (batch_size,)
+   * @param features_len A int32 tensor of shape (1,) containing T. It is
+   *                     shared by all utterances in the batch.
    * @returns A float32 tensor of shape (batch_size, T, dim).
    */
   Ort::Value ForwardEncoder(Ort::Value features, Ort::Value features_len) const;
@@ -12,6 +12,7 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/length-buckets.h"
 #include "sherpa-onnx/csrc/offline-fire-red-asr-decoder.h"
 #include "sherpa-onnx/csrc/offline-fire-red-asr-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-fire-red-asr-model.h"
@@ -89,44 +90,92 @@ class OfflineRecognizerFireRedAsrImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    if (n == 0) {
+      return;
+    }
+
+    int32_t feat_dim = ss[0]->FeatureDim();
+
+    std::vector<std::vector<float>> features(n);
+    std::vector<int32_t> num_frames(n);
+
     for (int32_t i = 0; i != n; ++i) {
-      DecodeStream(ss[i]);
+      features[i] = ss[i]->GetFrames();
+      ApplyCMVN(&features[i]);
+
+      num_frames[i] = features[i].size() / feat_dim;
+    }
+
+    // The decoder has no cross attention mask, so padded encoder frames
+    // change the result. We batch only utterances of similar lengths.
+    for (const auto &bucket :
+         SplitIntoLengthBuckets(num_frames, kMaxLengthRatio, n)) {
+      DecodeBatch(ss, features, num_frames, bucket);
     }
   }
 
   OfflineRecognizerConfig GetConfig() const override { return config_; }
 
  private:
-  void DecodeStream(OfflineStream *s) const {
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+  // Utterances are decoded in the same batch only if the longest one is at
+  // most this many times as long as the shortest one
+  static constexpr float kMaxLengthRatio = 1.05;
+
+  /** Decode the given streams as a batch.
+   *
+   * @param ss All streams.
+   * @param features features[i] contains the features of ss[i] after CMVN.
+   * @param num_frames num_frames[i] is the number of frames of ss[i].
+   * @param indexes Indexes into ss of the streams to decode.
+   */
+  void DecodeBatch(OfflineStream **ss,
+                   const std::vector<std::vector<float>> &features,
+                   const std::vector<int32_t> &num_frames,
+                   const std::vector<int32_t> &indexes) const {
+    int32_t n = indexes.size();
+    int32_t feat_dim = model_->GetModelMetadata().mean.size();
+
+    std::vector<int64_t> x_len_val(n);
+    int64_t max_num_frames = 0;
+    for (int32_t i = 0; i != n; ++i) {
+      x_len_val[i] = num_frames[indexes[i]];
+      max_num_frames = std::max(max_num_frames, x_len_val[i]);
+    }
 
-    int32_t feat_dim = s->FeatureDim();
-    std::vector<float> f = s->GetFrames();
-    ApplyCMVN(&f);
+    // Utterances are padded with zeros, i.e., the mean after CMVN, to the
+    // longest one in the batch
+    std::array<int64_t, 3> shape{n, max_num_frames, feat_dim};
 
-    int64_t num_frames = f.size() / feat_dim;
+    Ort::Value x = Ort::Value::CreateTensor<float>(
+        model_->Allocator(), shape.data(), shape.size());
 
-    std::array<int64_t, 3> shape{1, num_frames, feat_dim};
+    float *p = x.GetTensorMutableData<float>();
+    std::fill_n(p, n * max_num_frames * feat_dim, 0);
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, f.data(), f.size(),
-                                            shape.data(), shape.size());
+    for (int32_t i = 0; i != n; ++i) {
+      const auto &f = features[indexes[i]];
+      std::copy(f.begin(), f.end(), p + i * max_num_frames * feat_dim);
+    }
 
-    int64_t len_shape = 1;
-    Ort::Value x_len =
-        Ort::Value::CreateTensor(memory_info, &num_frames, 1, &len_shape, 1);
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    int64_t len_shape = n;
+    Ort::Value x_len = Ort::Value::CreateTensor(memory_info, x_len_val.data(),
+                                                n, &len_shape, 1);
 
     auto cross_kv = model_->ForwardEncoder(std::move(x), std::move(x_len));
 
     auto results =
         decoder_->Decode(std::move(cross_kv.first), std::move(cross_kv.second));
 
-    auto r = Convert(results[0], symbol_table_);
+    for (int32_t i = 0; i != n; ++i) {
+      auto r = Convert(results[i], symbol_table_);
 
-    r.text = ApplyInverseTextNormalization(std::move(r.text));
-    r.text = ApplyHomophoneReplacer(std::move(r.text));
-    s->SetResult(r);
+      r.text = ApplyInverseTextNormalization(std::move(r.text));
+      r.text = ApplyHomophoneReplacer(std::move(r.text));
+      ss[indexes[i]]->SetResult(r);
+    }
   }
 
   void ApplyCMVN(std::vector<float> *v) const {
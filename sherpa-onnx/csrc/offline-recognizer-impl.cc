@@ -32,6 +32,7 @@
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer-whisper-impl.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 
 namespace sherpa_onnx {
@@ -96,9 +97,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 
   Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
 
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
   std::string model_filename;
   if (!config.model_config.transducer.encoder_filename.empty()) {
@@ -122,7 +121,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
     exit(-1);
   }
 
-  auto buf = ReadFile(model_filename);
+  MappedFile buf(model_filename);
 
   auto encoder_sess =
       std::make_unique<Ort::Session>(env, buf.data(), buf.size(), sess_opts);
@@ -280,9 +279,7 @@ std::unique_ptr<OfflineRecognizerImpl> OfflineRecognizerImpl::Create(
 
   Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
 
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
   std::string model_filename;
   if (!config.model_config.transducer.encoder_filename.empty()) {
@@ -12,6 +12,7 @@
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/length-buckets.h"
 #include "sherpa-onnx/csrc/offline-model-config.h"
 #include "sherpa-onnx/csrc/offline-moonshine-decoder.h"
 #include "sherpa-onnx/csrc/offline-moonshine-greedy-search-decoder.h"
@@ -83,52 +84,135 @@ class OfflineRecognizerMoonshineImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    // The decoder has no cross attention mask, so padded encoder frames
+    // change the result. We batch only utterances of similar lengths.
+    std::vector<std::vector<float>> audio(n);
+    std::vector<int32_t> lengths(n);
     for (int32_t i = 0; i != n; ++i) {
-      DecodeStream(ss[i]);
+      audio[i] = ss[i]->GetFrames();
+      lengths[i] = audio[i].size();
+    }
+
+    for (const auto &bucket :
+         SplitIntoLengthBuckets(lengths, kMaxLengthRatio, n)) {
+      try {
+        DecodeBatch(ss, audio, bucket);
+        continue;
+      } catch (const Ort::Exception &ex) {
+        SHERPA_ONNX_LOGE(
+            "\n\nCaught exception:\n\n%s\n\nNumber of streams: %d",
+            ex.what(), static_cast<int32_t>(bucket.size()));
+      }
+
+      if (bucket.size() == 1) {
+        ss[bucket[0]]->SetResult({});
+        continue;
+      }
+
+      // Decode the streams of the failed batch one by one so that a bad
+      // utterance does not affect the others
+      for (auto i : bucket) {
+        try {
+          DecodeBatch(ss, audio, {i});
+        } catch (const Ort::Exception &ex) {
+          SHERPA_ONNX_LOGE(
+              "\n\nCaught exception:\n\n%s\n\nReturn an empty result. "
+              "Number of audio samples: %d",
+              ex.what(), lengths[i]);
+          ss[i]->SetResult({});
+        }
+      }
     }
   }
 
   OfflineRecognizerConfig GetConfig() const override { return config_; }
 
  private:
-  void DecodeStream(OfflineStream *s) const {
+  // Utterances are decoded in the same batch only if the longest one is at
+  // most this many times as long as the shortest one
+  static constexpr float kMaxLengthRatio = 1.05;
+
+  /** Decode the given streams as a batch. It throws Ort::Exception on
+   * errors.
+   *
+   * @param ss All streams.
+   * @param audio audio[i] contains the samples of ss[i].
+   * @param indexes Indexes into ss of the streams to decode.
+   */
+  void DecodeBatch(OfflineStream **ss,
+                   const std::vector<std::vector<float>> &audio,
+                   const std::vector<int32_t> &indexes) const {
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
-    std::vector<float> audio = s->GetFrames();
+    int32_t n = indexes.size();
+
+    // The preprocessor is run for each utterance separately so that the
+    // number of feature frames of each one is known exactly
+    std::vector<Ort::Value> features;
+    features.reserve(n);
+
+    std::vector<int32_t> num_frames(n);
+    int32_t max_num_frames = 0;
+    int32_t feat_dim = 0;
 
-    try {
-      std::array<int64_t, 2> shape{1, static_cast<int64_t>(audio.size())};
+    for (int32_t i = 0; i != n; ++i) {
+      const auto &samples = audio[indexes[i]];
+
+      std::array<int64_t, 2> shape{1, static_cast<int64_t>(samples.size())};
 
+      // The preprocessor does not modify its input
       Ort::Value audio_tensor = Ort::Value::CreateTensor(
-          memory_info, audio.data(), audio.size(), shape.data(), shape.size());
+          memory_info, const_cast<float *>(samples.data()), samples.size(),
+          shape.data(), shape.size());
+
+      features.push_back(model_->ForwardPreprocessor(std::move(audio_tensor)));
+
+      auto features_shape =
+          features.back().GetTensorTypeAndShapeInfo().GetShape();
 
-      Ort::Value features =
-          model_->ForwardPreprocessor(std::move(audio_tensor));
+      num_frames[i] = features_shape[1];
+      feat_dim = features_shape[2];
+      max_num_frames = std::max(max_num_frames, num_frames[i]);
+    }
+
+    Ort::Value batch_features{nullptr};
+    if (n == 1) {
+      batch_features = std::move(features[0]);
+    } else {
+      // Pad the features with zeros to the longest utterance in the batch
+      std::array<int64_t, 3> shape{n, max_num_frames, feat_dim};
+
+      batch_features = Ort::Value::CreateTensor<float>(
+          model_->Allocator(), shape.data(), shape.size());
 
-      int32_t features_len = features.GetTensorTypeAndShapeInfo().GetShape()[1];
+      float *p = batch_features.GetTensorMutableData<float>();
+      std::fill_n(p, n * max_num_frames * feat_dim, 0);
 
-      int64_t features_shape = 1;
+      for (int32_t i = 0; i != n; ++i) {
+        const float *src = features[i].GetTensorData<float>();
+        std::copy(src, src + num_frames[i] * feat_dim,
+                  p + i * max_num_frames * feat_dim);
+      }
+    }
+
+    // It is the length of the time axis, which is used by the rotary
+    // position embedding of the encoder. It is not a per-utterance length.
+    int64_t features_len_shape = 1;
 
-      Ort::Value features_len_tensor = Ort::Value::CreateTensor(
-          memory_info, &features_len, 1, &features_shape, 1);
+    Ort::Value features_len_tensor = Ort::Value::CreateTensor(
+        memory_info, &max_num_frames, 1, &features_len_shape, 1);
 
-      Ort::Value encoder_out = model_->ForwardEncoder(
-          std::move(features), std::move(features_len_tensor));
+    Ort::Value encoder_out = model_->ForwardEncoder(
+        std::move(batch_features), std::move(features_len_tensor));
 
-      auto results = decoder_->Decode(std::move(encoder_out));
+    auto results = decoder_->Decode(std::move(encoder_out));
 
-      auto r = Convert(results[0], symbol_table_);
+    for (int32_t i = 0; i != n; ++i) {
+      auto r = Convert(results[i], symbol_table_);
       r.text = ApplyInverseTextNormalization(std::move(r.text));
       r.text = ApplyHomophoneReplacer(std::move(r.text));
-      s->SetResult(r);
-    } catch (const Ort::Exception &ex) {
-      SHERPA_ONNX_LOGE(
-          "\n\nCaught exception:\n\n%s\n\nReturn an empty result. Number of "
-          "audio samples: %d",
-          ex.what(), static_cast<int32_t>(audio.size()));
-      return;
+      ss[indexes[i]]->SetResult(r);
     }
   }
 
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,9 +16,11 @@
 #include "sherpa-onnx/csrc/offline-model-config.h"
 #include "sherpa-onnx/csrc/offline-recognizer-impl.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/offline-whisper-beam-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-whisper-decoder.h"
 #include "sherpa-onnx/csrc/offline-whisper-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/offline-whisper-model.h"
+#include "sherpa-onnx/csrc/offline-whisper-windows.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 #include "sherpa-onnx/csrc/transpose.h"
 
@@ -51,9 +54,14 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
     if (config_.decoding_method == "greedy_search") {
       decoder_ = std::make_unique<OfflineWhisperGreedySearchDecoder>(
           config_.model_config.whisper, model_.get());
+    } else if (config_.decoding_method == "beam_search") {
+      decoder_ = std::make_unique<OfflineWhisperBeamSearchDecoder>(
+          config_.model_config.whisper, model_.get(),
+          config_.max_active_paths);
     } else {
       SHERPA_ONNX_LOGE(
-          "Only greedy_search is supported at present for whisper. Given %s",
+          "Only greedy_search and beam_search are supported at present for "
+          "whisper. Given %s",
           config_.decoding_method.c_str());
       exit(-1);
     }
@@ -66,9 +74,66 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
   }
 
   void DecodeStreams(OfflineStream **ss, int32_t n) const override {
-    // batch decoding is not implemented yet
+    decoder_->SetConfig(config_.model_config.whisper);
+
+    if (n == 0) {
+      return;
+    }
+
+    int32_t feat_dim = ss[0]->FeatureDim();
+
+    // Audio longer than 30 seconds is split into windows at quiet frames.
+    // Windows from all streams are decoded in batches and the results of
+    // each stream are concatenated in time order.
+    std::vector<std::vector<float>> features(n);
+    std::vector<Window> windows;
+
+    for (int32_t i = 0; i != n; ++i) {
+      features[i] = ss[i]->GetFrames();
+      int32_t num_frames = features[i].size() / feat_dim;
+
+      auto split = SplitWhisperWindows(features[i].data(), num_frames,
+                                       feat_dim, kMaxWindowFrames,
+                                       kWindowSearchFrames);
+      for (const auto &w : split) {
+        windows.push_back({i, w.start, w.num_frames});
+      }
+    }
+
+    // Put windows of similar lengths into the same batch to reduce padding
+    std::vector<int32_t> order(windows.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&windows](int32_t a, int32_t b) {
+                       return windows[a].num_frames > windows[b].num_frames;
+                     });
+
+    int32_t max_batch_size = config_.model_config.whisper.max_batch_size;
+    int32_t num_windows = windows.size();
+
+    std::vector<OfflineWhisperDecoderResult> results(num_windows);
+    for (int32_t b = 0; b < num_windows; b += max_batch_size) {
+      int32_t batch_size = std::min(max_batch_size, num_windows - b);
+      DecodeWindows(features, windows, order.data() + b, batch_size,
+                    results.data());
+    }
+
+    // windows are in time order within each stream
+    std::vector<OfflineWhisperDecoderResult> merged(n);
+    for (int32_t k = 0; k != num_windows; ++k) {
+      auto &dst = merged[windows[k].stream];
+      auto &src = results[k];
+
+      dst.tokens.insert(dst.tokens.end(), src.tokens.begin(),
+                        src.tokens.end());
+      if (dst.lang.empty()) {
+        dst.lang = std::move(src.lang);
+      }
+    }
+
     for (int32_t i = 0; i != n; ++i) {
-      DecodeStream(ss[i]);
+      auto r = Convert(merged[i], symbol_table_);
+      ss[i]->SetResult(r);
     }
   }
 
@@ -79,27 +144,35 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
   OfflineRecognizerConfig GetConfig() const override { return config_; }
 
  private:
-  void DecodeStream(OfflineStream *s) const {
-    decoder_->SetConfig(config_.model_config.whisper);
-
-    int32_t max_num_frames = 3000;
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    int32_t feat_dim = s->FeatureDim();
-    std::vector<float> f = s->GetFrames();
-    int32_t num_frames = f.size() / feat_dim;
-
-    // we use 50 here so that there will be some zero tail paddings
-    if (num_frames >= max_num_frames - 50) {
-      SHERPA_ONNX_LOGE(
-          "Only waves less than 30 seconds are supported. We process only the "
-          "first 30 seconds and discard the remaining data");
-      num_frames = max_num_frames - 50;
-    }
-
-    model_->NormalizeFeatures(f.data(), num_frames, feat_dim);
-
+  // A whisper model can process at most 30 seconds, i.e., 3000 frames, at a
+  // time. We use 50 frames less so that there will be some zero tail
+  // paddings.
+  static constexpr int32_t kMaxNumFrames = 3000;
+  static constexpr int32_t kMaxWindowFrames = kMaxNumFrames - 50;
+
+  // Look for a cut point in the last 5 seconds of a window
+  static constexpr int32_t kWindowSearchFrames = 500;
+
+  struct Window {
+    // Index of the stream in the batch
+    int32_t stream;
+    int32_t start;
+    int32_t num_frames;
+  };
+
+  /** Decode a batch of windows.
+   *
+   * @param features features[i] contains the features of the i-th stream.
+   * @param windows All windows.
+   * @param indexes Indexes into windows of the windows to decode.
+   * @param n Number of entries in indexes.
+   * @param results results[indexes[i]] is set to the result of the window
+   *                indexes[i]. It is left empty if onnxruntime throws.
+   */
+  void DecodeWindows(const std::vector<std::vector<float>> &features,
+                     const std::vector<Window> &windows,
+                     const int32_t *indexes, int32_t n,
+                     OfflineWhisperDecoderResult *results) const {
     // note that 1000 is an experience-value.
     // You can replace 1000 by other values, say, 100.
     //
@@ -111,42 +184,61 @@ class OfflineRecognizerWhisperImpl : public OfflineRecognizerImpl {
       tail_padding_frames = config_.model_config.whisper.tail_paddings;
     }
 
-    int32_t actual_frames =
-        std::min(num_frames + tail_padding_frames, max_num_frames);
+    int32_t feat_dim = model_->FeatureDim();
+
+    std::vector<int32_t> num_frames(n);
+
+    // All windows are padded to the longest one in the batch
+    int32_t actual_frames = 0;
+    for (int32_t i = 0; i != n; ++i) {
+      num_frames[i] = windows[indexes[i]].num_frames;
+
+      actual_frames = std::max(
+          actual_frames,
+          std::min(num_frames[i] + tail_padding_frames, kMaxNumFrames));
+    }
 
-    std::array<int64_t, 3> shape{1, actual_frames, feat_dim};
+    std::array<int64_t, 3> shape{n, actual_frames, feat_dim};
 
     Ort::Value mel = Ort::Value::CreateTensor<float>(
         model_->Allocator(), shape.data(), shape.size());
 
     float *p_mel = mel.GetTensorMutableData<float>();
-    std::copy(f.data(), f.data() + num_frames * feat_dim, p_mel);
+    std::fill_n(p_mel, n * actual_frames * feat_dim, 0);
+
+    for (int32_t i = 0; i != n; ++i) {
+      const auto &w = windows[indexes[i]];
+      const float *src = features[w.stream].data() + w.start * feat_dim;
+      float *dst = p_mel + i * actual_frames * feat_dim;
 
-    std::fill_n(p_mel + num_frames * feat_dim,
-                (actual_frames - num_frames) * feat_dim, 0);
+      std::copy(src, src + w.num_frames * feat_dim, dst);
+
+      // Each window is normalized on its own, just like a short utterance
+      model_->NormalizeFeatures(dst, w.num_frames, feat_dim);
+    }
 
     mel = Transpose12(model_->Allocator(), &mel);
 
     try {
       auto cross_kv = model_->ForwardEncoder(std::move(mel));
 
-      auto results = decoder_->Decode(std::move(cross_kv.first),
-                                      std::move(cross_kv.second), num_frames);
+      auto r = decoder_->Decode(std::move(cross_kv.first),
+                                std::move(cross_kv.second), num_frames);
 
-      auto r = Convert(results[0], symbol_table_);
-      s->SetResult(r);
+      for (int32_t i = 0; i != n; ++i) {
+        results[indexes[i]] = std::move(r[i]);
+      }
     } catch (const Ort::Exception &ex) {
       SHERPA_ONNX_LOGE(
-          "\n\nCaught exception:\n\n%s\n\nReturn an empty result. Number of "
-          "input frames: %d, Current tail "
+          "\n\nCaught exception:\n\n%s\n\nReturn an empty result. Number "
+          "of windows: %d, number of padded input frames: %d, Current tail "
           "paddings: %d. If you see a lot of such exceptions, please consider "
           "using a larger --whisper-tail-paddings",
-          ex.what(), num_frames, tail_padding_frames);
+          ex.what(), n, actual_frames, tail_padding_frames);
       return;
     }
   }
 
- private:
   OfflineRecognitionResult Convert(const OfflineWhisperDecoderResult &src,
                                    const SymbolTable &sym_table) const {
     OfflineRecognitionResult r;
@@ -33,11 +33,13 @@ void OfflineRecognizerConfig::Register(ParseOptions *po) {
   po->Register(
       "decoding-method", &decoding_method,
       "decoding method,"
-      "Valid values: greedy_search, modified_beam_search. "
-      "modified_beam_search is applicable only for transducer models.");
+      "Valid values: greedy_search, modified_beam_search, beam_search. "
+      "modified_beam_search is applicable only for transducer models. "
+      "beam_search is applicable only for whisper models.");
 
   po->Register("max-active-paths", &max_active_paths,
-               "Used only when decoding_method is modified_beam_search");
+               "Used only when decoding_method is modified_beam_search or "
+               "beam_search. It is the beam size of beam_search.");
 
   po->Register("blank-penalty", &blank_penalty,
                "The penalty applied on blank symbol during decoding. "
@@ -79,6 +81,12 @@ bool OfflineRecognizerConfig::Validate() const {
     }
   }
 
+  if (decoding_method == "beam_search" && max_active_paths <= 0) {
+    SHERPA_ONNX_LOGE("max_active_paths should be positive. Given: %d",
+                     max_active_paths);
+    return false;
+  }
+
   if (!hotwords_file.empty() && decoding_method != "modified_beam_search") {
     SHERPA_ONNX_LOGE(
         "Please use --decoding-method=modified_beam_search if you"
@@ -33,7 +33,7 @@ class OfflineRnnLM::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_{GetSessionOptions(config)},
         allocator_{} {
-    auto buf = ReadFile(config_.model);
+    MappedFile buf(config_.model);
     Init(buf.data(), buf.size());
   }
 
@@ -59,8 +59,7 @@ class OfflineRnnLM::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
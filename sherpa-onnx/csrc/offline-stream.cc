@@ -13,6 +13,7 @@
 
 #include "kaldi-native-fbank/csrc/online-feature.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/resample.h"
 
@@ -154,6 +155,19 @@ class OfflineStream::Impl {
     }
   }
 
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) {
+    // Samples are expected in the range [-32768, 32767] when
+    // normalize_samples is false, so a single conversion is enough
+    float scale = config_.normalize_samples ? 1.0f / 32768 : 1.0f;
+
+    // All of the samples are given at once, so we cannot convert them in
+    // chunks as the streaming feature extractor does
+    std::vector<float> buf(n);
+    VecInt16ToFloat(waveform, n, scale, buf.data());
+    AcceptWaveformImpl(sampling_rate, buf.data(), n);
+  }
+
   void AcceptWaveformImpl(int32_t sampling_rate, const float *waveform,
                           int32_t n) {
     if (sampling_rate != config_.sampling_rate) {
@@ -346,6 +360,11 @@ void OfflineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void OfflineStream::AcceptWaveform(int32_t sampling_rate,
+                                   const int16_t *waveform, int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
 int32_t OfflineStream::FeatureDim() const { return impl_->FeatureDim(); }
 
 std::vector<float> OfflineStream::GetFrames() const {
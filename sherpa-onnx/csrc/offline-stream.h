@@ -77,6 +77,11 @@ class OfflineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  // Same as above except that the input is 16-bit PCM, i.e., samples are
+  // in the range [-32768, 32767]
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /// Return feature dim of this extractor.
   ///
   /// Note: if it is Moonshine, then it returns the number of audio samples
@@ -29,7 +29,7 @@ class OfflineTeleSpeechCtcModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto buf = ReadFile(config_.telespeech_ctc);
+    MappedFile buf(config_.telespeech_ctc);
     Init(buf.data(), buf.size());
   }
 
@@ -82,8 +82,7 @@ class OfflineTeleSpeechCtcModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -21,6 +21,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/run-in-parallel.h"
 #include "sherpa-onnx/csrc/session.h"
 
 namespace sherpa_onnx {
@@ -32,20 +33,12 @@ class OfflineTransducerModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    {
-      auto buf = ReadFile(config.transducer.encoder_filename);
-      InitEncoder(buf.data(), buf.size());
-    }
-
-    {
-      auto buf = ReadFile(config.transducer.decoder_filename);
-      InitDecoder(buf.data(), buf.size());
-    }
-
-    {
-      auto buf = ReadFile(config.transducer.joiner_filename);
-      InitJoiner(buf.data(), buf.size());
-    }
+    LoadInParallel(
+        config.transducer.encoder_filename, config.transducer.decoder_filename,
+        config.transducer.joiner_filename,
+        [this](void *data, size_t n) { InitEncoder(data, n); },
+        [this](void *data, size_t n) { InitDecoder(data, n); },
+        [this](void *data, size_t n) { InitJoiner(data, n); });
   }
 
   template <typename Manager>
@@ -155,8 +148,8 @@ class OfflineTransducerModel::Impl {
 
  private:
   void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -179,8 +172,8 @@ class OfflineTransducerModel::Impl {
   }
 
   void InitDecoder(void *model_data, size_t model_data_length) {
-    decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                   &decoder_input_names_ptr_);
@@ -203,8 +196,8 @@ class OfflineTransducerModel::Impl {
   }
 
   void InitJoiner(void *model_data, size_t model_data_length) {
-    joiner_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                                 sess_opts_);
 
     GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                   &joiner_input_names_ptr_);
@@ -134,7 +134,7 @@ OfflineTransducerModifiedBeamSearchDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
+          new_hyp.AppendToken(new_token);
           new_hyp.timestamps.push_back(t);
           if (context_graphs[i] != nullptr) {
             auto context_res =
@@ -33,8 +33,8 @@ class OfflineTtsKokoroModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto model_buf = ReadFile(config.kokoro.model);
-    auto voices_buf = ReadFile(config.kokoro.voices);
+    MappedFile model_buf(config.kokoro.model);
+    MappedFile voices_buf(config.kokoro.voices);
     Init(model_buf.data(), model_buf.size(), voices_buf.data(),
          voices_buf.size());
   }
@@ -104,8 +104,7 @@ class OfflineTtsKokoroModel::Impl {
  private:
   void Init(void *model_data, size_t model_data_length, const char *voices_data,
             size_t voices_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -5,6 +5,8 @@
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
 
 #include "sherpa-onnx/csrc/macros.h"
 
@@ -21,6 +23,12 @@ void OfflineWebsocketDecoderConfig::Register(ParseOptions *po) {
       "Max utterance length in seconds. If we receive an utterance "
       "longer than this value, we will reject the connection. "
       "If you have enough memory, you can select a large value for it.");
+
+  po->Register("sample-format", &sample_format,
+               "Format of the audio samples sent by the client. Valid "
+               "values: float32, int16. Samples are in little endian. "
+               "float32 samples are normalized to the range [-1, 1]. "
+               "int16 halves the bytes sent over the network.");
 }
 
 void OfflineWebsocketDecoderConfig::Validate() const {
@@ -39,6 +47,13 @@ void OfflineWebsocketDecoderConfig::Validate() const {
                      max_utterance_length);
     exit(-1);
   }
+
+  if (sample_format != "float32" && sample_format != "int16") {
+    SHERPA_ONNX_LOGE(
+        "Expect --sample-format to be one of float32, int16. Given: %s",
+        sample_format.c_str());
+    exit(-1);
+  }
 }
 
 OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
@@ -48,7 +63,9 @@ OfflineWebsocketDecoder::OfflineWebsocketDecoder(OfflineWebsocketServer *server)
 
 void OfflineWebsocketDecoder::Push(connection_hdl hdl, ConnectionDataPtr d) {
   std::lock_guard<std::mutex> lock(mutex_);
+  d->ready_time = std::chrono::steady_clock::now();
   streams_.push_back({hdl, d});
+  server_->GetMetrics().SetQueueDepth(streams_.size());
 }
 
 void OfflineWebsocketDecoder::Decode() {
@@ -75,6 +92,10 @@ void OfflineWebsocketDecoder::Decode() {
   std::vector<std::unique_ptr<OfflineStream>> ss(size);
   std::vector<OfflineStream *> p_ss(size);
 
+  auto &metrics = server_->GetMetrics();
+  auto now = std::chrono::steady_clock::now();
+  double audio_seconds = 0;
+
   for (int32_t i = 0; i != size; ++i) {
     auto &p = streams_.front();
     handles[i] = p.first;
@@ -82,21 +103,40 @@ void OfflineWebsocketDecoder::Decode() {
     streams_.pop_front();
 
     auto sample_rate = connection_data[i]->sample_rate;
-    auto samples =
-        reinterpret_cast<const float *>(&connection_data[i]->data[0]);
-    auto num_samples = connection_data[i]->expected_byte_size / sizeof(float);
+    const int8_t *data = connection_data[i]->data.data();
+    int32_t num_samples =
+        connection_data[i]->expected_byte_size / config_.BytesPerSample();
     auto s = recognizer_.CreateStream();
-    s->AcceptWaveform(sample_rate, samples, num_samples);
+    if (config_.sample_format == "int16") {
+      s->AcceptWaveform(sample_rate, reinterpret_cast<const int16_t *>(data),
+                        num_samples);
+    } else {
+      s->AcceptWaveform(sample_rate, reinterpret_cast<const float *>(data),
+                        num_samples);
+    }
 
     ss[i] = std::move(s);
     p_ss[i] = ss[i].get();
+
+    audio_seconds += static_cast<double>(num_samples) / sample_rate;
+    metrics.OnQueueWait(
+        std::chrono::duration<double>(now - connection_data[i]->ready_time)
+            .count());
   }
 
+  metrics.SetQueueDepth(streams_.size());
+
   lock.unlock();
 
   // Note: DecodeStreams is thread-safe
   recognizer_.DecodeStreams(p_ss.data(), size);
 
+  metrics.OnBatchDecoded(
+      size,
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - now)
+          .count(),
+      audio_seconds);
+
   for (int32_t i = 0; i != size; ++i) {
     connection_hdl hdl = handles[i];
     asio::post(server_->GetConnectionContext(),
@@ -146,6 +186,8 @@ OfflineWebsocketServer::OfflineWebsocketServer(
       [this](connection_hdl hdl, server::message_ptr msg) {
         OnMessage(hdl, msg);
       });
+
+  server_.set_http_handler([this](connection_hdl hdl) { OnHttp(hdl); });
 }
 
 void OfflineWebsocketServer::SetupLog() {
@@ -161,6 +203,7 @@ void OfflineWebsocketServer::SetupLog() {
 void OfflineWebsocketServer::OnOpen(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
   connections_.emplace(hdl, std::make_shared<ConnectionData>());
+  metrics_.OnConnectionOpened();
 
   SHERPA_ONNX_LOGE("Number of active connections: %d",
                    static_cast<int32_t>(connections_.size()));
@@ -168,7 +211,15 @@ void OfflineWebsocketServer::OnOpen(connection_hdl hdl) {
 
 void OfflineWebsocketServer::OnClose(connection_hdl hdl) {
   std::lock_guard<std::mutex> lock(mutex_);
-  connections_.erase(hdl);
+  auto it = connections_.find(hdl);
+  if (it != connections_.end()) {
+    // The client disconnected in the middle of sending an utterance
+    if (it->second->cur > 0) {
+      metrics_.OnConnectionDropped();
+    }
+    connections_.erase(it);
+  }
+  metrics_.OnConnectionClosed();
 
   SHERPA_ONNX_LOGE("Number of active connections: %d",
                    static_cast<int32_t>(connections_.size()));
@@ -188,6 +239,7 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
         // connection now.
         Close(hdl, websocketpp::close::status::normal, "Done");
       } else {
+        metrics_.OnConnectionRejected();
         Close(hdl, websocketpp::close::status::normal,
               std::string("Invalid payload: ") + payload);
       }
@@ -198,6 +250,7 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
 
       if (connection_data->expected_byte_size == 0) {
         if (payload.size() < 8) {
+          metrics_.OnConnectionRejected();
           Close(hdl, websocketpp::close::status::normal,
                 "Payload is too short");
           break;
@@ -208,11 +261,13 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
         connection_data->expected_byte_size =
             *reinterpret_cast<const int32_t *>(p + 4);
 
+        int32_t bytes_per_sample = decoder_.GetConfig().BytesPerSample();
         int32_t max_byte_size_ = decoder_.GetConfig().max_utterance_length *
-                                 connection_data->sample_rate * sizeof(float);
+                                 connection_data->sample_rate *
+                                 bytes_per_sample;
         if (connection_data->expected_byte_size > max_byte_size_) {
           float num_samples =
-              connection_data->expected_byte_size / sizeof(float);
+              connection_data->expected_byte_size / bytes_per_sample;
 
           float duration = num_samples / connection_data->sample_rate;
 
@@ -221,6 +276,7 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
              << decoder_.GetConfig().max_utterance_length
              << " seconds, received length is " << duration << " seconds. "
              << "Payload is too large!";
+          metrics_.OnConnectionRejected();
           Close(hdl, websocketpp::close::status::message_too_big, os.str());
           break;
         }
@@ -259,6 +315,23 @@ void OfflineWebsocketServer::OnMessage(connection_hdl hdl,
   }
 }
 
+void OfflineWebsocketServer::OnHttp(connection_hdl hdl) {
+  auto con = server_.get_con_from_hdl(hdl);
+
+  // Ignore the query string, if any
+  std::string resource = con->get_resource();
+  resource = resource.substr(0, resource.find('?'));
+
+  if (resource == "/metrics") {
+    con->set_status(websocketpp::http::status_code::ok);
+    con->append_header("Content-Type", "text/plain; version=0.0.4");
+    con->set_body(metrics_.ToPrometheus());
+  } else {
+    con->set_status(websocketpp::http::status_code::not_found);
+    con->set_body("Not found. Supported endpoints: /metrics\n");
+  }
+}
+
 void OfflineWebsocketServer::Close(connection_hdl hdl,
                                    websocketpp::close::status::value code,
                                    const std::string &reason) {
@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_OFFLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
@@ -15,6 +16,7 @@
 
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/server-metrics.h"
 #include "sherpa-onnx/csrc/tee-stream.h"
 #include "websocketpp/config/asio_no_tls.hpp"  // TODO(fangjun): support TLS
 #include "websocketpp/server.hpp"
@@ -31,7 +33,8 @@ namespace sherpa_onnx {
  * The next 4 bytes in little endian indicates the total samples in bytes the
  * client will send. The remaining bytes represent audio samples. Each audio
  * sample is a float occupying 4 bytes and is normalized into the range
- * [-1, 1].
+ * [-1, 1]. If the server is started with --sample-format=int16, each audio
+ * sample is instead a 16-bit PCM sample occupying 2 bytes.
  *
  * The byte stream can be broken into arbitrary number of messages.
  * We require that the first message has to be at least 8 bytes so that
@@ -52,6 +55,9 @@ struct ConnectionData {
   // We expect that data.size() == expected_byte_size
   std::vector<int8_t> data;
 
+  // The time when it was put into the decoding queue
+  std::chrono::steady_clock::time_point ready_time;
+
   void Clear() {
     sample_rate = 0;
     expected_byte_size = 0;
@@ -69,6 +75,13 @@ struct OfflineWebsocketDecoderConfig {
 
   float max_utterance_length = 300;  // seconds
 
+  // Format of the audio samples sent by the client: float32 or int16
+  std::string sample_format = "float32";
+
+  int32_t BytesPerSample() const {
+    return sample_format == "int16" ? sizeof(int16_t) : sizeof(float);
+  }
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
@@ -131,6 +144,7 @@ class OfflineWebsocketServer {
 
   asio::io_context &GetConnectionContext() { return io_conn_; }
   server &GetServer() { return server_; }
+  ServerMetrics &GetMetrics() { return metrics_; }
 
   void Run(uint16_t port);
 
@@ -179,6 +193,10 @@ class OfflineWebsocketServer {
   //      a WAVE file, the RIFF header of the WAVE is not sent.
   void OnMessage(connection_hdl hdl, server::message_ptr msg);
 
+  // It handles plain HTTP requests. Only GET /metrics is supported, which
+  // returns metrics in the Prometheus text format.
+  void OnHttp(connection_hdl hdl);
+
   // Close a websocket connection with given code and reason
   void Close(connection_hdl hdl, websocketpp::close::status::value code,
              const std::string &reason);
@@ -197,6 +215,8 @@ class OfflineWebsocketServer {
   std::ofstream log_;
   TeeStream tee_;
 
+  ServerMetrics metrics_;
+
   OfflineWebsocketDecoder decoder_;
 };
 
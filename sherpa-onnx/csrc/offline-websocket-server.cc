@@ -2,10 +2,13 @@
 //
 // Copyright (c)  2022-2023  Xiaomi Corporation
 
+#include <string>
+
 #include "asio.hpp"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/offline-websocket-server-impl.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
 
 static constexpr const char *kUsageMessage = R"(
 Automatic speech recognition with sherpa-onnx using websocket.
@@ -36,6 +39,11 @@ Usage:
   --log-file=./log.txt \
   --max-batch-size=5
 
+Metrics in the Prometheus text format are available over HTTP on the
+same port, e.g.,
+
+  curl http://localhost:6006/metrics
+
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
 for a list of pre-trained models to download.
@@ -64,6 +72,12 @@ int32_t main(int32_t argc, char *argv[]) {
 
   po.Register("port", &port, "The port on which the server will listen.");
 
+  std::string model_cache_dir;
+  po.Register("model-cache-dir", &model_cache_dir,
+              "If not empty, optimized models are cached in this existing "
+              "directory to speed up later startups. It overrides the "
+              "environment variable SHERPA_ONNX_MODEL_CACHE_DIR.");
+
   config.Register(&po);
   po.DisableOption("sample-rate");
 
@@ -82,6 +96,10 @@ int32_t main(int32_t argc, char *argv[]) {
 
   config.Validate();
 
+  if (!model_cache_dir.empty()) {
+    sherpa_onnx::SetOptimizedModelCacheDir(model_cache_dir);
+  }
+
   asio::io_context io_conn;  // for network connections
   asio::io_context io_work;  // for neural network and decoding
 
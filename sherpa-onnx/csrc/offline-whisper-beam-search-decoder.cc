@@ -0,0 +1,297 @@
+// sherpa-onnx/csrc/offline-whisper-beam-search-decoder.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-whisper-beam-search-decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+struct WhisperHypothesis {
+  std::vector<int32_t> tokens;
+
+  // Sum of the log-probabilities of tokens
+  float log_prob = 0;
+
+  // Length-normalized log-probability
+  float Score() const {
+    return log_prob / std::max<int32_t>(1, tokens.size());
+  }
+};
+
+}  // namespace
+
+void OfflineWhisperBeamSearchDecoder::SetConfig(
+    const OfflineWhisperModelConfig &config) {
+  config_ = config;
+}
+
+std::vector<OfflineWhisperDecoderResult>
+OfflineWhisperBeamSearchDecoder::Decode(
+    Ort::Value cross_k, Ort::Value cross_v,
+    const std::vector<int32_t> &num_feature_frames) {
+  int32_t batch_size = num_feature_frames.size();
+
+  // For multilingual models, initial_tokens contains [sot, language, task]
+  //   - language is English by default
+  //   - task is transcribe by default
+  //
+  // For non-multilingual models, initial_tokens contains [sot]
+  std::vector<int64_t> initial_tokens = model_->GetInitialTokens();
+
+  // lang_ids[i] is the language token of the i-th utterance. It is used
+  // only for multilingual models.
+  std::vector<int32_t> lang_ids;
+
+  if (model_->IsMultiLingual()) {
+    if (!config_.language.empty()) {
+      const auto &lang2id = model_->GetLang2ID();
+
+      if (!lang2id.count(config_.language)) {
+        SHERPA_ONNX_LOGE("Invalid language: %s", config_.language.c_str());
+        exit(-1);
+      }
+
+      lang_ids.resize(batch_size, lang2id.at(config_.language));
+    } else {
+      lang_ids = model_->DetectLanguages(cross_k, cross_v);
+    }
+
+    if (config_.task == "translate") {
+      initial_tokens[2] = model_->Translate();
+    } else if (config_.task != "transcribe") {
+      // initial_tokens[2] is transcribe by default
+      SHERPA_ONNX_LOGE(
+          "Unsupported task: %s. Valid values are: transcribe, translate.",
+          config_.task.c_str());
+    }
+  }
+
+  initial_tokens.push_back(model_->NoTimeStampsToken());
+
+  int32_t n_text_ctx = model_->TextCtx();
+  const auto &id2lang = model_->GetID2Lang();
+
+  std::vector<OfflineWhisperDecoderResult> ans(batch_size);
+
+  for (int32_t i = 0; i != batch_size; ++i) {
+    if (!lang_ids.empty()) {
+      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
+      initial_tokens[1] = lang_ids[i];
+
+      if (id2lang.count(lang_ids[i])) {
+        ans[i].lang = id2lang.at(lang_ids[i]);
+      }
+    }
+
+    // The cross attention kv cache of a single utterance. It is copied once
+    // per utterance only if there are several utterances in the batch.
+    Ort::Value this_cross_k{nullptr};
+    Ort::Value this_cross_v{nullptr};
+    if (batch_size == 1) {
+      this_cross_k = std::move(cross_k);
+      this_cross_v = std::move(cross_v);
+    } else {
+      this_cross_k = IndexSelectAxis1(model_->Allocator(), &cross_k, {i});
+      this_cross_v = IndexSelectAxis1(model_->Allocator(), &cross_v, {i});
+    }
+
+    // assume at most 6 tokens per second
+    int32_t max_num_tokens =
+        std::min<int32_t>(num_feature_frames[i] / 100 * 6, n_text_ctx / 2);
+
+    ans[i].tokens = DecodeOne(std::move(this_cross_k), std::move(this_cross_v),
+                              initial_tokens, max_num_tokens);
+  }
+
+  return ans;
+}
+
+std::vector<int32_t> OfflineWhisperBeamSearchDecoder::DecodeOne(
+    Ort::Value cross_k, Ort::Value cross_v,
+    const std::vector<int64_t> &initial_tokens, int32_t max_num_tokens) {
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+  int32_t eot = model_->EOT();
+  int32_t n_text_ctx = model_->TextCtx();
+
+  std::vector<int64_t> prompt = initial_tokens;
+  std::array<int64_t, 2> token_shape{1, static_cast<int64_t>(prompt.size())};
+
+  Ort::Value tokens =
+      Ort::Value::CreateTensor(memory_info, prompt.data(), prompt.size(),
+                               token_shape.data(), token_shape.size());
+
+  std::array<int64_t, 1> offset_shape{1};
+  Ort::Value offset = Ort::Value::CreateTensor<int64_t>(
+      model_->Allocator(), offset_shape.data(), offset_shape.size());
+  int64_t *p_offset = offset.GetTensorMutableData<int64_t>();
+  *p_offset = 0;
+
+  auto self_kv_cache = model_->GetInitialSelfKVCache(1);
+  Ort::Value self_k = std::move(self_kv_cache.first);
+  Ort::Value self_v = std::move(self_kv_cache.second);
+
+  // Used only if share_cross_kv_ is false. They contain
+  // num_repeated_rows copies of cross_k and cross_v.
+  Ort::Value repeated_cross_k{nullptr};
+  Ort::Value repeated_cross_v{nullptr};
+  int32_t num_repeated_rows = 0;
+
+  std::vector<WhisperHypothesis> hyps(1);
+  std::vector<WhisperHypothesis> finished;
+
+  while (true) {
+    int32_t num_hyps = hyps.size();
+
+    // We pass views of the tensors we own so that nothing is lost if
+    // onnxruntime throws and we have to retry
+    auto run = [&]() {
+      // share_cross_kv_ is read only after call_once() below has run
+      if (num_hyps == 1 || share_cross_kv_) {
+        return model_->ForwardDecoder(View(&tokens), View(&self_k),
+                                      View(&self_v), View(&cross_k),
+                                      View(&cross_v), View(&offset));
+      }
+
+      if (num_repeated_rows != num_hyps) {
+        std::vector<int32_t> rows(num_hyps, 0);
+        repeated_cross_k =
+            IndexSelectAxis1(model_->Allocator(), &cross_k, rows);
+        repeated_cross_v =
+            IndexSelectAxis1(model_->Allocator(), &cross_v, rows);
+        num_repeated_rows = num_hyps;
+      }
+
+      return model_->ForwardDecoder(View(&tokens), View(&self_k),
+                                    View(&self_v), View(&repeated_cross_k),
+                                    View(&repeated_cross_v), View(&offset));
+    };
+
+    if (num_hyps > 1) {
+      std::call_once(share_cross_kv_probed_, [&]() {
+        try {
+          run();
+        } catch (const Ort::Exception &ex) {
+          SHERPA_ONNX_LOGE(
+              "The whisper decoder cannot broadcast the cross attention kv "
+              "cache across hypotheses. Repeat it for each hypothesis "
+              "instead.\n%s",
+              ex.what());
+          share_cross_kv_ = false;
+        }
+      });
+    }
+
+    auto decoder_out = run();
+
+    self_k = std::move(std::get<1>(decoder_out));
+    self_v = std::move(std::get<2>(decoder_out));
+
+    *p_offset += token_shape[1];
+
+    auto &logits = std::get<0>(decoder_out);
+    float *p_logits = logits.GetTensorMutableData<float>();
+
+    // (num_hyps, num_tokens, vocab_size). We need only the last token
+    auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
+    int32_t num_tokens = logits_shape[1];
+    int32_t vocab_size = logits_shape[2];
+
+    // Each hypothesis contributes its best beam_size_ + 1 extensions so that
+    // there are enough candidates even if one of them is EOT
+    std::vector<float> candidate_log_probs;
+    std::vector<int32_t> candidate_hyps;
+    std::vector<int32_t> candidate_tokens;
+
+    for (int32_t r = 0; r != num_hyps; ++r) {
+      float *p = p_logits + (r * num_tokens + num_tokens - 1) * vocab_size;
+      LogSoftmax(p, vocab_size);
+
+      for (auto k : TopkIndex(p, vocab_size, beam_size_ + 1)) {
+        candidate_log_probs.push_back(hyps[r].log_prob + p[k]);
+        candidate_hyps.push_back(r);
+        candidate_tokens.push_back(k);
+      }
+    }
+
+    std::vector<WhisperHypothesis> new_hyps;
+    std::vector<int32_t> parents;
+
+    for (auto c : TopkIndex(candidate_log_probs.data(),
+                            candidate_log_probs.size(),
+                            candidate_log_probs.size())) {
+      if (static_cast<int32_t>(new_hyps.size()) == beam_size_) {
+        break;
+      }
+
+      WhisperHypothesis hyp;
+      hyp.log_prob = candidate_log_probs[c];
+      hyp.tokens = hyps[candidate_hyps[c]].tokens;
+
+      if (candidate_tokens[c] == eot) {
+        finished.push_back(std::move(hyp));
+        continue;
+      }
+
+      hyp.tokens.push_back(candidate_tokens[c]);
+
+      if (static_cast<int32_t>(hyp.tokens.size()) >= max_num_tokens) {
+        finished.push_back(std::move(hyp));
+        continue;
+      }
+
+      new_hyps.push_back(std::move(hyp));
+      parents.push_back(candidate_hyps[c]);
+    }
+
+    hyps = std::move(new_hyps);
+
+    if (static_cast<int32_t>(finished.size()) >= beam_size_ || hyps.empty() ||
+        *p_offset >= n_text_ctx - 1) {
+      break;
+    }
+
+    // Reorder the self attention kv cache so that row r belongs to the
+    // parent of hyps[r]
+    self_k = IndexSelectAxis1(model_->Allocator(), &self_k, parents);
+    self_v = IndexSelectAxis1(model_->Allocator(), &self_v, parents);
+
+    token_shape = {static_cast<int64_t>(hyps.size()), 1};
+    tokens = Ort::Value::CreateTensor<int64_t>(
+        model_->Allocator(), token_shape.data(), token_shape.size());
+
+    int64_t *p_tokens = tokens.GetTensorMutableData<int64_t>();
+    for (const auto &h : hyps) {
+      *p_tokens++ = h.tokens.back();
+    }
+  }
+
+  // Unfinished hypotheses compete only if no hypothesis has finished
+  const auto &candidates = finished.empty() ? hyps : finished;
+  if (candidates.empty()) {
+    return {};
+  }
+
+  auto best = std::max_element(
+      candidates.begin(), candidates.end(),
+      [](const WhisperHypothesis &a, const WhisperHypothesis &b) {
+        return a.Score() < b.Score();
+      });
+
+  return best->tokens;
+}
+
+}  // namespace sherpa_onnx
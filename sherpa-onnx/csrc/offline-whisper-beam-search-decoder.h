@@ -0,0 +1,74 @@
+// sherpa-onnx/csrc/offline-whisper-beam-search-decoder.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_WHISPER_BEAM_SEARCH_DECODER_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_WHISPER_BEAM_SEARCH_DECODER_H_
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-whisper-decoder.h"
+#include "sherpa-onnx/csrc/offline-whisper-model.h"
+
+namespace sherpa_onnx {
+
+/** Beam search for whisper.
+ *
+ * Utterances are decoded one by one. All hypotheses of an utterance are
+ * run through the decoder as a batch. Each hypothesis has its own row in
+ * the self attention kv cache, while the cross attention kv cache computed
+ * by the encoder is passed with batch size 1 and broadcast to all
+ * hypotheses by the decoder, so it is never copied per hypothesis.
+ * Decoder models that cannot broadcast it are detected the first time
+ * more than one hypothesis is decoded; from then on, the cross attention
+ * kv cache is repeated for each hypothesis instead.
+ *
+ * Finished hypotheses are ranked by their log-probability divided by
+ * their number of tokens.
+ */
+class OfflineWhisperBeamSearchDecoder : public OfflineWhisperDecoder {
+ public:
+  OfflineWhisperBeamSearchDecoder(const OfflineWhisperModelConfig &config,
+                                  OfflineWhisperModel *model,
+                                  int32_t beam_size)
+      : config_(config), model_(model), beam_size_(beam_size) {}
+
+  std::vector<OfflineWhisperDecoderResult> Decode(
+      Ort::Value cross_k, Ort::Value cross_v,
+      const std::vector<int32_t> &num_feature_frames) override;
+
+  void SetConfig(const OfflineWhisperModelConfig &config) override;
+
+ private:
+  /** Decode a single utterance.
+   *
+   * @param cross_k A 4-D tensor of shape
+   *                (n_text_layer, 1, n_audio_ctx, n_text_state).
+   * @param cross_v A 4-D tensor of shape
+   *                (n_text_layer, 1, n_audio_ctx, n_text_state).
+   * @param initial_tokens The prompt, e.g., [sot, lang, task, notimestamps].
+   * @param max_num_tokens Maximum number of tokens to decode.
+   *
+   * @return Return the decoded tokens.
+   */
+  std::vector<int32_t> DecodeOne(Ort::Value cross_k, Ort::Value cross_v,
+                                 const std::vector<int64_t> &initial_tokens,
+                                 int32_t max_num_tokens);
+
+ private:
+  OfflineWhisperModelConfig config_;
+  OfflineWhisperModel *model_;  // not owned
+  int32_t beam_size_;
+
+  // False if the decoder model cannot broadcast the cross attention kv
+  // cache, in which case it is repeated for each hypothesis. It is written
+  // only once, inside std::call_once(), so that concurrent Decode() calls
+  // do not race on it.
+  std::once_flag share_cross_kv_probed_;
+  bool share_cross_kv_ = true;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_WHISPER_BEAM_SEARCH_DECODER_H_
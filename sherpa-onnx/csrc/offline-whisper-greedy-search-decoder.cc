@@ -5,6 +5,7 @@
 #include "sherpa-onnx/csrc/offline-whisper-greedy-search-decoder.h"
 
 #include <algorithm>
+#include <numeric>
 #include <utility>
 
 #include "sherpa-onnx/csrc/macros.h"
@@ -18,12 +19,14 @@ void OfflineWhisperGreedySearchDecoder::SetConfig(
 }
 
 std::vector<OfflineWhisperDecoderResult>
-OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
-                                          Ort::Value cross_v,
-                                          int32_t num_feature_frames) {
+OfflineWhisperGreedySearchDecoder::Decode(
+    Ort::Value cross_k, Ort::Value cross_v,
+    const std::vector<int32_t> &num_feature_frames) {
   auto memory_info =
       Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
 
+  int32_t batch_size = num_feature_frames.size();
+
   // For multilingual models, initial_tokens contains [sot, language, task]
   //   - language is English by default
   //   - task is transcribe by default
@@ -31,6 +34,10 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
   // For non-multilingual models, initial_tokens contains [sot]
   std::vector<int64_t> initial_tokens = model_->GetInitialTokens();
 
+  // lang_ids[i] is the language token of the i-th utterance. It is used
+  // only for multilingual models.
+  std::vector<int32_t> lang_ids;
+
   if (model_->IsMultiLingual()) {
     if (!config_.language.empty()) {
       const auto &lang2id = model_->GetLang2ID();
@@ -40,15 +47,9 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
         exit(-1);
       }
 
-      int32_t lang_id = lang2id.at(config_.language);
-
-      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
-      initial_tokens[1] = lang_id;
+      lang_ids.resize(batch_size, lang2id.at(config_.language));
     } else {
-      int32_t lang_id = model_->DetectLanguage(cross_k, cross_v);
-
-      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
-      initial_tokens[1] = lang_id;
+      lang_ids = model_->DetectLanguages(cross_k, cross_v);
     }
 
     if (config_.task == "translate") {
@@ -63,12 +64,25 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
 
   initial_tokens.push_back(model_->NoTimeStampsToken());
 
-  int32_t batch_size = 1;
-  std::array<int64_t, 2> token_shape{
-      batch_size, static_cast<int64_t>(initial_tokens.size())};
+  int32_t num_initial_tokens = initial_tokens.size();
+
+  // All utterances share the same prompt except for the language token
+  std::vector<int64_t> batch_initial_tokens;
+  batch_initial_tokens.reserve(batch_size * num_initial_tokens);
+  for (int32_t i = 0; i != batch_size; ++i) {
+    if (!lang_ids.empty()) {
+      // 0: sot, 1: lang_id, 2: task, 3: no_timestamps
+      initial_tokens[1] = lang_ids[i];
+    }
+
+    batch_initial_tokens.insert(batch_initial_tokens.end(),
+                                initial_tokens.begin(), initial_tokens.end());
+  }
+
+  std::array<int64_t, 2> token_shape{batch_size, num_initial_tokens};
 
   Ort::Value tokens = Ort::Value::CreateTensor(
-      memory_info, initial_tokens.data(), initial_tokens.size(),
+      memory_info, batch_initial_tokens.data(), batch_initial_tokens.size(),
       token_shape.data(), token_shape.size());
 
   std::array<int64_t, 1> offset_shape{1};
@@ -76,7 +90,7 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
       model_->Allocator(), offset_shape.data(), offset_shape.size());
   *(offset.GetTensorMutableData<int64_t>()) = 0;
 
-  auto self_kv_cache = model_->GetInitialSelfKVCache();
+  auto self_kv_cache = model_->GetInitialSelfKVCache(batch_size);
 
   auto decoder_out = model_->ForwardDecoder(
       std::move(tokens), std::move(self_kv_cache.first),
@@ -84,40 +98,89 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
       std::move(offset));
 
   *(std::get<5>(decoder_out).GetTensorMutableData<int64_t>()) =
-      initial_tokens.size();
+      num_initial_tokens;
 
-  const auto &logits = std::get<0>(decoder_out);
-  const float *p_logits = logits.GetTensorData<float>();
+  int32_t n_text_ctx = model_->TextCtx();
 
-  auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
-  int32_t vocab_size = logits_shape[2];
+  // active[i] is the index of the utterance in the i-th row of the
+  // decoder input
+  std::vector<int32_t> active(batch_size);
+  std::iota(active.begin(), active.end(), 0);
 
-  const float *p_start = p_logits + (logits_shape[1] - 1) * vocab_size;
+  std::vector<int32_t> num_possible_tokens(batch_size);
+  for (int32_t i = 0; i != batch_size; ++i) {
+    // assume at most 6 tokens per second
+    num_possible_tokens[i] = std::min<int32_t>(
+        num_feature_frames[i] / 100 * 6, n_text_ctx / 2);
+  }
 
-  int32_t max_token_id = static_cast<int32_t>(
-      std::distance(p_start, std::max_element(p_start, p_start + vocab_size)));
+  std::vector<OfflineWhisperDecoderResult> ans(batch_size);
 
-  int32_t n_text_ctx = model_->TextCtx();
+  while (true) {
+    const auto &logits = std::get<0>(decoder_out);
+    const float *p_logits = logits.GetTensorData<float>();
 
-  std::vector<int32_t> predicted_tokens;
+    // (num_active, num_tokens, vocab_size). We need only the last token
+    auto logits_shape = logits.GetTensorTypeAndShapeInfo().GetShape();
+    int32_t num_tokens = logits_shape[1];
+    int32_t vocab_size = logits_shape[2];
 
-  // assume at most 6 tokens per second
-  int32_t num_possible_tokens = num_feature_frames / 100 * 6;
-  num_possible_tokens = std::min<int32_t>(num_possible_tokens, n_text_ctx / 2);
+    // Rows of the decoder input that are not finished
+    std::vector<int32_t> keep;
+    std::vector<int64_t> next_tokens;
 
-  for (int32_t i = 0; i < num_possible_tokens; ++i) {
-    if (max_token_id == model_->EOT()) {
+    for (int32_t r = 0; r != static_cast<int32_t>(active.size()); ++r) {
+      const float *p_start =
+          p_logits + (r * num_tokens + num_tokens - 1) * vocab_size;
+
+      int32_t max_token_id = static_cast<int32_t>(std::distance(
+          p_start, std::max_element(p_start, p_start + vocab_size)));
+
+      auto &predicted_tokens = ans[active[r]].tokens;
+      int32_t num_predicted_tokens = predicted_tokens.size();
+
+      if (max_token_id == model_->EOT() ||
+          num_predicted_tokens >= num_possible_tokens[active[r]]) {
+        continue;
+      }
+
+      predicted_tokens.push_back(max_token_id);
+
+      keep.push_back(r);
+      next_tokens.push_back(max_token_id);
+    }
+
+    if (keep.empty()) {
       break;
     }
 
-    predicted_tokens.push_back(max_token_id);
+    if (keep.size() != active.size()) {
+      // Drop the finished rows so that they are not run through the decoder
+      // any more
+      std::get<1>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<1>(decoder_out), keep);
+      std::get<2>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<2>(decoder_out), keep);
+      std::get<3>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<3>(decoder_out), keep);
+      std::get<4>(decoder_out) = IndexSelectAxis1(
+          model_->Allocator(), &std::get<4>(decoder_out), keep);
+
+      std::vector<int32_t> new_active;
+      new_active.reserve(keep.size());
+      for (auto r : keep) {
+        new_active.push_back(active[r]);
+      }
+      active = std::move(new_active);
+    }
 
-    std::array<int64_t, 2> token_shape{1, 1};
+    std::array<int64_t, 2> token_shape{static_cast<int64_t>(active.size()),
+                                       1};
     Ort::Value tokens = Ort::Value::CreateTensor<int64_t>(
         model_->Allocator(), token_shape.data(), token_shape.size());
 
-    int64_t *p_tokens = tokens.GetTensorMutableData<int64_t>();
-    p_tokens[0] = max_token_id;
+    std::copy(next_tokens.begin(), next_tokens.end(),
+              tokens.GetTensorMutableData<int64_t>());
 
     decoder_out = model_->ForwardDecoder(std::move(tokens),
                                          std::move(std::get<1>(decoder_out)),
@@ -133,25 +196,15 @@ OfflineWhisperGreedySearchDecoder::Decode(Ort::Value cross_k,
     if (*p_offset >= n_text_ctx - 1) {
       break;
     }
-
-    const auto &logits = std::get<0>(decoder_out);
-    const float *p_logits = logits.GetTensorData<float>();
-
-    max_token_id = static_cast<int64_t>(std::distance(
-        p_logits, std::max_element(p_logits, p_logits + vocab_size)));
   }
 
-  std::vector<OfflineWhisperDecoderResult> ans(1);
-
   const auto &id2lang = model_->GetID2Lang();
-  if (id2lang.count(initial_tokens[1])) {
-    ans[0].lang = id2lang.at(initial_tokens[1]);
-  } else {
-    ans[0].lang = "";
+  for (int32_t i = 0; i != batch_size; ++i) {
+    if (!lang_ids.empty() && id2lang.count(lang_ids[i])) {
+      ans[i].lang = id2lang.at(lang_ids[i]);
+    }
   }
 
-  ans[0].tokens = std::move(predicted_tokens);
-
   return ans;
 }
 
@@ -39,6 +39,12 @@ void OfflineWhisperModelConfig::Register(ParseOptions *po) {
       "Since we have removed the 30-second constraint, we need to add some "
       "tail padding frames "
       "so that whisper can detect the eot token. Leave it to -1 to use 1000.");
+
+  po->Register(
+      "whisper-max-batch-size", &max_batch_size,
+      "Audio longer than 30 seconds is split into windows of at most 30 "
+      "seconds. It is the maximum number of windows that are encoded and "
+      "decoded together. Larger values are faster but use more memory.");
 }
 
 bool OfflineWhisperModelConfig::Validate() const {
@@ -72,6 +78,12 @@ bool OfflineWhisperModelConfig::Validate() const {
     return false;
   }
 
+  if (max_batch_size < 1) {
+    SHERPA_ONNX_LOGE("--whisper-max-batch-size should be positive. Given: %d",
+                     max_batch_size);
+    return false;
+  }
+
   return true;
 }
 
@@ -83,7 +95,8 @@ std::string OfflineWhisperModelConfig::ToString() const {
   os << "decoder=\"" << decoder << "\", ";
   os << "language=\"" << language << "\", ";
   os << "task=\"" << task << "\", ";
-  os << "tail_paddings=" << tail_paddings << ")";
+  os << "tail_paddings=" << tail_paddings << ", ";
+  os << "max_batch_size=" << max_batch_size << ")";
 
   return os.str();
 }
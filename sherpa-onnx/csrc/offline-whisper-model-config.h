@@ -38,16 +38,23 @@ struct OfflineWhisperModelConfig {
   //   - 300 for multilingual models
   int32_t tail_paddings = -1;
 
+  // Audio longer than 30 seconds is split into windows of at most 30
+  // seconds. It is the maximum number of windows, possibly from different
+  // streams, that are run through the model together.
+  int32_t max_batch_size = 8;
+
   OfflineWhisperModelConfig() = default;
   OfflineWhisperModelConfig(const std::string &encoder,
                             const std::string &decoder,
                             const std::string &language,
-                            const std::string &task, int32_t tail_paddings)
+                            const std::string &task, int32_t tail_paddings,
+                            int32_t max_batch_size = 8)
       : encoder(encoder),
         decoder(decoder),
         language(language),
         task(task),
-        tail_paddings(tail_paddings) {}
+        tail_paddings(tail_paddings),
+        max_batch_size(max_batch_size) {}
 
   void Register(ParseOptions *po);
   bool Validate() const;
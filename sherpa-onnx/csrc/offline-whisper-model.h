@@ -77,13 +77,25 @@ class OfflineWhisperModel {
   int32_t DetectLanguage(Ort::Value &cross_k,   // NOLINT
                          Ort::Value &cross_v);  // NOLINT
 
+  /** Same as DetectLanguage() but for a batch of N utterances.
+   *
+   * @return Return a vector of size N containing the language token ID
+   *         of each utterance.
+   */
+  std::vector<int32_t> DetectLanguages(Ort::Value &cross_k,   // NOLINT
+                                       Ort::Value &cross_v);  // NOLINT
+
   /** Return the initial self kv cache in a pair
    *  - n_layer_self_k_cache A 4-D tensor of shape
    *                         (n_text_layer, N, n_audio_ctx, n_text_state).
    *  - n_layer_self_v_cache A 4-D tensor of shape
    *                         (n_text_layer, N, n_audio_ctx, n_text_state).
+   *
+   * N is 1 for the first overload and batch_size for the second one.
    */
   std::pair<Ort::Value, Ort::Value> GetInitialSelfKVCache() const;
+  std::pair<Ort::Value, Ort::Value> GetInitialSelfKVCache(
+      int32_t batch_size) const;
   const std::vector<int64_t> &GetInitialTokens() const;
   const std::vector<int32_t> &GetAllLanguageIDs() const;
   const std::unordered_map<std::string, int32_t> &GetLang2ID() const;
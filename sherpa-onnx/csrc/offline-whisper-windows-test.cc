@@ -0,0 +1,68 @@
+// sherpa-onnx/csrc/offline-whisper-windows-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-whisper-windows.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(SplitWhisperWindows, Short) {
+  std::vector<float> features(10 * 2);
+  auto windows = SplitWhisperWindows(features.data(), 10, 2, 10, 3);
+  ASSERT_EQ(windows.size(), 1);
+  EXPECT_EQ(windows[0].start, 0);
+  EXPECT_EQ(windows[0].num_frames, 10);
+}
+
+TEST(SplitWhisperWindows, CutAtSilence) {
+  int32_t num_frames = 250;
+  int32_t feat_dim = 3;
+  std::vector<float> features(num_frames * feat_dim, 1);
+
+  // Silence around frames 90 and 170
+  for (int32_t t : {90, 170}) {
+    for (int32_t i = t - 2; i <= t + 2; ++i) {
+      for (int32_t d = 0; d != feat_dim; ++d) {
+        features[i * feat_dim + d] = -10;
+      }
+    }
+  }
+
+  auto windows =
+      SplitWhisperWindows(features.data(), num_frames, feat_dim, 100, 40);
+  ASSERT_EQ(windows.size(), 3);
+
+  // The cuts are inside the silent regions, up to the smoothing
+  EXPECT_EQ(windows[0].start, 0);
+  EXPECT_NEAR(windows[1].start, 90, 5);
+  EXPECT_NEAR(windows[2].start, 170, 5);
+
+  EXPECT_EQ(windows[0].num_frames, windows[1].start);
+  EXPECT_EQ(windows[1].start + windows[1].num_frames, windows[2].start);
+  EXPECT_EQ(windows[2].start + windows[2].num_frames, num_frames);
+}
+
+TEST(SplitWhisperWindows, Coverage) {
+  int32_t num_frames = 1003;
+  std::vector<float> features(num_frames);
+  for (int32_t t = 0; t != num_frames; ++t) {
+    features[t] = (t * 37) % 11;
+  }
+
+  auto windows = SplitWhisperWindows(features.data(), num_frames, 1, 100, 30);
+
+  int32_t expected_start = 0;
+  for (const auto &w : windows) {
+    EXPECT_EQ(w.start, expected_start);
+    EXPECT_GT(w.num_frames, 0);
+    EXPECT_LE(w.num_frames, 100);
+    expected_start += w.num_frames;
+  }
+  EXPECT_EQ(expected_start, num_frames);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,68 @@
+// sherpa-onnx/csrc/offline-whisper-windows.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/offline-whisper-windows.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// Number of neighbouring frames on each side used to smooth the loudness
+static constexpr int32_t kSmoothFrames = 5;
+
+std::vector<WhisperWindow> SplitWhisperWindows(const float *features,
+                                               int32_t num_frames,
+                                               int32_t feat_dim,
+                                               int32_t max_window_frames,
+                                               int32_t search_frames) {
+  std::vector<WhisperWindow> ans;
+  if (num_frames <= max_window_frames) {
+    ans.push_back({0, num_frames});
+    return ans;
+  }
+
+  search_frames = std::max(1, std::min(search_frames, max_window_frames / 2));
+
+  // prefix[i] is the sum of the loudness of frames [0, i)
+  std::vector<double> prefix(num_frames + 1);
+  for (int32_t t = 0; t != num_frames; ++t) {
+    const float *p = features + static_cast<int64_t>(t) * feat_dim;
+
+    double sum = 0;
+    for (int32_t d = 0; d != feat_dim; ++d) {
+      sum += p[d];
+    }
+
+    prefix[t + 1] = prefix[t] + sum / feat_dim;
+  }
+
+  int32_t start = 0;
+  while (num_frames - start > max_window_frames) {
+    int32_t end = start + max_window_frames;
+
+    // Cut before the quietest frame in [end - search_frames, end)
+    int32_t best = end;
+    double best_loudness = 0;
+    for (int32_t t = end - search_frames; t != end; ++t) {
+      int32_t lo = std::max(0, t - kSmoothFrames);
+      int32_t hi = std::min(num_frames, t + kSmoothFrames + 1);
+      double loudness = (prefix[hi] - prefix[lo]) / (hi - lo);
+
+      if (best == end || loudness < best_loudness) {
+        best = t;
+        best_loudness = loudness;
+      }
+    }
+
+    ans.push_back({start, best - start});
+    start = best;
+  }
+
+  ans.push_back({start, num_frames - start});
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,47 @@
+// sherpa-onnx/csrc/offline-whisper-windows.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_OFFLINE_WHISPER_WINDOWS_H_
+#define SHERPA_ONNX_CSRC_OFFLINE_WHISPER_WINDOWS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+struct WhisperWindow {
+  // Index of the first frame of this window in the utterance
+  int32_t start = 0;
+  int32_t num_frames = 0;
+};
+
+/** Split the features of a long utterance into consecutive windows that
+ * whisper can decode one by one.
+ *
+ * Each window except the last one ends at the quietest frame among its
+ * last search_frames frames, so that a cut rarely falls inside a word.
+ * The loudness of a frame is the mean of its log-mel features averaged
+ * over a few neighbouring frames.
+ *
+ * @param features Pointer to a 2-D array of shape (num_frames, feat_dim)
+ *                 containing log-mel features before normalization.
+ * @param num_frames Number of frames.
+ * @param feat_dim Feature dimension.
+ * @param max_window_frames Maximum number of frames of a window.
+ * @param search_frames Number of frames at the end of a window in which
+ *                      to look for a cut point. It is clamped to
+ *                      [1, max_window_frames / 2].
+ *
+ * @return Return the windows in time order. They cover all frames without
+ *         overlapping. It contains a single window if num_frames does
+ *         not exceed max_window_frames.
+ */
+std::vector<WhisperWindow> SplitWhisperWindows(const float *features,
+                                               int32_t num_frames,
+                                               int32_t feat_dim,
+                                               int32_t max_window_frames,
+                                               int32_t search_frames);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_OFFLINE_WHISPER_WINDOWS_H_
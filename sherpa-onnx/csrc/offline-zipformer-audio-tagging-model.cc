@@ -21,7 +21,7 @@ class OfflineZipformerAudioTaggingModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto buf = ReadFile(config_.zipformer.model);
+    MappedFile buf(config_.zipformer.model);
     Init(buf.data(), buf.size());
   }
 
@@ -52,8 +52,7 @@ class OfflineZipformerAudioTaggingModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
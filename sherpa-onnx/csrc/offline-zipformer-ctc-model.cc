@@ -31,7 +31,7 @@ class OfflineZipformerCtcModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto buf = ReadFile(config_.zipformer_ctc.model);
+    MappedFile buf(config_.zipformer_ctc.model);
     Init(buf.data(), buf.size());
   }
 
@@ -61,8 +61,7 @@ class OfflineZipformerCtcModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
@@ -0,0 +1,103 @@
+// sherpa-onnx/csrc/online-batched-states-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-batched-states.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+
+namespace sherpa_onnx {
+
+// Return a tensor of shape (2, batch_size, 3). Entry (i, b, k) is
+// 100 * (b + offset) + 10 * i + k
+static Ort::Value MakeState(OrtAllocator *allocator, int32_t batch_size,
+                            int32_t offset) {
+  std::array<int64_t, 3> shape{2, batch_size, 3};
+  Ort::Value ans =
+      Ort::Value::CreateTensor<float>(allocator, shape.data(), shape.size());
+
+  float *p = ans.GetTensorMutableData<float>();
+  for (int32_t i = 0; i != 2; ++i) {
+    for (int32_t b = 0; b != batch_size; ++b) {
+      for (int32_t k = 0; k != 3; ++k) {
+        *p++ = 100 * (b + offset) + 10 * i + k;
+      }
+    }
+  }
+
+  return ans;
+}
+
+static std::vector<Ort::Value> MakeStates(OrtAllocator *allocator,
+                                          int32_t batch_size,
+                                          int32_t offset) {
+  std::vector<Ort::Value> ans;
+  ans.push_back(MakeState(allocator, batch_size, offset));
+  return ans;
+}
+
+static void CheckState(const Ort::Value &v,
+                       const std::vector<int32_t> &offsets) {
+  auto shape = v.GetTensorTypeAndShapeInfo().GetShape();
+  ASSERT_EQ(shape.size(), 3);
+  ASSERT_EQ(shape[0], 2);
+  ASSERT_EQ(shape[1], offsets.size());
+  ASSERT_EQ(shape[2], 3);
+
+  const float *p = v.GetTensorData<float>();
+  for (int32_t i = 0; i != 2; ++i) {
+    for (int32_t offset : offsets) {
+      for (int32_t k = 0; k != 3; ++k) {
+        EXPECT_EQ(*p++, 100 * offset + 10 * i + k);
+      }
+    }
+  }
+}
+
+TEST(OnlineBatchedStates, FindStatesBatchAxes) {
+  Ort::AllocatorWithDefaultOptions allocator;
+
+  auto single = MakeStates(allocator, 1, 0);
+  auto stacked = MakeStates(allocator, 2, 0);
+
+  auto axes = FindStatesBatchAxes(single, stacked);
+  ASSERT_EQ(axes.size(), 1);
+  EXPECT_EQ(axes[0], 1);
+
+  // No axis differs
+  EXPECT_TRUE(FindStatesBatchAxes(single, single).empty());
+}
+
+TEST(OnlineBatchedStates, GatherStates) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  std::vector<int32_t> axes = {1};
+
+  // Rows 0, 1, 2 of the previous batch have offsets 0, 1, 2
+  auto batched = std::make_shared<OnlineBatchedStates>(
+      MakeStates(allocator, 3, 0), 3, axes, allocator, nullptr);
+
+  std::array<OnlineStream, 4> streams;
+  for (int32_t i = 0; i != 3; ++i) {
+    streams[i].SetBatchedStates(batched, i);
+  }
+  streams[3].SetStates(MakeStates(allocator, 1, 7));
+
+  // A permutation of a subset of the previous batch plus a new stream
+  std::array<OnlineStream *, 3> ss{&streams[2], &streams[3], &streams[0]};
+  auto states = GatherStates(allocator, ss.data(), ss.size(), axes);
+  ASSERT_EQ(states.size(), 1);
+  CheckState(states[0], {2, 7, 0});
+
+  // The batched states are not modified, so the remaining row can
+  // still be taken
+  auto &row = streams[1].GetStates();
+  ASSERT_EQ(row.size(), 1);
+  CheckState(row[0], {1});
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,263 @@
+// sherpa-onnx/csrc/online-batched-states.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-batched-states.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+/** Row j of the result along `axis` is row rows[j] of src[j] along `axis`.
+ *
+ * All tensors in src must have the same type and the same shape apart from
+ * `axis`. Otherwise, it returns Ort::Value{nullptr}.
+ */
+Ort::Value GatherRows(OrtAllocator *allocator,
+                      const std::vector<const Ort::Value *> &src,
+                      const std::vector<int32_t> &rows, int32_t axis) {
+  auto info = src[0]->GetTensorTypeAndShapeInfo();
+  auto type = info.GetElementType();
+  std::vector<int64_t> shape = info.GetShape();
+
+  int32_t element_size = GetElementSize(type);
+  if (element_size == 0 || axis < 0 ||
+      axis >= static_cast<int32_t>(shape.size())) {
+    return Ort::Value{nullptr};
+  }
+
+  int32_t n = static_cast<int32_t>(src.size());
+  std::vector<int64_t> batch_sizes(n);
+  for (int32_t j = 0; j != n; ++j) {
+    auto j_info = src[j]->GetTensorTypeAndShapeInfo();
+    std::vector<int64_t> j_shape = j_info.GetShape();
+    if (j_info.GetElementType() != type || j_shape.size() != shape.size()) {
+      return Ort::Value{nullptr};
+    }
+
+    for (int32_t d = 0; d != static_cast<int32_t>(shape.size()); ++d) {
+      if (d != axis && j_shape[d] != shape[d]) {
+        return Ort::Value{nullptr};
+      }
+    }
+
+    if (rows[j] < 0 || rows[j] >= j_shape[axis]) {
+      return Ort::Value{nullptr};
+    }
+
+    batch_sizes[j] = j_shape[axis];
+  }
+
+  int64_t outer = 1;
+  for (int32_t d = 0; d != axis; ++d) {
+    outer *= shape[d];
+  }
+
+  int64_t row_bytes = element_size;
+  for (int32_t d = axis + 1; d != static_cast<int32_t>(shape.size()); ++d) {
+    row_bytes *= shape[d];
+  }
+
+  shape[axis] = n;
+  Ort::Value ans =
+      Ort::Value::CreateTensor(allocator, shape.data(), shape.size(), type);
+
+  auto dst = static_cast<uint8_t *>(ans.GetTensorMutableRawData());
+  for (int64_t o = 0; o != outer; ++o) {
+    for (int32_t j = 0; j != n; ++j) {
+      // Tensors are never modified here. GetTensorMutableRawData() is used
+      // since older versions of onnxruntime have no const version of it.
+      const auto p = static_cast<const uint8_t *>(
+          const_cast<Ort::Value *>(src[j])->GetTensorMutableRawData());
+      std::memcpy(dst, p + (o * batch_sizes[j] + rows[j]) * row_bytes,
+                  row_bytes);
+      dst += row_bytes;
+    }
+  }
+
+  return ans;
+}
+
+}  // namespace
+
+OnlineBatchedStates::OnlineBatchedStates(std::vector<Ort::Value> states,
+                                         int32_t batch_size,
+                                         std::vector<int32_t> batch_axes,
+                                         OrtAllocator *allocator,
+                                         UnStackFunc unstack)
+    : states_(std::move(states)),
+      batch_size_(batch_size),
+      batch_axes_(std::move(batch_axes)),
+      allocator_(allocator),
+      unstack_(std::move(unstack)) {}
+
+std::vector<Ort::Value> OnlineBatchedStates::TakeRow(int32_t row) {
+  if (!batch_axes_.empty()) {
+    // Copy only the given row. states_ is not modified, so other streams
+    // may gather their rows at the same time.
+    if (row < 0 || row >= batch_size_) {
+      SHERPA_ONNX_LOGE("Invalid row %d. Batch size: %d", row, batch_size_);
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    std::vector<Ort::Value> ans;
+    ans.reserve(states_.size());
+    for (int32_t k = 0; k != static_cast<int32_t>(states_.size()); ++k) {
+      ans.push_back(
+          GatherRows(allocator_, {&states_[k]}, {row}, batch_axes_[k]));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_taken_rows_ += 1;
+
+    return ans;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (unstacked_.empty()) {
+    if (states_.empty()) {
+      SHERPA_ONNX_LOGE("The batched states have already been taken");
+      SHERPA_ONNX_EXIT(-1);
+    }
+
+    unstacked_ = unstack_(std::move(states_));
+    states_.clear();
+  }
+
+  if (row < 0 || row >= static_cast<int32_t>(unstacked_.size())) {
+    SHERPA_ONNX_LOGE("Invalid row %d. Batch size: %d", row,
+                     static_cast<int32_t>(unstacked_.size()));
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  std::vector<Ort::Value> ans = std::move(unstacked_[row]);
+
+  num_taken_rows_ += 1;
+  if (num_taken_rows_ == batch_size_) {
+    // All rows are taken. Free the memory.
+    unstacked_.clear();
+    unstacked_.shrink_to_fit();
+  }
+
+  return ans;
+}
+
+std::vector<Ort::Value> OnlineBatchedStates::TakeAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_taken_rows_ != 0 || states_.empty()) {
+    SHERPA_ONNX_LOGE("The batched states have already been taken");
+    SHERPA_ONNX_EXIT(-1);
+  }
+
+  num_taken_rows_ = batch_size_;
+
+  return std::move(states_);
+}
+
+bool HasSameBatchedStates(OnlineStream **ss, int32_t n) {
+  const auto &batched = ss[0]->GetBatchedStates();
+  if (!batched || batched->BatchSize() != n) {
+    return false;
+  }
+
+  for (int32_t i = 0; i != n; ++i) {
+    if (ss[i]->GetBatchedStates() != batched ||
+        ss[i]->GetBatchedStatesRow() != i) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::vector<int32_t> FindStatesBatchAxes(
+    const std::vector<Ort::Value> &single,
+    const std::vector<Ort::Value> &stacked) {
+  if (single.size() != stacked.size()) {
+    return {};
+  }
+
+  std::vector<int32_t> ans;
+  ans.reserve(single.size());
+
+  for (int32_t k = 0; k != static_cast<int32_t>(single.size()); ++k) {
+    auto a = single[k].GetTensorTypeAndShapeInfo().GetShape();
+    auto b = stacked[k].GetTensorTypeAndShapeInfo().GetShape();
+    if (a.size() != b.size()) {
+      return {};
+    }
+
+    int32_t axis = -1;
+    for (int32_t d = 0; d != static_cast<int32_t>(a.size()); ++d) {
+      if (a[d] == b[d]) {
+        continue;
+      }
+
+      if (axis != -1 || a[d] != 1 || b[d] != 2) {
+        return {};
+      }
+
+      axis = d;
+    }
+
+    if (axis == -1) {
+      return {};
+    }
+
+    ans.push_back(axis);
+  }
+
+  return ans;
+}
+
+std::vector<Ort::Value> GatherStates(OrtAllocator *allocator,
+                                     OnlineStream **ss, int32_t n,
+                                     const std::vector<int32_t> &batch_axes) {
+  int32_t num_states = static_cast<int32_t>(batch_axes.size());
+
+  std::vector<const std::vector<Ort::Value> *> src(n);
+  std::vector<int32_t> rows(n);
+  for (int32_t i = 0; i != n; ++i) {
+    const auto &batched = ss[i]->GetBatchedStates();
+    if (batched) {
+      src[i] = &batched->GetStates();
+      rows[i] = ss[i]->GetBatchedStatesRow();
+    } else {
+      src[i] = &ss[i]->GetStates();
+      rows[i] = 0;
+    }
+
+    if (static_cast<int32_t>(src[i]->size()) != num_states) {
+      return {};
+    }
+  }
+
+  std::vector<Ort::Value> ans;
+  ans.reserve(num_states);
+
+  std::vector<const Ort::Value *> tensors(n);
+  for (int32_t k = 0; k != num_states; ++k) {
+    for (int32_t i = 0; i != n; ++i) {
+      tensors[i] = &(*src[i])[k];
+    }
+
+    Ort::Value v = GatherRows(allocator, tensors, rows, batch_axes[k]);
+    if (!v) {
+      return {};
+    }
+
+    ans.push_back(std::move(v));
+  }
+
+  return ans;
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,130 @@
+// sherpa-onnx/csrc/online-batched-states.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_BATCHED_STATES_H_
+#define SHERPA_ONNX_CSRC_ONLINE_BATCHED_STATES_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+
+namespace sherpa_onnx {
+
+class OnlineStream;
+
+/** Model states of a batch of streams returned by the last call to
+ * DecodeStreams().
+ *
+ * Instead of unstacking the batched states into per-stream states after
+ * each chunk, every stream of the batch keeps a reference to this object
+ * together with its row in it. If the next batch contains exactly the same
+ * streams in the same order, the batched states are fed to the model
+ * as they are, so neither UnStackStates() nor StackStates() is invoked.
+ *
+ * Otherwise, if the batch axis of each state is known, only the rows of
+ * the streams in the next batch are copied from the batched states. See
+ * GatherStates(). If it is not known, the batched states are unstacked
+ * once, on demand, when the first stream of this batch asks for its own
+ * states.
+ */
+class OnlineBatchedStates {
+ public:
+  using UnStackFunc = std::function<std::vector<std::vector<Ort::Value>>(
+      std::vector<Ort::Value>)>;
+
+  /**
+   * @param states  Batched states returned by the model.
+   * @param batch_size  Number of streams in this batch.
+   * @param batch_axes  batch_axes[k] is the batch axis of states[k]. If it
+   *                    is empty, rows are taken with `unstack`.
+   * @param allocator  It allocates the states of a row if batch_axes is
+   *                   not empty. Not owned.
+   * @param unstack  It is called at most once to unstack `states` if
+   *                 batch_axes is empty.
+   */
+  OnlineBatchedStates(std::vector<Ort::Value> states, int32_t batch_size,
+                      std::vector<int32_t> batch_axes, OrtAllocator *allocator,
+                      UnStackFunc unstack);
+
+  int32_t BatchSize() const { return batch_size_; }
+
+  /** Return the batched states.
+   *
+   * They are never modified once this object is created, except by
+   * TakeAll(), so they can be read without locking while any stream still
+   * refers to this object.
+   */
+  const std::vector<Ort::Value> &GetStates() const { return states_; }
+
+  const std::vector<int32_t> &GetBatchAxes() const { return batch_axes_; }
+
+  /** Return the states of the given row.
+   *
+   * It can be called at most once for each row. It is thread-safe.
+   */
+  std::vector<Ort::Value> TakeRow(int32_t row);
+
+  /** Return the batched states.
+   *
+   * It can be called at most once and only if no row has been taken.
+   */
+  std::vector<Ort::Value> TakeAll();
+
+ private:
+  std::mutex mutex_;
+  std::vector<Ort::Value> states_;
+  std::vector<std::vector<Ort::Value>> unstacked_;
+  int32_t batch_size_ = 0;
+  int32_t num_taken_rows_ = 0;
+  std::vector<int32_t> batch_axes_;
+  OrtAllocator *allocator_ = nullptr;  // not owned
+  UnStackFunc unstack_;
+};
+
+/** Return true if ss[i] holds row i of the same OnlineBatchedStates
+ * for all i in [0, n) and the batch contains exactly n streams.
+ *
+ * In that case, the batched states can be used directly as the input
+ * states of the model.
+ */
+bool HasSameBatchedStates(OnlineStream **ss, int32_t n);
+
+/** Find the batch axis of each state tensor of a model.
+ *
+ * @param single  States of a single stream, e.g., the initial states.
+ * @param stacked  The result of stacking two copies of `single` with the
+ *                 StackStates() of the model.
+ *
+ * @return Return ans[k], the only axis in which single[k] and stacked[k]
+ *         differ. Return an empty vector if there is no such axis for
+ *         some k, in which case the states cannot be gathered by row.
+ */
+std::vector<int32_t> FindStatesBatchAxes(
+    const std::vector<Ort::Value> &single,
+    const std::vector<Ort::Value> &stacked);
+
+/** Stack the states of ss[0..n) by copying their rows.
+ *
+ * The states of a stream that are held in an OnlineBatchedStates are read
+ * from the batched tensors, so a batch that is a subset or a permutation
+ * of previous batches copies only its own rows and nothing is unstacked.
+ * Other streams are expected to have states with batch size 1.
+ *
+ * @param batch_axes  Returned by FindStatesBatchAxes(). It must not be
+ *                    empty.
+ *
+ * @return Return the stacked states. Return an empty vector if the states
+ *         of the streams have different shapes apart from the batch axis,
+ *         in which case the caller should fall back to StackStates().
+ */
+std::vector<Ort::Value> GatherStates(OrtAllocator *allocator,
+                                     OnlineStream **ss, int32_t n,
+                                     const std::vector<int32_t> &batch_axes);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_BATCHED_STATES_H_
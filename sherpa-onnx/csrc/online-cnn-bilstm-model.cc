@@ -21,7 +21,7 @@ class OnlineCNNBiLSTMModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    auto buf = ReadFile(config_.cnn_bilstm);
+    MappedFile buf(config_.cnn_bilstm);
     Init(buf.data(), buf.size());
   }
 
@@ -56,8 +56,7 @@ class OnlineCNNBiLSTMModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
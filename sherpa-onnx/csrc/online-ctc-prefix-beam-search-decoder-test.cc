@@ -0,0 +1,111 @@
+// sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+
+namespace sherpa_onnx {
+
+// Convert probabilities of shape (num_frames, vocab_size) to log probs
+static std::vector<float> ToLogProbs(const std::vector<float> &probs) {
+  std::vector<float> ans(probs.size());
+  for (size_t i = 0; i != probs.size(); ++i) {
+    ans[i] = std::log(probs[i]);
+  }
+  return ans;
+}
+
+// blank is 0. The vocabulary is {blank, a, b}
+TEST(OnlineCtcPrefixBeamSearchDecoder, MergePaths) {
+  OnlineCtcPrefixBeamSearchDecoder decoder(4, 0);
+
+  // The prefix "a" is the sum of the paths "aa", "a-" and "-a"
+  auto log_probs = ToLogProbs({0.5, 0.5, 1e-6, 0.5, 0.5, 1e-6});
+
+  std::vector<OnlineCtcDecoderResult> results(1);
+  decoder.Decode(log_probs.data(), 1, 2, 3, &results);
+
+  EXPECT_EQ(results[0].tokens, (std::vector<int64_t>{1}));
+  EXPECT_EQ(results[0].timestamps, (std::vector<int32_t>{0}));
+  EXPECT_EQ(results[0].frame_offset, 2);
+
+  double best = -1e10;
+  for (const auto &h : results[0].hyps) {
+    best = std::max(best, h.log_prob);
+  }
+  EXPECT_NEAR(best, std::log(0.75), 1e-4);
+}
+
+TEST(OnlineCtcPrefixBeamSearchDecoder, RepeatedTokens) {
+  OnlineCtcPrefixBeamSearchDecoder decoder(4, 0);
+
+  // a - a gives "aa", while a a gives "a"
+  auto log_probs =
+      ToLogProbs({0.1, 0.8, 0.1, 0.8, 0.1, 0.1, 0.1, 0.8, 0.1});
+
+  std::vector<OnlineCtcDecoderResult> results(1);
+  decoder.Decode(log_probs.data(), 1, 3, 3, &results);
+
+  EXPECT_EQ(results[0].tokens, (std::vector<int64_t>{1, 1}));
+  EXPECT_EQ(results[0].timestamps, (std::vector<int32_t>{0, 2}));
+  EXPECT_EQ(results[0].num_trailing_blanks, 0);
+}
+
+// Decoding chunk by chunk gives the same result as decoding at once
+TEST(OnlineCtcPrefixBeamSearchDecoder, Chunks) {
+  OnlineCtcPrefixBeamSearchDecoder decoder(4, 0);
+
+  auto log_probs = ToLogProbs({
+      0.1, 0.6, 0.3,  //
+      0.5, 0.2, 0.3,  //
+      0.2, 0.3, 0.5,  //
+      0.6, 0.2, 0.2,  //
+      0.3, 0.6, 0.1,  //
+      0.8, 0.1, 0.1,  //
+  });
+
+  std::vector<OnlineCtcDecoderResult> expected(1);
+  decoder.Decode(log_probs.data(), 1, 6, 3, &expected);
+
+  std::vector<OnlineCtcDecoderResult> results(1);
+  for (int32_t i = 0; i != 3; ++i) {
+    decoder.Decode(log_probs.data() + i * 2 * 3, 1, 2, 3, &results);
+  }
+
+  EXPECT_EQ(results[0].tokens, expected[0].tokens);
+  EXPECT_EQ(results[0].timestamps, expected[0].timestamps);
+  EXPECT_EQ(results[0].frame_offset, 6);
+  EXPECT_EQ(results[0].num_trailing_blanks, 1);
+}
+
+TEST(OnlineCtcPrefixBeamSearchDecoder, Hotwords) {
+  OnlineCtcPrefixBeamSearchDecoder decoder(4, 0);
+
+  auto log_probs = ToLogProbs({0.05, 0.5, 0.45, 0.9, 0.05, 0.05});
+
+  std::vector<OnlineCtcDecoderResult> results(2);
+  std::vector<float> batch = log_probs;
+  batch.insert(batch.end(), log_probs.begin(), log_probs.end());
+
+  // Only the second stream boosts "b"
+  OnlineStream s0;
+  OnlineStream s1({}, std::make_shared<ContextGraph>(
+                          std::vector<std::vector<int32_t>>{{2}}, 1.0));
+  OnlineStream *ss[2] = {&s0, &s1};
+
+  decoder.Decode(batch.data(), 2, 2, 3, &results, ss, 2);
+
+  EXPECT_EQ(results[0].tokens, (std::vector<int64_t>{1}));
+  EXPECT_EQ(results[1].tokens, (std::vector<int64_t>{2}));
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,362 @@
+// sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/context-graph.h"
+#include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+constexpr double kNegInf = -std::numeric_limits<double>::infinity();
+
+// A path after consuming one more frame. It is either hyps[hyp_index]
+// itself (token == -1) or hyps[hyp_index] extended by token.
+//
+// A Hypothesis is created only for candidates that survive pruning, so
+// we don't copy ys for the paths that are discarded.
+struct Candidate {
+  int32_t hyp_index;
+  int64_t token;
+  double log_prob_blank;
+  double log_prob_non_blank;
+  double lm_log_prob;
+  const ContextState *context_state;
+  double score;
+};
+
+// Return true if ys == prefix + [token]
+bool IsExtension(const std::vector<int64_t> &ys,
+                 const std::vector<int64_t> &prefix, int64_t token) {
+  return ys.size() == prefix.size() + 1 && ys.back() == token &&
+         std::equal(prefix.begin(), prefix.end(), ys.begin());
+}
+
+}  // namespace
+
+struct OnlineCtcPrefixBeamSearchDecoder::Workspace {
+  std::vector<Candidate> candidates;
+
+  // Hash of ys -> index into candidates. Only unextended paths are
+  // added, since hyps contain no duplicated prefixes.
+  std::unordered_multimap<uint64_t, int32_t> index;
+
+  std::vector<int32_t> order;
+  std::vector<Hypothesis> next;
+};
+
+using Workspace = OnlineCtcPrefixBeamSearchDecoder::Workspace;
+
+static void DecodeOneFrame(const float *p, int32_t vocab_size,
+                           int32_t max_active_paths, int32_t blank_id,
+                           OnlineLM *lm, float lm_scale, int32_t t,
+                           const ContextGraph *context_graph,
+                           std::vector<Hypothesis> *hyps, Workspace *ws) {
+  auto &candidates = ws->candidates;
+  auto &index = ws->index;
+  candidates.clear();
+  index.clear();
+
+  int32_t num_hyps = static_cast<int32_t>(hyps->size());
+
+  // Paths that do not extend the prefix: either a blank, or a repeat of
+  // the last token that is collapsed with it
+  for (int32_t i = 0; i != num_hyps; ++i) {
+    const auto &h = (*hyps)[i];
+
+    Candidate c;
+    c.hyp_index = i;
+    c.token = -1;
+    c.log_prob_blank = h.log_prob + p[blank_id];
+    c.log_prob_non_blank =
+        h.ys.empty() ? kNegInf : h.log_prob_non_blank + p[h.ys.back()];
+    c.lm_log_prob = h.lm_log_prob;
+    c.context_state = h.context_state;
+
+    index.emplace(h.Hash(), i);
+    candidates.push_back(c);
+  }
+
+  // Only the most probable tokens of this frame are considered to
+  // extend a prefix
+  auto topk = TopkIndex(p, vocab_size, max_active_paths);
+
+  for (int32_t i = 0; i != num_hyps; ++i) {
+    const auto &h = (*hyps)[i];
+    uint64_t hash = h.Hash();
+
+    for (auto k : topk) {
+      if (k == blank_id) {
+        continue;
+      }
+
+      // A repeated token extends the prefix only if there is a blank
+      // between them
+      double log_prob = (!h.ys.empty() && k == h.ys.back())
+                            ? h.log_prob_blank + p[k]
+                            : h.log_prob + p[k];
+
+      const ContextState *context_state = h.context_state;
+      if (context_graph) {
+        auto context_res = context_graph->ForwardOneStep(
+            context_state, k, false /*strict mode*/);
+        log_prob += std::get<0>(context_res);
+        context_state = std::get<1>(context_res);
+      }
+
+      // The extension may be an existing prefix
+      int32_t found = -1;
+      auto range = index.equal_range(Hypothesis::ExtendHash(hash, k));
+      for (auto it = range.first; it != range.second; ++it) {
+        if (IsExtension((*hyps)[it->second].ys, h.ys, k)) {
+          found = it->second;
+          break;
+        }
+      }
+
+      if (found != -1) {
+        auto &c = candidates[found];
+        c.log_prob_non_blank =
+            LogAdd<double>()(c.log_prob_non_blank, log_prob);
+        continue;
+      }
+
+      Candidate c;
+      c.hyp_index = i;
+      c.token = k;
+      c.log_prob_blank = kNegInf;
+      c.log_prob_non_blank = log_prob;
+      c.lm_log_prob = h.lm_log_prob;
+      if (lm) {
+        c.lm_log_prob +=
+            lm_scale * h.nn_lm_state->scores.GetTensorData<float>()[k];
+      }
+      c.context_state = context_state;
+      candidates.push_back(c);
+    }
+  }
+
+  for (auto &c : candidates) {
+    c.score = LogAdd<double>()(c.log_prob_blank, c.log_prob_non_blank) +
+              c.lm_log_prob;
+  }
+
+  auto &order = ws->order;
+  order.resize(candidates.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (static_cast<int32_t>(order.size()) > max_active_paths) {
+    std::nth_element(order.begin(), order.begin() + max_active_paths,
+                     order.end(), [&candidates](int32_t a, int32_t b) {
+                       return candidates[a].score > candidates[b].score;
+                     });
+    order.resize(max_active_paths);
+  }
+
+  auto &next = ws->next;
+  next.clear();
+  next.reserve(order.size());
+
+  // Extensions are created first since they copy from hyps, which
+  // are moved below
+  for (auto j : order) {
+    const auto &c = candidates[j];
+    if (c.token == -1) {
+      continue;
+    }
+
+    Hypothesis h = (*hyps)[c.hyp_index];
+    h.AppendToken(c.token);
+    h.timestamps.push_back(t);
+    h.log_prob_blank = c.log_prob_blank;
+    h.log_prob_non_blank = c.log_prob_non_blank;
+    h.log_prob = LogAdd<double>()(c.log_prob_blank, c.log_prob_non_blank);
+    h.context_state = c.context_state;
+    if (lm) {
+      // The LM is run later for all streams at once
+      lm->AddLMScoreSF(lm_scale, &h);
+    }
+    next.push_back(std::move(h));
+  }
+
+  for (auto j : order) {
+    const auto &c = candidates[j];
+    if (c.token != -1) {
+      continue;
+    }
+
+    Hypothesis &h = (*hyps)[c.hyp_index];
+    h.log_prob_blank = c.log_prob_blank;
+    h.log_prob_non_blank = c.log_prob_non_blank;
+    h.log_prob = LogAdd<double>()(c.log_prob_blank, c.log_prob_non_blank);
+    next.push_back(std::move(h));
+  }
+
+  hyps->swap(next);
+}
+
+OnlineCtcPrefixBeamSearchDecoder::OnlineCtcPrefixBeamSearchDecoder(
+    int32_t max_active_paths, int32_t blank_id, OnlineLM *lm /*= nullptr*/,
+    float lm_scale /*= 0*/, bool shallow_fusion /*= true*/,
+    OnlineRecognizerStatsCollector *stats /*= nullptr*/)
+    : max_active_paths_(max_active_paths),
+      blank_id_(blank_id),
+      lm_(lm),
+      lm_scale_(lm_scale),
+      shallow_fusion_(shallow_fusion),
+      stats_(stats) {}
+
+OnlineCtcPrefixBeamSearchDecoder::~OnlineCtcPrefixBeamSearchDecoder() =
+    default;
+
+std::unique_ptr<Workspace>
+OnlineCtcPrefixBeamSearchDecoder::AcquireWorkspace() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (idle_workspaces_.empty()) {
+    return std::make_unique<Workspace>();
+  }
+
+  auto ans = std::move(idle_workspaces_.back());
+  idle_workspaces_.pop_back();
+  return ans;
+}
+
+void OnlineCtcPrefixBeamSearchDecoder::ReleaseWorkspace(
+    std::unique_ptr<Workspace> ws) {
+  // Keep the capacity of the buffers but not the pruned paths, which may
+  // hold LM states
+  ws->next.clear();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_workspaces_.push_back(std::move(ws));
+}
+
+void OnlineCtcPrefixBeamSearchDecoder::Decode(
+    const float *log_probs, int32_t batch_size, int32_t num_frames,
+    int32_t vocab_size, std::vector<OnlineCtcDecoderResult> *results,
+    OnlineStream **ss /*=nullptr*/, int32_t /*n = 0*/) {
+  if (batch_size != results->size()) {
+    SHERPA_ONNX_LOGE("Size mismatch! log_probs.size(0) %d, results.size(0): %d",
+                     batch_size, static_cast<int32_t>(results->size()));
+    exit(-1);
+  }
+
+  int32_t max_active_paths = std::max(max_active_paths_, 1);
+
+  // Used during the search only with shallow fusion
+  OnlineLM *sf_lm = shallow_fusion_ ? lm_ : nullptr;
+
+  std::vector<const ContextGraph *> context_graphs(batch_size, nullptr);
+  for (int32_t b = 0; b != batch_size; ++b) {
+    if (ss != nullptr && ss[b]->GetContextGraph() != nullptr) {
+      context_graphs[b] = ss[b]->GetContextGraph().get();
+    }
+
+    auto &r = (*results)[b];
+    if (!r.hyps.empty()) {
+      continue;
+    }
+
+    Hypothesis h;
+    h.context_state =
+        context_graphs[b] ? context_graphs[b]->Root() : nullptr;
+    if (sf_lm) {
+      auto init_states = sf_lm->GetInitStatesSF();
+      auto state = std::make_shared<LMState>();
+      state->scores = std::move(init_states.first);
+      state->states = std::move(init_states.second);
+      h.nn_lm_state = std::move(state);
+    }
+    r.hyps.push_back(std::move(h));
+  }
+
+  std::unique_ptr<Workspace> ws = AcquireWorkspace();
+  std::vector<Hypothesis *> lm_hyps;
+
+  for (int32_t t = 0; t != num_frames; ++t) {
+    for (int32_t b = 0; b != batch_size; ++b) {
+      auto &r = (*results)[b];
+      const float *p =
+          log_probs + (static_cast<int64_t>(b) * num_frames + t) * vocab_size;
+
+      int32_t y = static_cast<int32_t>(
+          std::distance(p, std::max_element(p, p + vocab_size)));
+      if (y == blank_id_) {
+        r.num_trailing_blanks += 1;
+      } else {
+        r.num_trailing_blanks = 0;
+      }
+
+      DecodeOneFrame(p, vocab_size, max_active_paths, blank_id_, sf_lm,
+                     lm_scale_, t + r.frame_offset, context_graphs[b],
+                     &r.hyps, ws.get());
+
+      if (sf_lm) {
+        for (auto &h : r.hyps) {
+          if (static_cast<int32_t>(h.ys.size()) > h.cur_scored_pos) {
+            lm_hyps.push_back(&h);
+          }
+        }
+      }
+    }
+
+    // Run the LM once for the new prefixes of all streams
+    if (!lm_hyps.empty()) {
+      ScopedStageTimer timer(stats_, OnlineRecognizerStage::kLM);
+      sf_lm->UpdateLMStatesSF(lm_hyps);
+      lm_hyps.clear();
+    }
+  }
+
+  ReleaseWorkspace(std::move(ws));
+
+  // classic lm rescore
+  if (lm_ && !shallow_fusion_) {
+    // Prefixes in r.hyps are unique, so no hyps are merged here
+    std::vector<Hypotheses> cur;
+    cur.reserve(batch_size);
+    for (auto &r : *results) {
+      cur.emplace_back(std::move(r.hyps));
+    }
+
+    {
+      ScopedStageTimer timer(stats_, OnlineRecognizerStage::kLM);
+      lm_->ComputeLMScore(lm_scale_, 0 /*context_size*/, &cur);
+    }
+
+    for (int32_t b = 0; b != batch_size; ++b) {
+      auto &hyps = (*results)[b].hyps;
+      hyps.clear();
+      for (auto &p : cur[b]) {
+        hyps.push_back(std::move(p.second));
+      }
+    }
+  }
+
+  for (auto &r : *results) {
+    const auto &best = *std::max_element(
+        r.hyps.begin(), r.hyps.end(),
+        [](const Hypothesis &a, const Hypothesis &b) {
+          return a.TotalLogProb() < b.TotalLogProb();
+        });
+    r.tokens = best.ys;
+    r.timestamps = best.timestamps;
+
+    r.frame_offset += num_frames;
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,65 @@
+// sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#ifndef SHERPA_ONNX_CSRC_ONLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
+#define SHERPA_ONNX_CSRC_ONLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/online-ctc-decoder.h"
+#include "sherpa-onnx/csrc/online-lm.h"
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
+
+namespace sherpa_onnx {
+
+// CTC prefix beam search. Active paths are kept in
+// OnlineCtcDecoderResult::hyps between chunks.
+//
+// If the stream has a ContextGraph, hotwords are boosted when a prefix is
+// extended. If an LM is given, it is applied with shallow fusion or, if
+// shallow_fusion is false, the active paths are rescored with it at the end
+// of each chunk.
+class OnlineCtcPrefixBeamSearchDecoder : public OnlineCtcDecoder {
+ public:
+  OnlineCtcPrefixBeamSearchDecoder(int32_t max_active_paths, int32_t blank_id,
+                                   OnlineLM *lm = nullptr, float lm_scale = 0,
+                                   bool shallow_fusion = true,
+                                   OnlineRecognizerStatsCollector *stats =
+                                       nullptr);
+
+  ~OnlineCtcPrefixBeamSearchDecoder() override;
+
+  // Buffers reused across frames, streams and calls.
+  // It is defined in online-ctc-prefix-beam-search-decoder.cc
+  struct Workspace;
+
+  void Decode(const float *log_probs, int32_t batch_size, int32_t num_frames,
+              int32_t vocab_size, std::vector<OnlineCtcDecoderResult> *results,
+              OnlineStream **ss = nullptr, int32_t n = 0) override;
+
+ private:
+  // Decode() can be called concurrently from several threads, so each
+  // call borrows a workspace and returns it when it is done.
+  std::unique_ptr<Workspace> AcquireWorkspace();
+  void ReleaseWorkspace(std::unique_ptr<Workspace> ws);
+
+ private:
+  int32_t max_active_paths_;
+  int32_t blank_id_;
+  OnlineLM *lm_;  // not owned
+  float lm_scale_;
+  bool shallow_fusion_;  // used only when lm_ is not nullptr
+
+  // If not nullptr, the time spent in the LM is added to it
+  OnlineRecognizerStatsCollector *stats_;  // not owned
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Workspace>> idle_workspaces_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_CTC_PREFIX_BEAM_SEARCH_DECODER_H_
@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/io-binding-runner.h"
 #include "sherpa-onnx/csrc/online-model-config.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 
@@ -70,6 +71,10 @@ class OnlineEbranchformerTransducerModel : public OnlineTransducerModel {
   std::unique_ptr<Ort::Session> decoder_sess_;
   std::unique_ptr<Ort::Session> joiner_sess_;
 
+  // Used only if config.transducer.use_io_binding is true
+  std::unique_ptr<IoBindingRunner> decoder_runner_;
+  std::unique_ptr<IoBindingRunner> joiner_runner_;
+
   std::vector<std::string> encoder_input_names_;
   std::vector<const char *> encoder_input_names_ptr_;
 
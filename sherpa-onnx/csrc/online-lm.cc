@@ -9,6 +9,15 @@
 #include <utility>
 #include <vector>
 
+#if __ANDROID_API__ >= 9
+#include "android/asset_manager.h"
+#include "android/asset_manager_jni.h"
+#endif
+
+#if __OHOS__
+#include "rawfile/raw_file_manager.h"
+#endif
+
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 namespace sherpa_onnx {
@@ -17,4 +26,20 @@ std::unique_ptr<OnlineLM> OnlineLM::Create(const OnlineLMConfig &config) {
   return std::make_unique<OnlineRnnLM>(config);
 }
 
+template <typename Manager>
+std::unique_ptr<OnlineLM> OnlineLM::Create(Manager *mgr,
+                                           const OnlineLMConfig &config) {
+  return std::make_unique<OnlineRnnLM>(mgr, config);
+}
+
+#if __ANDROID_API__ >= 9
+template std::unique_ptr<OnlineLM> OnlineLM::Create(
+    AAssetManager *mgr, const OnlineLMConfig &config);
+#endif
+
+#if __OHOS__
+template std::unique_ptr<OnlineLM> OnlineLM::Create(
+    NativeResourceManager *mgr, const OnlineLMConfig &config);
+#endif
+
 }  // namespace sherpa_onnx
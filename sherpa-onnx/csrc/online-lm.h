@@ -21,6 +21,10 @@ class OnlineLM {
 
   static std::unique_ptr<OnlineLM> Create(const OnlineLMConfig &config);
 
+  template <typename Manager>
+  static std::unique_ptr<OnlineLM> Create(Manager *mgr,
+                                          const OnlineLMConfig &config);
+
   // init states for classic rescore
   virtual std::vector<Ort::Value> GetInitStates() = 0;
 
@@ -49,13 +53,35 @@ class OnlineLM {
   virtual void ComputeLMScore(float scale, int32_t context_size,
                       std::vector<Hypotheses> *hyps) = 0;
 
-  /** This function updates lm_log_prob and nn_lm_scores of hyp (shallow fusion).
+  /** This function updates lm_log_prob and nn_lm_state of hyp (shallow fusion).
    *
    * @param scale LM score
    * @param hyps It is changed in-place.
    *
    */
   virtual void ComputeLMScoreSF(float scale, Hypothesis *hyp) = 0;
+
+  /** ComputeLMScoreSF() split into two steps, so that the LM can run once
+   * for the hypotheses of all streams (shallow fusion).
+   *
+   * AddLMScoreSF() updates hyp->lm_log_prob with the score of
+   * hyp->ys.back() from hyp->nn_lm_state. It does not run the LM.
+   *
+   * @param scale LM score
+   * @param hyp It is changed in-place.
+   */
+  virtual void AddLMScoreSF(float scale, Hypothesis *hyp) = 0;
+
+  /** Run the LM once on ys.back() of all the given hyps and update their
+   * nn_lm_state (shallow fusion).
+   *
+   * Hyps that extend the same state with the same token share one run, and
+   * so do hyps whose new state is still cached in LMState::children.
+   *
+   * @param hyps They are changed in-place. They can be from different
+   *             streams.
+   */
+  virtual void UpdateLMStatesSF(const std::vector<Hypothesis *> &hyps) = 0;
 };
 
 }  // namespace sherpa_onnx
@@ -26,6 +26,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/run-in-parallel.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/unbind.h"
 
@@ -37,20 +38,12 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
       config_(config),
       sess_opts_(GetSessionOptions(config)),
       allocator_{} {
-  {
-    auto buf = ReadFile(config.transducer.encoder);
-    InitEncoder(buf.data(), buf.size());
-  }
-
-  {
-    auto buf = ReadFile(config.transducer.decoder);
-    InitDecoder(buf.data(), buf.size());
-  }
-
-  {
-    auto buf = ReadFile(config.transducer.joiner);
-    InitJoiner(buf.data(), buf.size());
-  }
+  LoadInParallel(
+      config.transducer.encoder, config.transducer.decoder,
+      config.transducer.joiner,
+      [this](void *data, size_t n) { InitEncoder(data, n); },
+      [this](void *data, size_t n) { InitDecoder(data, n); },
+      [this](void *data, size_t n) { InitJoiner(data, n); });
 }
 
 template <typename Manager>
@@ -78,8 +71,8 @@ OnlineLstmTransducerModel::OnlineLstmTransducerModel(
 
 void OnlineLstmTransducerModel::InitEncoder(void *model_data,
                                             size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -110,8 +103,8 @@ void OnlineLstmTransducerModel::InitEncoder(void *model_data,
 
 void OnlineLstmTransducerModel::InitDecoder(void *model_data,
                                             size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                 model_data_length, sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -119,6 +112,12 @@ void OnlineLstmTransducerModel::InitDecoder(void *model_data,
   GetOutputNames(decoder_sess_.get(), &decoder_output_names_,
                  &decoder_output_names_ptr_);
 
+  if (config_.transducer.use_io_binding) {
+    decoder_runner_ = std::make_unique<IoBindingRunner>(
+        decoder_sess_.get(), decoder_input_names_ptr_,
+        decoder_output_names_ptr_);
+  }
+
   // get meta data
   Ort::ModelMetadata meta_data = decoder_sess_->GetModelMetadata();
   if (config_.debug) {
@@ -135,8 +134,7 @@ void OnlineLstmTransducerModel::InitDecoder(void *model_data,
 
 void OnlineLstmTransducerModel::InitJoiner(void *model_data,
                                            size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(env_, model_data,
-                                                model_data_length, sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -144,6 +142,12 @@ void OnlineLstmTransducerModel::InitJoiner(void *model_data,
   GetOutputNames(joiner_sess_.get(), &joiner_output_names_,
                  &joiner_output_names_ptr_);
 
+  if (config_.transducer.use_io_binding) {
+    joiner_runner_ = std::make_unique<IoBindingRunner>(
+        joiner_sess_.get(), joiner_input_names_ptr_,
+        joiner_output_names_ptr_);
+  }
+
   // get meta data
   Ort::ModelMetadata meta_data = joiner_sess_->GetModelMetadata();
   if (config_.debug) {
@@ -251,6 +255,10 @@ OnlineLstmTransducerModel::RunEncoder(Ort::Value features,
 }
 
 Ort::Value OnlineLstmTransducerModel::RunDecoder(Ort::Value decoder_input) {
+  if (decoder_runner_) {
+    return std::move(decoder_runner_->Run(&decoder_input, 1)[0]);
+  }
+
   auto decoder_out = decoder_sess_->Run(
       {}, decoder_input_names_ptr_.data(), &decoder_input, 1,
       decoder_output_names_ptr_.data(), decoder_output_names_ptr_.size());
@@ -261,6 +269,11 @@ Ort::Value OnlineLstmTransducerModel::RunJoiner(Ort::Value encoder_out,
                                                 Ort::Value decoder_out) {
   std::array<Ort::Value, 2> joiner_input = {std::move(encoder_out),
                                             std::move(decoder_out)};
+  if (joiner_runner_) {
+    return std::move(
+        joiner_runner_->Run(joiner_input.data(), joiner_input.size())[0]);
+  }
+
   auto logit =
       joiner_sess_->Run({}, joiner_input_names_ptr_.data(), joiner_input.data(),
                         joiner_input.size(), joiner_output_names_ptr_.data(),
@@ -8,19 +8,26 @@
 #include <algorithm>
 #include <ios>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-batched-states.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
 #include "sherpa-onnx/csrc/online-ctc-fst-decoder.h"
 #include "sherpa-onnx/csrc/online-ctc-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/online-ctc-model.h"
+#include "sherpa-onnx/csrc/online-ctc-prefix-beam-search-decoder.h"
+#include "sherpa-onnx/csrc/online-lm.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/utils.h"
+#include "ssentencepiece/csrc/ssentencepiece.h"
 
 namespace sherpa_onnx {
 
@@ -91,6 +98,19 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       config_.feat_config.normalize_samples = false;
     }
 
+    if (config.decoding_method == "prefix_beam_search") {
+      if (!config_.model_config.bpe_vocab.empty()) {
+        bpe_encoder_ = std::make_unique<ssentencepiece::Ssentencepiece>(
+            config_.model_config.bpe_vocab);
+      }
+
+      InitHotwords(sym_, bpe_encoder_.get());
+
+      if (!config_.lm_config.model.empty()) {
+        lm_ = OnlineLM::Create(config.lm_config);
+      }
+    }
+
     InitDecoder();
   }
 
@@ -108,11 +128,45 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       config_.feat_config.normalize_samples = false;
     }
 
+    if (config.decoding_method == "prefix_beam_search") {
+      if (!config_.model_config.bpe_vocab.empty()) {
+        auto buf = ReadFile(mgr, config_.model_config.bpe_vocab);
+        std::istringstream iss(std::string(buf.begin(), buf.end()));
+        bpe_encoder_ = std::make_unique<ssentencepiece::Ssentencepiece>(iss);
+      }
+
+      InitHotwords(mgr, sym_, bpe_encoder_.get());
+
+      if (!config_.lm_config.model.empty()) {
+        lm_ = OnlineLM::Create(mgr, config.lm_config);
+      }
+    }
+
     InitDecoder();
   }
 
   std::unique_ptr<OnlineStream> CreateStream() const override {
-    auto stream = std::make_unique<OnlineStream>(config_.feat_config);
+    auto stream =
+        std::make_unique<OnlineStream>(config_.feat_config, GetHotwordsGraph());
+    stream->SetStates(model_->GetInitStates());
+    stream->SetFasterDecoder(decoder_->CreateFasterDecoder());
+
+    return stream;
+  }
+
+  std::unique_ptr<OnlineStream> CreateStream(
+      const std::string &hotwords) const override {
+    if (config_.decoding_method != "prefix_beam_search") {
+      SHERPA_ONNX_LOGE(
+          "Hotwords are supported only with prefix_beam_search for streaming "
+          "CTC models. Ignore them");
+      return CreateStream();
+    }
+
+    auto context_graph =
+        CreateHotwordsGraph(hotwords, sym_, bpe_encoder_.get());
+    auto stream =
+        std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     stream->SetStates(model_->GetInitStates());
     stream->SetFasterDecoder(decoder_->CreateFasterDecoder());
 
@@ -139,24 +193,26 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
     int32_t feat_dim = ss[0]->FeatureDim();
 
     std::vector<OnlineCtcDecoderResult> results(n);
-    std::vector<float> features_vec(n * chunk_length * feat_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(n);
+    // Frames of all streams are written directly into this buffer, which
+    // is reused across calls
+    auto features_buf = features_pool_.Acquire(n * chunk_length * feat_dim);
     std::vector<int64_t> all_processed_frames(n);
 
-    for (int32_t i = 0; i != n; ++i) {
-      const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_length);
+    auto stats = GetStatsCollector();
 
-      // Question: should num_processed_frames include chunk_shift?
-      ss[i]->GetNumProcessedFrames() += chunk_shift;
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kFeatures);
+      for (int32_t i = 0; i != n; ++i) {
+        const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
+        ss[i]->GetFrames(num_processed_frames, chunk_length,
+                         features_buf.Data() + i * chunk_length * feat_dim);
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_length * feat_dim);
+        // Question: should num_processed_frames include chunk_shift?
+        ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      results[i] = std::move(ss[i]->GetCtcResult());
-      states_vec[i] = std::move(ss[i]->GetStates());
-      all_processed_frames[i] = num_processed_frames;
+        results[i] = std::move(ss[i]->GetCtcResult());
+        all_processed_frames[i] = num_processed_frames;
+      }
     }
 
     auto memory_info =
@@ -164,13 +220,38 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     std::array<int64_t, 3> x_shape{n, chunk_length, feat_dim};
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                            features_vec.size(), x_shape.data(),
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_buf.Data(),
+                                            features_buf.Size(), x_shape.data(),
                                             x_shape.size());
 
-    auto states = model_->StackStates(std::move(states_vec));
+    std::vector<Ort::Value> states;
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kStackStates);
+      if (HasSameBatchedStates(ss, n)) {
+        // The batch is the same as the previous one, so we can skip
+        // unstacking and stacking the states
+        states = ss[0]->GetBatchedStates()->TakeAll();
+      } else if (!GetStatesBatchAxes().empty()) {
+        // Copy only the rows of the streams in this batch
+        states =
+            GatherStates(model_->Allocator(), ss, n, GetStatesBatchAxes());
+      }
+
+      if (states.empty()) {
+        std::vector<std::vector<Ort::Value>> states_vec(n);
+        for (int32_t i = 0; i != n; ++i) {
+          states_vec[i] = std::move(ss[i]->GetStates());
+        }
+        states = model_->StackStates(std::move(states_vec));
+      }
+    }
+
     int32_t num_states = states.size();
-    auto out = model_->Forward(std::move(x), std::move(states));
+    std::vector<Ort::Value> out;
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kEncoder);
+      out = model_->Forward(std::move(x), std::move(states));
+    }
     std::vector<Ort::Value> out_states;
     out_states.reserve(num_states);
 
@@ -178,17 +259,26 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
       out_states.push_back(std::move(out[k]));
     }
 
-    std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(std::move(out_states));
+    // The next states are unstacked lazily. See OnlineBatchedStates
+    auto next_states = std::make_shared<OnlineBatchedStates>(
+        std::move(out_states), n, GetStatesBatchAxes(), model_->Allocator(),
+        [model = model_.get(), stats](std::vector<Ort::Value> states) {
+          ScopedStageTimer timer(stats, OnlineRecognizerStage::kUnstackStates);
+          return model->UnStackStates(std::move(states));
+        });
 
     std::vector<int64_t> log_probs_shape =
         out[0].GetTensorTypeAndShapeInfo().GetShape();
-    decoder_->Decode(out[0].GetTensorData<float>(), log_probs_shape[0],
-                     log_probs_shape[1], log_probs_shape[2], &results, ss, n);
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kSearch);
+      decoder_->Decode(out[0].GetTensorData<float>(), log_probs_shape[0],
+                       log_probs_shape[1], log_probs_shape[2], &results, ss,
+                       n);
+    }
 
     for (int32_t k = 0; k != n; ++k) {
-      ss[k]->SetCtcResult(results[k]);
-      ss[k]->SetStates(std::move(next_states[k]));
+      ss[k]->SetCtcResult(std::move(results[k]));
+      ss[k]->SetBatchedStates(next_states, k);
     }
   }
 
@@ -245,6 +335,21 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  // Return the batch axis of each encoder state. It is empty if the
+  // states cannot be gathered by row. See FindStatesBatchAxes()
+  const std::vector<int32_t> &GetStatesBatchAxes() const {
+    std::call_once(states_batch_axes_once_, [this]() {
+      std::vector<std::vector<Ort::Value>> states_vec(2);
+      states_vec[0] = model_->GetInitStates();
+      states_vec[1] = model_->GetInitStates();
+      auto stacked = model_->StackStates(std::move(states_vec));
+      auto single = model_->GetInitStates();
+      states_batch_axes_ = FindStatesBatchAxes(single, stacked);
+    });
+
+    return states_batch_axes_;
+  }
+
   void InitDecoder() {
     if (!sym_.Contains("<blk>") && !sym_.Contains("<eps>") &&
         !sym_.Contains("<blank>")) {
@@ -270,6 +375,11 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
           config_.ctc_fst_decoder_config, blank_id);
     } else if (config_.decoding_method == "greedy_search") {
       decoder_ = std::make_unique<OnlineCtcGreedySearchDecoder>(blank_id);
+    } else if (config_.decoding_method == "prefix_beam_search") {
+      decoder_ = std::make_unique<OnlineCtcPrefixBeamSearchDecoder>(
+          config_.max_active_paths, blank_id, lm_.get(),
+          config_.lm_config.scale, config_.lm_config.shallow_fusion,
+          GetStatsCollector());
     } else {
       SHERPA_ONNX_LOGE(
           "Unsupported decoding method: %s for streaming CTC models",
@@ -284,10 +394,15 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     int32_t feat_dim = s->FeatureDim();
 
-    const auto num_processed_frames = s->GetNumProcessedFrames();
-    std::vector<float> frames =
-        s->GetFrames(num_processed_frames, chunk_length);
-    s->GetNumProcessedFrames() += chunk_shift;
+    auto stats = GetStatsCollector();
+
+    std::vector<float> frames;
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kFeatures);
+      const auto num_processed_frames = s->GetNumProcessedFrames();
+      frames = s->GetFrames(num_processed_frames, chunk_length);
+      s->GetNumProcessedFrames() += chunk_shift;
+    }
 
     auto memory_info =
         Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
@@ -296,7 +411,11 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
     Ort::Value x =
         Ort::Value::CreateTensor(memory_info, frames.data(), frames.size(),
                                  x_shape.data(), x_shape.size());
-    auto out = model_->Forward(std::move(x), std::move(s->GetStates()));
+    std::vector<Ort::Value> out;
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kEncoder);
+      out = model_->Forward(std::move(x), std::move(s->GetStates()));
+    }
     int32_t num_states = static_cast<int32_t>(out.size()) - 1;
 
     std::vector<Ort::Value> states;
@@ -312,17 +431,32 @@ class OnlineRecognizerCtcImpl : public OnlineRecognizerImpl {
 
     std::vector<int64_t> log_probs_shape =
         out[0].GetTensorTypeAndShapeInfo().GetShape();
-    decoder_->Decode(out[0].GetTensorData<float>(), log_probs_shape[0],
-                     log_probs_shape[1], log_probs_shape[2], &results, &s, 1);
-    s->SetCtcResult(results[0]);
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kSearch);
+      decoder_->Decode(out[0].GetTensorData<float>(), log_probs_shape[0],
+                       log_probs_shape[1], log_probs_shape[2], &results, &s,
+                       1);
+    }
+    s->SetCtcResult(std::move(results[0]));
   }
 
  private:
   OnlineRecognizerConfig config_;
   std::unique_ptr<OnlineCtcModel> model_;
+  std::unique_ptr<OnlineLM> lm_;
   std::unique_ptr<OnlineCtcDecoder> decoder_;
   SymbolTable sym_;
   Endpoint endpoint_;
+
+  // Used only in prefix_beam_search
+  std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
+
+  // For the batched features input of the encoder
+  mutable FloatBufferPool features_pool_;
+
+  // Computed on first use by GetStatesBatchAxes()
+  mutable std::once_flag states_batch_axes_once_;
+  mutable std::vector<int32_t> states_batch_axes_;
 };
 
 }  // namespace sherpa_onnx
@@ -4,6 +4,9 @@
 
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 
+#include <fstream>
+#include <regex>  // NOLINT
+#include <sstream>
 #include <strstream>
 #include <utility>
 
@@ -18,13 +21,16 @@
 
 #include "fst/extensions/far/far.h"
 #include "kaldifst/csrc/kaldi-fst-io.h"
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-recognizer-ctc-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-paraformer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer-transducer-nemo-impl.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/utils.h"
 
 #if SHERPA_ONNX_ENABLE_RKNN
 #include "sherpa-onnx/csrc/rknn/online-recognizer-ctc-rknn-impl.h"
@@ -60,11 +66,9 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
   if (!config.model_config.transducer.encoder.empty()) {
     Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
 
-    Ort::SessionOptions sess_opts;
-    sess_opts.SetIntraOpNumThreads(1);
-    sess_opts.SetInterOpNumThreads(1);
+    Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
-    auto decoder_model = ReadFile(config.model_config.transducer.decoder);
+    MappedFile decoder_model(config.model_config.transducer.decoder);
     auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
                                                decoder_model.size(), sess_opts);
 
@@ -119,9 +123,7 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
   if (!config.model_config.transducer.encoder.empty()) {
     Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
 
-    Ort::SessionOptions sess_opts;
-    sess_opts.SetIntraOpNumThreads(1);
-    sess_opts.SetInterOpNumThreads(1);
+    Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
     auto decoder_model = ReadFile(mgr, config.model_config.transducer.decoder);
     auto sess = std::make_unique<Ort::Session>(env, decoder_model.data(),
@@ -151,7 +153,7 @@ std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
 }
 
 OnlineRecognizerImpl::OnlineRecognizerImpl(const OnlineRecognizerConfig &config)
-    : config_(config) {
+    : config_(config), stats_(config.feat_config.frame_shift_ms) {
   if (!config.rule_fsts.empty()) {
     std::vector<std::string> files;
     SplitStringToVector(config.rule_fsts, ",", false, &files);
@@ -204,7 +206,7 @@ OnlineRecognizerImpl::OnlineRecognizerImpl(const OnlineRecognizerConfig &config)
 template <typename Manager>
 OnlineRecognizerImpl::OnlineRecognizerImpl(Manager *mgr,
                                            const OnlineRecognizerConfig &config)
-    : config_(config) {
+    : config_(config), stats_(config.feat_config.frame_shift_ms) {
   if (!config.rule_fsts.empty()) {
     std::vector<std::string> files;
     SplitStringToVector(config.rule_fsts, ",", false, &files);
@@ -276,10 +278,96 @@ std::string OnlineRecognizerImpl::ApplyHomophoneReplacer(
   return text;
 }
 
+void OnlineRecognizerImpl::InitHotwords(
+    const SymbolTable &sym, const ssentencepiece::Ssentencepiece *bpe_encoder) {
+  if (!config_.hotwords_buf.empty()) {
+    std::istringstream is(config_.hotwords_buf);
+    InitHotwords(is, sym, bpe_encoder);
+  } else if (!config_.hotwords_file.empty()) {
+    // each line in hotwords_file contains space-separated words
+    std::ifstream is(config_.hotwords_file);
+    if (!is) {
+      SHERPA_ONNX_LOGE("Open hotwords file failed: %s",
+                       config_.hotwords_file.c_str());
+      exit(-1);
+    }
+
+    InitHotwords(is, sym, bpe_encoder);
+  }
+}
+
+template <typename Manager>
+void OnlineRecognizerImpl::InitHotwords(
+    Manager *mgr, const SymbolTable &sym,
+    const ssentencepiece::Ssentencepiece *bpe_encoder) {
+  if (!config_.hotwords_buf.empty()) {
+    std::istringstream is(config_.hotwords_buf);
+    InitHotwords(is, sym, bpe_encoder);
+  } else if (!config_.hotwords_file.empty()) {
+    auto buf = ReadFile(mgr, config_.hotwords_file);
+    std::istringstream is(std::string(buf.begin(), buf.end()));
+    InitHotwords(is, sym, bpe_encoder);
+  }
+}
+
+void OnlineRecognizerImpl::InitHotwords(
+    std::istream &is, const SymbolTable &sym,
+    const ssentencepiece::Ssentencepiece *bpe_encoder) {
+  if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym,
+                      bpe_encoder, &hotwords_, &boost_scores_)) {
+    SHERPA_ONNX_LOGE(
+        "Failed to encode some hotwords, skip them already, see logs above "
+        "for details.");
+  }
+  hotwords_graph_ = std::make_shared<ContextGraph>(
+      hotwords_, config_.hotwords_score, boost_scores_);
+}
+
+ContextGraphPtr OnlineRecognizerImpl::CreateHotwordsGraph(
+    const std::string &hotwords, const SymbolTable &sym,
+    const ssentencepiece::Ssentencepiece *bpe_encoder) const {
+  auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
+  std::istringstream is(hws);
+  std::vector<std::vector<int32_t>> current;
+  std::vector<float> current_scores;
+  if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym,
+                      bpe_encoder, &current, &current_scores)) {
+    SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
+                     hotwords.c_str());
+  }
+
+  int32_t num_default_hws = hotwords_.size();
+  int32_t num_hws = current.size();
+
+  current.insert(current.end(), hotwords_.begin(), hotwords_.end());
+
+  if (!current_scores.empty() && !boost_scores_.empty()) {
+    current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                          boost_scores_.end());
+  } else if (!current_scores.empty() && boost_scores_.empty()) {
+    current_scores.insert(current_scores.end(), num_default_hws,
+                          config_.hotwords_score);
+  } else if (current_scores.empty() && !boost_scores_.empty()) {
+    current_scores.insert(current_scores.end(), num_hws,
+                          config_.hotwords_score);
+    current_scores.insert(current_scores.end(), boost_scores_.begin(),
+                          boost_scores_.end());
+  } else {
+    // Do nothing.
+  }
+
+  return std::make_shared<ContextGraph>(current, config_.hotwords_score,
+                                        current_scores);
+}
+
 #if __ANDROID_API__ >= 9
 template OnlineRecognizerImpl::OnlineRecognizerImpl(
     AAssetManager *mgr, const OnlineRecognizerConfig &config);
 
+template void OnlineRecognizerImpl::InitHotwords(
+    AAssetManager *mgr, const SymbolTable &sym,
+    const ssentencepiece::Ssentencepiece *bpe_encoder);
+
 template std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
     AAssetManager *mgr, const OnlineRecognizerConfig &config);
 #endif
@@ -288,6 +376,10 @@ template std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
 template OnlineRecognizerImpl::OnlineRecognizerImpl(
     NativeResourceManager *mgr, const OnlineRecognizerConfig &config);
 
+template void OnlineRecognizerImpl::InitHotwords(
+    NativeResourceManager *mgr, const SymbolTable &sym,
+    const ssentencepiece::Ssentencepiece *bpe_encoder);
+
 template std::unique_ptr<OnlineRecognizerImpl> OnlineRecognizerImpl::Create(
     NativeResourceManager *mgr, const OnlineRecognizerConfig &config);
 #endif
@@ -5,15 +5,20 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_IMPL_H_
 #define SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_IMPL_H_
 
+#include <istream>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "kaldifst/csrc/text-normalizer.h"
+#include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/homophone-replacer.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/symbol-table.h"
+#include "ssentencepiece/csrc/ssentencepiece.h"
 
 namespace sherpa_onnx {
 
@@ -60,13 +65,48 @@ class OnlineRecognizerImpl {
   std::string ApplyInverseTextNormalization(std::string text) const;
   std::string ApplyHomophoneReplacer(std::string text) const;
 
+  // It is thread-safe. See OnlineRecognizer::EnableStats()
+  OnlineRecognizerStatsCollector *GetStatsCollector() const { return &stats_; }
+
+ protected:
+  /** Load the hotwords shared by all streams from config.hotwords_buf or,
+   * if it is empty, from config.hotwords_file. Used by the impls that
+   * support contextual biasing.
+   */
+  void InitHotwords(const SymbolTable &sym,
+                    const ssentencepiece::Ssentencepiece *bpe_encoder);
+
+  template <typename Manager>
+  void InitHotwords(Manager *mgr, const SymbolTable &sym,
+                    const ssentencepiece::Ssentencepiece *bpe_encoder);
+
+  /** Build the context graph of a stream from the given hotwords, which
+   * are separated by "/", and the ones loaded by InitHotwords().
+   */
+  ContextGraphPtr CreateHotwordsGraph(
+      const std::string &hotwords, const SymbolTable &sym,
+      const ssentencepiece::Ssentencepiece *bpe_encoder) const;
+
+  // Graph of the hotwords loaded by InitHotwords(). It is nullptr if
+  // InitHotwords() has not been called.
+  ContextGraphPtr GetHotwordsGraph() const { return hotwords_graph_; }
+
+ private:
+  void InitHotwords(std::istream &is, const SymbolTable &sym,
+                    const ssentencepiece::Ssentencepiece *bpe_encoder);
+
  private:
   OnlineRecognizerConfig config_;
+  mutable OnlineRecognizerStatsCollector stats_;
   // for inverse text normalization. Used only if
   // config.rule_fsts is not empty or
   // config.rule_fars is not empty
   std::vector<std::unique_ptr<kaldifst::TextNormalizer>> itn_list_;
   std::unique_ptr<HomophoneReplacer> hr_;
+
+  std::vector<std::vector<int32_t>> hotwords_;
+  std::vector<float> boost_scores_;
+  ContextGraphPtr hotwords_graph_;
 };
 
 }  // namespace sherpa_onnx
@@ -6,11 +6,13 @@
 #define SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_PARAFORMER_IMPL_H_
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/cat.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-lm.h"
@@ -18,7 +20,9 @@
 #include "sherpa-onnx/csrc/online-paraformer-model.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
+#include "sherpa-onnx/csrc/unbind.h"
 
 namespace sherpa_onnx {
 
@@ -159,9 +163,80 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
   }
 
   void DecodeStreams(OnlineStream **ss, int32_t n) const override {
-    // TODO(fangjun): Support batch size > 1
+    if (n == 0) {
+      return;
+    }
+
+    int32_t feat_dim = model_.NegativeMean().size();
+
+    // Every stream contributes a chunk with the same number of frames, so
+    // the encoder input needs no padding
+    std::vector<int32_t> num_processed_frames(n);
+    std::vector<float> features;
+    int32_t num_frames = 0;
+
+    for (int32_t i = 0; i != n; ++i) {
+      num_processed_frames[i] = ss[i]->GetNumProcessedFrames();
+
+      std::vector<float> frames = GetChunk(ss[i]);
+      num_frames = frames.size() / feat_dim;
+
+      features.insert(features.end(), frames.begin(), frames.end());
+    }
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 3> x_shape{n, num_frames, feat_dim};
+    Ort::Value x =
+        Ort::Value::CreateTensor(memory_info, features.data(), features.size(),
+                                 x_shape.data(), x_shape.size());
+
+    int64_t x_len_shape = n;
+    std::vector<int32_t> x_len_val(n, num_frames);
+
+    Ort::Value x_length = Ort::Value::CreateTensor(
+        memory_info, x_len_val.data(), n, &x_len_shape, 1);
+
+    auto encoder_out_vec =
+        model_.ForwardEncoder(std::move(x), std::move(x_length));
+
+    auto &encoder_out = encoder_out_vec[0];
+    auto &encoder_out_len = encoder_out_vec[1];
+    auto &alpha = encoder_out_vec[2];
+
+    std::vector<int64_t> encoder_out_shape =
+        encoder_out.GetTensorTypeAndShapeInfo().GetShape();
+
+    int32_t num_encoder_frames = encoder_out_shape[1];
+    int32_t encoder_dim = encoder_out_shape[2];
+
+    float *p_encoder_out = encoder_out.GetTensorMutableData<float>();
+    float *p_alpha = alpha.GetTensorMutableData<float>();
+
+    // CIF search. It is cheap and uses the caches of each stream, so it is
+    // run for each stream separately.
+    //
+    // Streams that fire the same number of tokens in this chunk are decoded
+    // together, so that the acoustic embeddings need no padding, which
+    // would otherwise leak into the decoder states.
+    std::map<int32_t, std::vector<int32_t>> groups;
+    std::vector<std::vector<float>> acoustic_embeddings(n);
+
     for (int32_t i = 0; i != n; ++i) {
-      DecodeStream(ss[i]);
+      RunCif(ss[i], p_encoder_out + i * num_encoder_frames * encoder_dim,
+             p_alpha + i * num_encoder_frames, num_encoder_frames, encoder_dim,
+             &acoustic_embeddings[i]);
+
+      int32_t num_tokens = acoustic_embeddings[i].size() / encoder_dim;
+      if (num_tokens > 0) {
+        groups[num_tokens].push_back(i);
+      }
+    }
+
+    for (const auto &g : groups) {
+      RunDecoder(ss, g.second, g.first, num_processed_frames, &encoder_out,
+                 encoder_out_len, acoustic_embeddings);
     }
   }
 
@@ -209,7 +284,10 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
   }
 
  private:
-  void DecodeStream(OnlineStream *s) const {
+  // Return the features of the next chunk of the stream, including the
+  // overlap with the previous chunk. It updates the number of processed
+  // frames and the feature cache of the stream.
+  std::vector<float> GetChunk(OnlineStream *s) const {
     const auto num_processed_frames = s->GetNumProcessedFrames();
     std::vector<float> frames = s->GetFrames(num_processed_frames, chunk_size_);
     s->GetNumProcessedFrames() += chunk_size_ - 1;
@@ -235,47 +313,29 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
     std::copy(frames.end() - feat_cache.size(), frames.end(),
               feat_cache.begin());
 
-    int32_t num_frames = frames.size() / feat_dim;
-
-    auto memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-
-    std::array<int64_t, 3> x_shape{1, num_frames, feat_dim};
-    Ort::Value x =
-        Ort::Value::CreateTensor(memory_info, frames.data(), frames.size(),
-                                 x_shape.data(), x_shape.size());
-
-    int64_t x_len_shape = 1;
-    int32_t x_len_val = num_frames;
-
-    Ort::Value x_length =
-        Ort::Value::CreateTensor(memory_info, &x_len_val, 1, &x_len_shape, 1);
-
-    auto encoder_out_vec =
-        model_.ForwardEncoder(std::move(x), std::move(x_length));
-
-    // CIF search
-    auto &encoder_out = encoder_out_vec[0];
-    auto &encoder_out_len = encoder_out_vec[1];
-    auto &alpha = encoder_out_vec[2];
-
-    float *p_alpha = alpha.GetTensorMutableData<float>();
-
-    std::vector<int64_t> alpha_shape =
-        alpha.GetTensorTypeAndShapeInfo().GetShape();
+    return frames;
+  }
 
+  /** Run CIF search on the encoder output of one stream.
+   *
+   * @param s The stream. Its encoder out cache and alpha cache are updated.
+   * @param p_encoder_out Pointer to a 2-D array of shape
+   *                      (num_frames, dim).
+   * @param p_alpha Pointer to a 1-D array of shape (num_frames,). Its
+   *                left and right chunks are set to 0.
+   * @param acoustic_embedding On return, it contains a 2-D array of shape
+   *                           (num_tokens, dim). num_tokens may be 0.
+   */
+  void RunCif(OnlineStream *s, const float *p_encoder_out, float *p_alpha,
+              int32_t num_frames, int32_t dim,
+              std::vector<float> *acoustic_embedding) const {
     std::fill(p_alpha, p_alpha + left_chunk_size_, 0);
-    std::fill(p_alpha + alpha_shape[1] - right_chunk_size_,
-              p_alpha + alpha_shape[1], 0);
-
-    const float *p_encoder_out = encoder_out.GetTensorData<float>();
-
-    std::vector<int64_t> encoder_out_shape =
-        encoder_out.GetTensorTypeAndShapeInfo().GetShape();
+    std::fill(p_alpha + num_frames - right_chunk_size_, p_alpha + num_frames,
+              0);
 
     std::vector<float> &initial_hidden = s->GetParaformerEncoderOutCache();
     if (initial_hidden.empty()) {
-      initial_hidden.resize(encoder_out_shape[2]);
+      initial_hidden.resize(dim);
     }
 
     std::vector<float> &alpha_cache = s->GetParaformerAlphaCache();
@@ -283,105 +343,197 @@ class OnlineRecognizerParaformerImpl : public OnlineRecognizerImpl {
       alpha_cache.resize(1);
     }
 
-    std::vector<float> acoustic_embedding;
-    acoustic_embedding.reserve(encoder_out_shape[1] * encoder_out_shape[2]);
+    acoustic_embedding->clear();
+    acoustic_embedding->reserve(num_frames * dim);
 
     float threshold = 1.0;
 
     float integrate = alpha_cache[0];
 
-    for (int32_t i = 0; i != encoder_out_shape[1]; ++i) {
+    for (int32_t i = 0; i != num_frames; ++i) {
       float this_alpha = p_alpha[i];
       if (integrate + this_alpha < threshold) {
         integrate += this_alpha;
-        ScaleAddInPlace(p_encoder_out + i * encoder_out_shape[2],
-                        encoder_out_shape[2], this_alpha,
+        ScaleAddInPlace(p_encoder_out + i * dim, dim, this_alpha,
                         initial_hidden.data());
         continue;
       }
 
       // fire
-      ScaleAddInPlace(p_encoder_out + i * encoder_out_shape[2],
-                      encoder_out_shape[2], threshold - integrate,
+      ScaleAddInPlace(p_encoder_out + i * dim, dim, threshold - integrate,
                       initial_hidden.data());
-      acoustic_embedding.insert(acoustic_embedding.end(),
-                                initial_hidden.begin(), initial_hidden.end());
+      acoustic_embedding->insert(acoustic_embedding->end(),
+                                 initial_hidden.begin(), initial_hidden.end());
       integrate += this_alpha - threshold;
 
-      Scale(p_encoder_out + i * encoder_out_shape[2], encoder_out_shape[2],
-            integrate, initial_hidden.data());
+      Scale(p_encoder_out + i * dim, dim, integrate, initial_hidden.data());
     }
 
     alpha_cache[0] = integrate;
+  }
 
-    if (acoustic_embedding.empty()) {
-      return;
-    }
-
-    auto &states = s->GetStates();
-    if (states.empty()) {
-      states.reserve(model_.DecoderNumBlocks());
-
-      std::array<int64_t, 3> shape{1, model_.EncoderOutputSize(),
-                                   model_.DecoderKernelSize() - 1};
-
-      int32_t num_bytes = sizeof(float) * shape[0] * shape[1] * shape[2];
+  /** Run the decoder for a group of streams that fired the same number of
+   * tokens in the current chunk.
+   *
+   * @param ss All streams passed to DecodeStreams().
+   * @param group Indexes into ss of the streams to decode.
+   * @param num_tokens Number of tokens fired by each stream in group.
+   * @param num_processed_frames Number of processed frames of each stream
+   *                             before the current chunk.
+   * @param encoder_out Encoder output of all streams.
+   * @param encoder_out_len Encoder output lengths of all streams.
+   * @param acoustic_embeddings Acoustic embeddings of all streams.
+   */
+  void RunDecoder(OnlineStream **ss, const std::vector<int32_t> &group,
+                  int32_t num_tokens,
+                  const std::vector<int32_t> &num_processed_frames,
+                  Ort::Value *encoder_out, const Ort::Value &encoder_out_len,
+                  const std::vector<std::vector<float>> &acoustic_embeddings)
+      const {
+    int32_t batch_size = group.size();
+    int32_t dim = model_.EncoderOutputSize();
+
+    // No need to copy if all streams are in this group
+    int32_t num_streams =
+        encoder_out->GetTensorTypeAndShapeInfo().GetShape()[0];
+    Ort::Value this_encoder_out =
+        batch_size == num_streams
+            ? View(encoder_out)
+            : IndexSelectAxis0(model_.Allocator(), encoder_out, group);
+
+    // All streams have the same encoder output length since all chunks
+    // have the same number of frames
+    Ort::Value this_encoder_out_len =
+        GetEncoderOutLen(encoder_out_len, batch_size);
 
-      for (int32_t i = 0; i != model_.DecoderNumBlocks(); ++i) {
-        Ort::Value this_state = Ort::Value::CreateTensor<float>(
-            model_.Allocator(), shape.data(), shape.size());
+    std::vector<float> acoustic_embedding;
+    acoustic_embedding.reserve(batch_size * num_tokens * dim);
+    for (auto i : group) {
+      acoustic_embedding.insert(acoustic_embedding.end(),
+                                acoustic_embeddings[i].begin(),
+                                acoustic_embeddings[i].end());
+    }
 
-        memset(this_state.GetTensorMutableData<float>(), 0, num_bytes);
+    // Stack the decoder states of all streams in the group
+    std::vector<std::vector<const Ort::Value *>> states_list(
+        model_.DecoderNumBlocks());
+    for (auto i : group) {
+      auto &states = ss[i]->GetStates();
+      if (states.empty()) {
+        states = GetInitDecoderStates();
+      }
 
-        states.push_back(std::move(this_state));
+      for (int32_t k = 0; k != model_.DecoderNumBlocks(); ++k) {
+        states_list[k].push_back(&states[k]);
       }
     }
 
-    int32_t num_tokens = acoustic_embedding.size() / initial_hidden.size();
-    std::array<int64_t, 3> acoustic_embedding_shape{
-        1, num_tokens, static_cast<int32_t>(initial_hidden.size())};
+    std::vector<Ort::Value> states;
+    states.reserve(model_.DecoderNumBlocks());
+    for (const auto &v : states_list) {
+      states.push_back(Cat(model_.Allocator(), v, 0));
+    }
+
+    auto memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 3> acoustic_embedding_shape{batch_size, num_tokens,
+                                                    dim};
 
     Ort::Value acoustic_embedding_tensor = Ort::Value::CreateTensor(
         memory_info, acoustic_embedding.data(), acoustic_embedding.size(),
         acoustic_embedding_shape.data(), acoustic_embedding_shape.size());
 
-    std::array<int64_t, 1> acoustic_embedding_length_shape{1};
+    std::vector<int32_t> acoustic_embedding_length(batch_size, num_tokens);
+    std::array<int64_t, 1> acoustic_embedding_length_shape{batch_size};
     Ort::Value acoustic_embedding_length_tensor = Ort::Value::CreateTensor(
-        memory_info, &num_tokens, 1, acoustic_embedding_length_shape.data(),
+        memory_info, acoustic_embedding_length.data(), batch_size,
+        acoustic_embedding_length_shape.data(),
         acoustic_embedding_length_shape.size());
 
     auto decoder_out_vec = model_.ForwardDecoder(
-        std::move(encoder_out), std::move(encoder_out_len),
+        std::move(this_encoder_out), std::move(this_encoder_out_len),
         std::move(acoustic_embedding_tensor),
         std::move(acoustic_embedding_length_tensor), std::move(states));
 
-    states.reserve(model_.DecoderNumBlocks());
-    for (int32_t i = 2; i != decoder_out_vec.size(); ++i) {
+    // Split the new states of the group back to each stream
+    for (auto i : group) {
+      ss[i]->GetStates().clear();
+    }
+
+    for (int32_t k = 2; k != decoder_out_vec.size(); ++k) {
       // TODO(fangjun): When we change chunk_size_, we need to
-      // slice decoder_out_vec[i] accordingly.
-      states.push_back(std::move(decoder_out_vec[i]));
+      // slice decoder_out_vec[k] accordingly.
+      auto v = Unbind(model_.Allocator(), &decoder_out_vec[k], 0);
+      for (int32_t b = 0; b != batch_size; ++b) {
+        ss[group[b]]->GetStates().push_back(std::move(v[b]));
+      }
     }
 
+    // (batch_size, num_tokens)
     const auto &sample_ids = decoder_out_vec[1];
     const int64_t *p_sample_ids = sample_ids.GetTensorData<int64_t>();
 
-    bool non_blank_detected = false;
+    for (int32_t b = 0; b != batch_size; ++b) {
+      bool non_blank_detected = false;
 
-    auto &result = s->GetParaformerResult();
+      auto &result = ss[group[b]]->GetParaformerResult();
 
-    for (int32_t i = 0; i != num_tokens; ++i) {
-      int32_t t = p_sample_ids[i];
-      if (t == 0) {
-        continue;
+      for (int32_t i = 0; i != num_tokens; ++i) {
+        int32_t t = p_sample_ids[b * num_tokens + i];
+        if (t == 0) {
+          continue;
+        }
+
+        non_blank_detected = true;
+        result.tokens.push_back(t);
+      }
+
+      if (non_blank_detected) {
+        result.last_non_blank_frame_index = num_processed_frames[group[b]];
       }
+    }
+  }
+
+  std::vector<Ort::Value> GetInitDecoderStates() const {
+    std::vector<Ort::Value> states;
+    states.reserve(model_.DecoderNumBlocks());
+
+    std::array<int64_t, 3> shape{1, model_.EncoderOutputSize(),
+                                 model_.DecoderKernelSize() - 1};
 
-      non_blank_detected = true;
-      result.tokens.push_back(t);
+    int32_t num_bytes = sizeof(float) * shape[0] * shape[1] * shape[2];
+
+    for (int32_t i = 0; i != model_.DecoderNumBlocks(); ++i) {
+      Ort::Value this_state = Ort::Value::CreateTensor<float>(
+          model_.Allocator(), shape.data(), shape.size());
+
+      memset(this_state.GetTensorMutableData<float>(), 0, num_bytes);
+
+      states.push_back(std::move(this_state));
     }
 
-    if (non_blank_detected) {
-      result.last_non_blank_frame_index = num_processed_frames;
+    return states;
+  }
+
+  // Return a 1-D tensor of shape (n,) filled with the first entry of
+  // encoder_out_len, keeping its data type
+  Ort::Value GetEncoderOutLen(const Ort::Value &encoder_out_len,
+                              int32_t n) const {
+    std::array<int64_t, 1> shape{n};
+
+    auto type = encoder_out_len.GetTensorTypeAndShapeInfo().GetElementType();
+    if (type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+      Ort::Value ans = Ort::Value::CreateTensor<int64_t>(
+          model_.Allocator(), shape.data(), shape.size());
+      Fill<int64_t>(&ans, encoder_out_len.GetTensorData<int64_t>()[0]);
+      return ans;
     }
+
+    Ort::Value ans = Ort::Value::CreateTensor<int32_t>(
+        model_.Allocator(), shape.data(), shape.size());
+    Fill<int32_t>(&ans, encoder_out_len.GetTensorData<int32_t>()[0]);
+    return ans;
   }
 
   std::vector<float> ApplyLFR(const std::vector<float> &in) const {
@@ -0,0 +1,116 @@
+// sherpa-onnx/csrc/online-recognizer-stats-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(LatencyHistogram, Percentile) {
+  LatencyHistogram h;
+  EXPECT_EQ(h.Percentile(0.5), 0);
+
+  // 1, 2, ..., 100 milliseconds
+  for (int32_t i = 1; i <= 100; ++i) {
+    h.Add(i * 1e-3);
+  }
+
+  EXPECT_EQ(h.Count(), 100);
+  EXPECT_NEAR(h.Sum(), 5.05, 1e-6);
+  EXPECT_NEAR(h.Max(), 0.1, 1e-9);
+
+  // The relative error is at most 2^(1/4) - 1
+  for (double q : {0.5, 0.95, 0.99}) {
+    double expected = q * 100 * 1e-3;
+    double p = h.Percentile(q);
+    EXPECT_GE(p, expected * 0.999) << q;
+    EXPECT_LE(p, expected * 1.19) << q;
+  }
+
+  EXPECT_NEAR(h.Percentile(1), 0.1, 1e-9);
+
+  h.Reset();
+  EXPECT_EQ(h.Count(), 0);
+  EXPECT_EQ(h.Percentile(0.99), 0);
+}
+
+TEST(LatencyHistogram, Concurrent) {
+  LatencyHistogram h;
+
+  std::vector<std::thread> threads;
+  for (int32_t t = 0; t != 4; ++t) {
+    threads.emplace_back([&h]() {
+      for (int32_t i = 0; i != 1000; ++i) {
+        h.Add(1e-3);
+      }
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(h.Count(), 4000);
+  EXPECT_NEAR(h.Sum(), 4, 1e-6);
+}
+
+TEST(OnlineRecognizerStatsCollector, GetStats) {
+  OnlineRecognizerStatsCollector stats(10);
+  EXPECT_FALSE(stats.IsEnabled());
+
+  {
+    // It does nothing since stats is disabled
+    ScopedStageTimer timer(&stats, OnlineRecognizerStage::kEncoder);
+  }
+
+  stats.Enable(true);
+  {
+    ScopedStageTimer timer(&stats, OnlineRecognizerStage::kEncoder);
+  }
+  { ScopedStageTimer timer(nullptr, OnlineRecognizerStage::kEncoder); }
+
+  stats.AddStage(OnlineRecognizerStage::kSearch, 0.02);
+
+  // 2 batches of 16 frames per stream, i.e., 0.16 s per stream
+  stats.AddBatch(2, 32, 0.04);
+  stats.AddBatch(4, 64, 0.08);
+  stats.AddQueueWait(0.005);
+
+  auto s = stats.GetStats();
+  EXPECT_EQ(s.num_batches, 2);
+  EXPECT_EQ(s.max_batch_size, 4);
+  EXPECT_NEAR(s.mean_batch_size, 3, 1e-6);
+  EXPECT_NEAR(s.audio_seconds, 0.96, 1e-6);
+  EXPECT_NEAR(s.rtf, 0.12 / 0.96, 1e-5);
+  EXPECT_EQ(s.queue_wait.count, 1);
+
+  ASSERT_EQ(s.stages.size(),
+            static_cast<size_t>(OnlineRecognizerStage::kNumStages));
+
+  const auto &encoder =
+      s.stages[static_cast<int32_t>(OnlineRecognizerStage::kEncoder)];
+  EXPECT_EQ(encoder.name, "encoder");
+  EXPECT_EQ(encoder.count, 1);
+
+  const auto &search =
+      s.stages[static_cast<int32_t>(OnlineRecognizerStage::kSearch)];
+  EXPECT_EQ(search.count, 1);
+  EXPECT_NEAR(search.total_seconds, 0.02, 1e-6);
+  EXPECT_NEAR(search.rtf, 0.02 / 0.96, 1e-5);
+
+  EXPECT_NE(s.ToString().find("\"name\": \"search\""), std::string::npos);
+
+  stats.Reset();
+  s = stats.GetStats();
+  EXPECT_EQ(s.num_batches, 0);
+  EXPECT_EQ(s.audio_seconds, 0);
+  EXPECT_EQ(s.stages[0].count, 0);
+}
+
+}  // namespace sherpa_onnx
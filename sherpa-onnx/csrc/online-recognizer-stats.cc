@@ -0,0 +1,244 @@
+// sherpa-onnx/csrc/online-recognizer-stats.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace sherpa_onnx {
+
+// Number of buckets per power of 2
+static constexpr int32_t kBucketsPerOctave = 4;
+
+const char *ToString(OnlineRecognizerStage stage) {
+  switch (stage) {
+    case OnlineRecognizerStage::kFeatures:
+      return "features";
+    case OnlineRecognizerStage::kStackStates:
+      return "stack_states";
+    case OnlineRecognizerStage::kEncoder:
+      return "encoder";
+    case OnlineRecognizerStage::kSearch:
+      return "search";
+    case OnlineRecognizerStage::kLM:
+      return "lm";
+    case OnlineRecognizerStage::kUnstackStates:
+      return "unstack_states";
+    case OnlineRecognizerStage::kEndpoint:
+      return "endpoint";
+    default:
+      return "unknown";
+  }
+}
+
+// Bucket 0 is for values less than 1 microsecond. Bucket i > 0 is for
+// values in [2^((i-1)/4), 2^(i/4)) microseconds.
+static int32_t BucketIndex(int64_t ns, int32_t num_buckets) {
+  if (ns < 1000) {
+    return 0;
+  }
+
+  int32_t i =
+      static_cast<int32_t>(std::floor(kBucketsPerOctave * std::log2(ns / 1e3)));
+  return std::min(i + 1, num_buckets - 1);
+}
+
+static double BucketUpperBound(int32_t i) {
+  return std::exp2(static_cast<double>(i) / kBucketsPerOctave) * 1e-6;
+}
+
+static void AtomicMax(std::atomic<int64_t> *a, int64_t v) {
+  int64_t cur = a->load(std::memory_order_relaxed);
+  while (cur < v && !a->compare_exchange_weak(cur, v)) {
+  }
+}
+
+void LatencyHistogram::Add(double seconds) {
+  int64_t ns = static_cast<int64_t>(std::max(seconds, 0.0) * 1e9);
+
+  buckets_[BucketIndex(ns, kNumBuckets)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  AtomicMax(&max_ns_, ns);
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &b : buckets_) {
+    b.store(0);
+  }
+  count_.store(0);
+  sum_ns_.store(0);
+  max_ns_.store(0);
+}
+
+double LatencyHistogram::Sum() const {
+  return sum_ns_.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double LatencyHistogram::Max() const {
+  return max_ns_.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double LatencyHistogram::Percentile(double q) const {
+  // Buckets may be updated while we are reading them, so we use the sum
+  // of the buckets instead of count_
+  std::array<int64_t, kNumBuckets> counts;
+  int64_t total = 0;
+  for (int32_t i = 0; i != kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  if (total == 0) {
+    return 0;
+  }
+
+  q = std::min(std::max(q, 0.0), 1.0);
+  int64_t rank = std::max<int64_t>(static_cast<int64_t>(std::ceil(q * total)),
+                                   1);
+
+  int64_t acc = 0;
+  for (int32_t i = 0; i != kNumBuckets; ++i) {
+    acc += counts[i];
+    if (acc >= rank) {
+      return std::min(BucketUpperBound(i), Max());
+    }
+  }
+
+  return Max();
+}
+
+static OnlineRecognizerStageStats GetStageStats(const std::string &name,
+                                                const LatencyHistogram &h,
+                                                float audio_seconds) {
+  OnlineRecognizerStageStats ans;
+  ans.name = name;
+  ans.count = h.Count();
+  ans.total_seconds = h.Sum();
+  if (ans.count > 0) {
+    ans.mean_ms = ans.total_seconds * 1000 / ans.count;
+  }
+  ans.p50_ms = h.Percentile(0.50) * 1000;
+  ans.p95_ms = h.Percentile(0.95) * 1000;
+  ans.p99_ms = h.Percentile(0.99) * 1000;
+  ans.max_ms = h.Max() * 1000;
+  if (audio_seconds > 0) {
+    ans.rtf = ans.total_seconds / audio_seconds;
+  }
+
+  return ans;
+}
+
+std::string OnlineRecognizerStageStats::ToString() const {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+
+  os << "{";
+  os << "\"name\": \"" << name << "\", ";
+  os << "\"count\": " << count << ", ";
+  os << "\"total_seconds\": " << total_seconds << ", ";
+  os << "\"mean_ms\": " << mean_ms << ", ";
+  os << "\"p50_ms\": " << p50_ms << ", ";
+  os << "\"p95_ms\": " << p95_ms << ", ";
+  os << "\"p99_ms\": " << p99_ms << ", ";
+  os << "\"max_ms\": " << max_ms << ", ";
+  os << "\"rtf\": " << std::setprecision(5) << rtf;
+  os << "}";
+
+  return os.str();
+}
+
+std::string OnlineRecognizerStats::ToString() const {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+
+  os << "{";
+  os << "\"num_batches\": " << num_batches << ", ";
+  os << "\"mean_batch_size\": " << mean_batch_size << ", ";
+  os << "\"max_batch_size\": " << max_batch_size << ", ";
+  os << "\"audio_seconds\": " << audio_seconds << ", ";
+  os << "\"rtf\": " << std::setprecision(5) << rtf << ", ";
+  os << "\"decode\": " << decode.ToString() << ", ";
+  os << "\"queue_wait\": " << queue_wait.ToString() << ", ";
+
+  os << "\"stages\": [";
+  std::string sep;
+  for (const auto &s : stages) {
+    os << sep << s.ToString();
+    sep = ", ";
+  }
+  os << "]";
+
+  os << "}";
+
+  return os.str();
+}
+
+void OnlineRecognizerStatsCollector::AddStage(OnlineRecognizerStage stage,
+                                              double seconds) {
+  stages_[static_cast<int32_t>(stage)].Add(seconds);
+}
+
+void OnlineRecognizerStatsCollector::AddBatch(int32_t batch_size,
+                                              int64_t num_frames,
+                                              double seconds) {
+  decode_.Add(seconds);
+  num_streams_.fetch_add(batch_size, std::memory_order_relaxed);
+  num_frames_.fetch_add(num_frames, std::memory_order_relaxed);
+
+  int32_t cur = max_batch_size_.load(std::memory_order_relaxed);
+  while (cur < batch_size &&
+         !max_batch_size_.compare_exchange_weak(cur, batch_size)) {
+  }
+}
+
+void OnlineRecognizerStatsCollector::AddQueueWait(double seconds) {
+  queue_wait_.Add(seconds);
+}
+
+OnlineRecognizerStats OnlineRecognizerStatsCollector::GetStats() const {
+  OnlineRecognizerStats ans;
+
+  ans.num_batches = decode_.Count();
+  if (ans.num_batches > 0) {
+    ans.mean_batch_size =
+        static_cast<float>(num_streams_.load()) / ans.num_batches;
+  }
+  ans.max_batch_size = max_batch_size_.load();
+  ans.audio_seconds = num_frames_.load() * frame_shift_seconds_;
+  if (ans.audio_seconds > 0) {
+    ans.rtf = decode_.Sum() / ans.audio_seconds;
+  }
+
+  ans.decode = GetStageStats("decode", decode_, ans.audio_seconds);
+  ans.queue_wait = GetStageStats("queue_wait", queue_wait_, 0);
+
+  ans.stages.reserve(stages_.size());
+  for (int32_t i = 0; i != static_cast<int32_t>(stages_.size()); ++i) {
+    ans.stages.push_back(
+        GetStageStats(sherpa_onnx::ToString(
+                          static_cast<OnlineRecognizerStage>(i)),
+                      stages_[i], ans.audio_seconds));
+  }
+
+  return ans;
+}
+
+void OnlineRecognizerStatsCollector::Reset() {
+  for (auto &s : stages_) {
+    s.Reset();
+  }
+  decode_.Reset();
+  queue_wait_.Reset();
+  num_streams_.store(0);
+  max_batch_size_.store(0);
+  num_frames_.store(0);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,195 @@
+// sherpa-onnx/csrc/online-recognizer-stats.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_STATS_H_
+#define SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+// Stages of OnlineRecognizer::DecodeStreams() and
+// OnlineRecognizer::IsEndpoint()
+enum class OnlineRecognizerStage : int32_t {
+  // Copy the features of all streams into the batched encoder input
+  kFeatures = 0,
+  kStackStates,
+  kEncoder,
+  // Decoder and joiner search, including the LM
+  kSearch,
+  // LM shallow fusion or rescoring. It is a part of kSearch.
+  kLM,
+  kUnstackStates,
+  kEndpoint,
+  kNumStages,
+};
+
+const char *ToString(OnlineRecognizerStage stage);
+
+/** A latency histogram with log-spaced buckets.
+ *
+ * Each bucket is 2^(1/4) times as wide as the previous one, so percentiles
+ * have a relative error of at most 19%. All methods are thread-safe and
+ * Add() is lock-free.
+ */
+class LatencyHistogram {
+ public:
+  void Add(double seconds);
+
+  void Reset();
+
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+  // Sum of all added values in seconds
+  double Sum() const;
+
+  // Max of all added values in seconds
+  double Max() const;
+
+  /** Return the q-th quantile in seconds, e.g., q = 0.95 for p95.
+   *
+   * It is the upper bound of the bucket containing the quantile, capped
+   * at Max(). Return 0 if the histogram is empty.
+   */
+  double Percentile(double q) const;
+
+ private:
+  static constexpr int32_t kNumBuckets = 128;
+
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+  std::atomic<int64_t> count_{0};
+  std::atomic<int64_t> sum_ns_{0};
+  std::atomic<int64_t> max_ns_{0};
+};
+
+struct OnlineRecognizerStageStats {
+  std::string name;
+  int64_t count = 0;
+
+  float total_seconds = 0;
+  float mean_ms = 0;
+  float p50_ms = 0;
+  float p95_ms = 0;
+  float p99_ms = 0;
+  float max_ms = 0;
+
+  // total_seconds divided by the duration of the decoded audio
+  float rtf = 0;
+
+  std::string ToString() const;
+};
+
+/** A snapshot of the statistics of an OnlineRecognizer.
+ *
+ * See OnlineRecognizer::EnableStats()
+ */
+struct OnlineRecognizerStats {
+  // One entry per stage in the order of OnlineRecognizerStage
+  std::vector<OnlineRecognizerStageStats> stages;
+
+  // Latency of the whole OnlineRecognizer::DecodeStreams() call
+  OnlineRecognizerStageStats decode;
+
+  // Time from the first OnlineRecognizer::IsReady() that returns true for
+  // a stream to the OnlineRecognizer::DecodeStreams() that decodes it
+  OnlineRecognizerStageStats queue_wait;
+
+  // Number of DecodeStreams() calls
+  int64_t num_batches = 0;
+  float mean_batch_size = 0;
+  int32_t max_batch_size = 0;
+
+  // Duration of the decoded audio summed over all streams
+  float audio_seconds = 0;
+
+  // Time spent in DecodeStreams() divided by audio_seconds
+  float rtf = 0;
+
+  // Return a single-line JSON object
+  std::string ToString() const;
+};
+
+/** It collects the statistics of an OnlineRecognizer.
+ *
+ * It is disabled by default. When disabled, the cost of each measurement
+ * point is a relaxed atomic load. All methods are thread-safe.
+ */
+class OnlineRecognizerStatsCollector {
+ public:
+  explicit OnlineRecognizerStatsCollector(float frame_shift_ms = 10)
+      : frame_shift_seconds_(frame_shift_ms / 1000) {}
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  void Enable(bool enable) { enabled_.store(enable); }
+
+  void AddStage(OnlineRecognizerStage stage, double seconds);
+
+  /**
+   * @param batch_size Number of streams decoded.
+   * @param num_frames Number of feature frames consumed, summed over all
+   *                   streams.
+   * @param seconds Time spent decoding the batch.
+   */
+  void AddBatch(int32_t batch_size, int64_t num_frames, double seconds);
+
+  void AddQueueWait(double seconds);
+
+  OnlineRecognizerStats GetStats() const;
+
+  void Reset();
+
+ private:
+  std::atomic<bool> enabled_{false};
+  float frame_shift_seconds_;
+
+  std::array<LatencyHistogram,
+             static_cast<int32_t>(OnlineRecognizerStage::kNumStages)>
+      stages_;
+  LatencyHistogram decode_;
+  LatencyHistogram queue_wait_;
+
+  std::atomic<int64_t> num_streams_{0};
+  std::atomic<int32_t> max_batch_size_{0};
+  std::atomic<int64_t> num_frames_{0};
+};
+
+/** Add the time between its construction and destruction to the given
+ * stage. It does nothing if stats is nullptr or disabled.
+ */
+class ScopedStageTimer {
+ public:
+  ScopedStageTimer(OnlineRecognizerStatsCollector *stats,
+                   OnlineRecognizerStage stage)
+      : stats_((stats && stats->IsEnabled()) ? stats : nullptr),
+        stage_(stage) {
+    if (stats_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedStageTimer() {
+    if (stats_) {
+      auto end = std::chrono::steady_clock::now();
+      stats_->AddStage(stage_,
+                       std::chrono::duration<double>(end - start_).count());
+    }
+  }
+
+  ScopedStageTimer(const ScopedStageTimer &) = delete;
+  ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+ private:
+  OnlineRecognizerStatsCollector *stats_;
+  OnlineRecognizerStage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_RECOGNIZER_STATS_H_
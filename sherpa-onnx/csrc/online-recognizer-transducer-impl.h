@@ -8,17 +8,20 @@
 #include <algorithm>
 #include <ios>
 #include <memory>
-#include <regex>  // NOLINT
+#include <mutex>  // NOLINT
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "sherpa-onnx/csrc/file-utils.h"
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-batched-states.h"
 #include "sherpa-onnx/csrc/online-lm.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-greedy-search-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
@@ -102,17 +105,18 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
     model_->SetFeatureDim(config.feat_config.feature_dim);
 
+    if (config.decoder_out_cache_size > 0) {
+      decoder_out_cache_ = std::make_unique<OnlineTransducerDecoderOutCache>(
+          config.decoder_out_cache_size);
+    }
+
     if (config.decoding_method == "modified_beam_search") {
       if (!config_.model_config.bpe_vocab.empty()) {
         bpe_encoder_ = std::make_unique<ssentencepiece::Ssentencepiece>(
             config_.model_config.bpe_vocab);
       }
 
-      if (!config_.hotwords_buf.empty()) {
-        InitHotwordsFromBufStr();
-      } else if (!config_.hotwords_file.empty()) {
-        InitHotwords();
-      }
+      InitHotwords(sym_, bpe_encoder_.get());
 
       if (!config_.lm_config.model.empty()) {
         lm_ = OnlineLM::Create(config.lm_config);
@@ -121,12 +125,14 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
       decoder_ = std::make_unique<OnlineTransducerModifiedBeamSearchDecoder>(
           model_.get(), lm_.get(), config_.max_active_paths,
           config_.lm_config.scale, config_.lm_config.shallow_fusion, unk_id_,
-          config_.blank_penalty, config_.temperature_scale);
+          config_.blank_penalty, config_.temperature_scale,
+          config_.model_config.transducer.use_io_binding,
+          decoder_out_cache_.get(), GetStatsCollector());
 
     } else if (config.decoding_method == "greedy_search") {
       decoder_ = std::make_unique<OnlineTransducerGreedySearchDecoder>(
           model_.get(), unk_id_, config_.blank_penalty,
-          config_.temperature_scale);
+          config_.temperature_scale, decoder_out_cache_.get());
 
     } else {
       SHERPA_ONNX_LOGE("Unsupported decoding method: %s",
@@ -149,13 +155,15 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
     model_->SetFeatureDim(config.feat_config.feature_dim);
 
+    if (config.decoder_out_cache_size > 0) {
+      decoder_out_cache_ = std::make_unique<OnlineTransducerDecoderOutCache>(
+          config.decoder_out_cache_size);
+    }
+
     if (config.decoding_method == "modified_beam_search") {
-#if 0
-      // TODO(fangjun): Implement it
       if (!config_.lm_config.model.empty()) {
         lm_ = OnlineLM::Create(mgr, config.lm_config);
       }
-#endif
 
       if (!config_.model_config.bpe_vocab.empty()) {
         auto buf = ReadFile(mgr, config_.model_config.bpe_vocab);
@@ -163,19 +171,19 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         bpe_encoder_ = std::make_unique<ssentencepiece::Ssentencepiece>(iss);
       }
 
-      if (!config_.hotwords_file.empty()) {
-        InitHotwords(mgr);
-      }
+      InitHotwords(mgr, sym_, bpe_encoder_.get());
 
       decoder_ = std::make_unique<OnlineTransducerModifiedBeamSearchDecoder>(
           model_.get(), lm_.get(), config_.max_active_paths,
           config_.lm_config.scale, config_.lm_config.shallow_fusion, unk_id_,
-          config_.blank_penalty, config_.temperature_scale);
+          config_.blank_penalty, config_.temperature_scale,
+          config_.model_config.transducer.use_io_binding,
+          decoder_out_cache_.get(), GetStatsCollector());
 
     } else if (config.decoding_method == "greedy_search") {
       decoder_ = std::make_unique<OnlineTransducerGreedySearchDecoder>(
           model_.get(), unk_id_, config_.blank_penalty,
-          config_.temperature_scale);
+          config_.temperature_scale, decoder_out_cache_.get());
 
     } else {
       SHERPA_ONNX_LOGE("Unsupported decoding method: %s",
@@ -184,47 +192,28 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     }
   }
 
+  ~OnlineRecognizerTransducerImpl() override {
+    if (decoder_out_cache_ && config_.model_config.debug) {
+      SHERPA_ONNX_LOGE(
+          "decoder_out cache: size %d, hits %lld, misses %lld, hit rate %.3f",
+          decoder_out_cache_->Size(),
+          static_cast<long long>(decoder_out_cache_->NumHits()),    // NOLINT
+          static_cast<long long>(decoder_out_cache_->NumMisses()),  // NOLINT
+          decoder_out_cache_->HitRate());
+    }
+  }
+
   std::unique_ptr<OnlineStream> CreateStream() const override {
     auto stream =
-        std::make_unique<OnlineStream>(config_.feat_config, hotwords_graph_);
+        std::make_unique<OnlineStream>(config_.feat_config, GetHotwordsGraph());
     InitOnlineStream(stream.get());
     return stream;
   }
 
   std::unique_ptr<OnlineStream> CreateStream(
       const std::string &hotwords) const override {
-    auto hws = std::regex_replace(hotwords, std::regex("/"), "\n");
-    std::istringstream is(hws);
-    std::vector<std::vector<int32_t>> current;
-    std::vector<float> current_scores;
-    if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &current, &current_scores)) {
-      SHERPA_ONNX_LOGE("Encode hotwords failed, skipping, hotwords are : %s",
-                       hotwords.c_str());
-    }
-
-    int32_t num_default_hws = hotwords_.size();
-    int32_t num_hws = current.size();
-
-    current.insert(current.end(), hotwords_.begin(), hotwords_.end());
-
-    if (!current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else if (!current_scores.empty() && boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_default_hws,
-                            config_.hotwords_score);
-    } else if (current_scores.empty() && !boost_scores_.empty()) {
-      current_scores.insert(current_scores.end(), num_hws,
-                            config_.hotwords_score);
-      current_scores.insert(current_scores.end(), boost_scores_.begin(),
-                            boost_scores_.end());
-    } else {
-      // Do nothing.
-    }
-
-    auto context_graph = std::make_shared<ContextGraph>(
-        current, config_.hotwords_score, current_scores);
+    auto context_graph =
+        CreateHotwordsGraph(hotwords, sym_, bpe_encoder_.get());
     auto stream =
         std::make_unique<OnlineStream>(config_.feat_config, context_graph);
     InitOnlineStream(stream.get());
@@ -278,29 +267,31 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
     int32_t feature_dim = ss[0]->FeatureDim();
 
     std::vector<OnlineTransducerDecoderResult> results(n);
-    std::vector<float> features_vec(n * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> states_vec(n);
+    // Frames of all streams are written directly into this buffer, which
+    // is reused across calls
+    auto features_buf = features_pool_.Acquire(n * chunk_size * feature_dim);
     std::vector<int64_t> all_processed_frames(n);
     bool has_context_graph = false;
 
-    for (int32_t i = 0; i != n; ++i) {
-      if (!has_context_graph && ss[i]->GetContextGraph()) {
-        has_context_graph = true;
-      }
+    auto stats = GetStatsCollector();
 
-      const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kFeatures);
+      for (int32_t i = 0; i != n; ++i) {
+        if (!has_context_graph && ss[i]->GetContextGraph()) {
+          has_context_graph = true;
+        }
 
-      // Question: should num_processed_frames include chunk_shift?
-      ss[i]->GetNumProcessedFrames() += chunk_shift;
+        const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
+        ss[i]->GetFrames(num_processed_frames, chunk_size,
+                         features_buf.Data() + i * chunk_size * feature_dim);
 
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
+        // Question: should num_processed_frames include chunk_shift?
+        ss[i]->GetNumProcessedFrames() += chunk_shift;
 
-      results[i] = std::move(ss[i]->GetResult());
-      states_vec[i] = std::move(ss[i]->GetStates());
-      all_processed_frames[i] = num_processed_frames;
+        results[i] = std::move(ss[i]->GetResult());
+        all_processed_frames[i] = num_processed_frames;
+      }
     }
 
     auto memory_info =
@@ -308,8 +299,8 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
     std::array<int64_t, 3> x_shape{n, chunk_size, feature_dim};
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                            features_vec.size(), x_shape.data(),
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_buf.Data(),
+                                            features_buf.Size(), x_shape.data(),
                                             x_shape.size());
 
     std::array<int64_t, 1> processed_frames_shape{
@@ -319,23 +310,58 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
         memory_info, all_processed_frames.data(), all_processed_frames.size(),
         processed_frames_shape.data(), processed_frames_shape.size());
 
-    auto states = model_->StackStates(states_vec);
+    std::vector<Ort::Value> states;
+    {
+      // It includes unstacking the states of streams that were decoded in
+      // a different batch last time
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kStackStates);
+      if (HasSameBatchedStates(ss, n)) {
+        // The batch is the same as the previous one, so we can skip
+        // unstacking and stacking the states
+        states = ss[0]->GetBatchedStates()->TakeAll();
+      } else if (!GetStatesBatchAxes().empty()) {
+        // Copy only the rows of the streams in this batch
+        states =
+            GatherStates(model_->Allocator(), ss, n, GetStatesBatchAxes());
+      }
 
-    auto pair = model_->RunEncoder(std::move(x), std::move(states),
-                                   std::move(processed_frames));
+      if (states.empty()) {
+        std::vector<std::vector<Ort::Value>> states_vec(n);
+        for (int32_t i = 0; i != n; ++i) {
+          states_vec[i] = std::move(ss[i]->GetStates());
+        }
+        states = model_->StackStates(states_vec);
+      }
+    }
 
-    if (has_context_graph) {
-      decoder_->Decode(std::move(pair.first), ss, &results);
-    } else {
-      decoder_->Decode(std::move(pair.first), &results);
+    std::pair<Ort::Value, std::vector<Ort::Value>> pair(
+        Ort::Value{nullptr}, std::vector<Ort::Value>{});
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kEncoder);
+      pair = model_->RunEncoder(std::move(x), std::move(states),
+                                std::move(processed_frames));
+    }
+
+    {
+      ScopedStageTimer timer(stats, OnlineRecognizerStage::kSearch);
+      if (has_context_graph) {
+        decoder_->Decode(std::move(pair.first), ss, &results);
+      } else {
+        decoder_->Decode(std::move(pair.first), &results);
+      }
     }
 
-    std::vector<std::vector<Ort::Value>> next_states =
-        model_->UnStackStates(pair.second);
+    // The next states are unstacked lazily. See OnlineBatchedStates
+    auto next_states = std::make_shared<OnlineBatchedStates>(
+        std::move(pair.second), n, GetStatesBatchAxes(), model_->Allocator(),
+        [model = model_.get(), stats](std::vector<Ort::Value> states) {
+          ScopedStageTimer timer(stats, OnlineRecognizerStage::kUnstackStates);
+          return model->UnStackStates(states);
+        });
 
     for (int32_t i = 0; i != n; ++i) {
       ss[i]->SetResult(results[i]);
-      ss[i]->SetStates(std::move(next_states[i]));
+      ss[i]->SetBatchedStates(next_states, i);
     }
   }
 
@@ -421,62 +447,19 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
   }
 
  private:
-  void InitHotwords() {
-    // each line in hotwords_file contains space-separated words
-
-    std::ifstream is(config_.hotwords_file);
-    if (!is) {
-      SHERPA_ONNX_LOGE("Open hotwords file failed: %s",
-                       config_.hotwords_file.c_str());
-      exit(-1);
-    }
-
-    if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
-      SHERPA_ONNX_LOGE(
-          "Failed to encode some hotwords, skip them already, see logs above "
-          "for details.");
-    }
-    hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
-  }
-
-  template <typename Manager>
-  void InitHotwords(Manager *mgr) {
-    // each line in hotwords_file contains space-separated words
-
-    auto buf = ReadFile(mgr, config_.hotwords_file);
-
-    std::istringstream is(std::string(buf.begin(), buf.end()));
-
-    if (!is) {
-      SHERPA_ONNX_LOGE("Open hotwords file failed: %s",
-                       config_.hotwords_file.c_str());
-      exit(-1);
-    }
-
-    if (!EncodeHotwords(is, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
-      SHERPA_ONNX_LOGE(
-          "Failed to encode some hotwords, skip them already, see logs above "
-          "for details.");
-    }
-    hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
-  }
-
-  void InitHotwordsFromBufStr() {
-    // each line in hotwords_file contains space-separated words
-
-    std::istringstream iss(config_.hotwords_buf);
-    if (!EncodeHotwords(iss, config_.model_config.modeling_unit, sym_,
-                        bpe_encoder_.get(), &hotwords_, &boost_scores_)) {
-      SHERPA_ONNX_LOGE(
-          "Failed to encode some hotwords, skip them already, see logs above "
-          "for details.");
-    }
-    hotwords_graph_ = std::make_shared<ContextGraph>(
-        hotwords_, config_.hotwords_score, boost_scores_);
+  // Return the batch axis of each encoder state. It is empty if the
+  // states cannot be gathered by row. See FindStatesBatchAxes()
+  const std::vector<int32_t> &GetStatesBatchAxes() const {
+    std::call_once(states_batch_axes_once_, [this]() {
+      std::vector<std::vector<Ort::Value>> states_vec(2);
+      states_vec[0] = model_->GetEncoderInitStates();
+      states_vec[1] = model_->GetEncoderInitStates();
+      auto stacked = model_->StackStates(states_vec);
+      auto single = model_->GetEncoderInitStates();
+      states_batch_axes_ = FindStatesBatchAxes(single, stacked);
+    });
+
+    return states_batch_axes_;
   }
 
   void InitOnlineStream(OnlineStream *stream) const {
@@ -496,16 +479,22 @@ class OnlineRecognizerTransducerImpl : public OnlineRecognizerImpl {
 
  private:
   OnlineRecognizerConfig config_;
-  std::vector<std::vector<int32_t>> hotwords_;
-  std::vector<float> boost_scores_;
-  ContextGraphPtr hotwords_graph_;
   std::unique_ptr<ssentencepiece::Ssentencepiece> bpe_encoder_;
   std::unique_ptr<OnlineTransducerModel> model_;
   std::unique_ptr<OnlineLM> lm_;
+  // Shared by all streams. It must outlive decoder_
+  std::unique_ptr<OnlineTransducerDecoderOutCache> decoder_out_cache_;
   std::unique_ptr<OnlineTransducerDecoder> decoder_;
   SymbolTable sym_;
   Endpoint endpoint_;
   int32_t unk_id_ = -1;
+
+  // For the batched features input of the encoder
+  mutable FloatBufferPool features_pool_;
+
+  // Computed on first use by GetStatesBatchAxes()
+  mutable std::once_flag states_batch_axes_once_;
+  mutable std::vector<int32_t> states_batch_axes_;
 };
 
 }  // namespace sherpa_onnx
@@ -10,13 +10,16 @@
 #include <fstream>
 #include <ios>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <regex>  // NOLINT
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/float-buffer-pool.h"
 #include "sherpa-onnx/csrc/macros.h"
+#include "sherpa-onnx/csrc/online-batched-states.h"
 #include "sherpa-onnx/csrc/online-recognizer-impl.h"
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-transducer-greedy-search-nemo-decoder.h"
@@ -148,21 +151,17 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
 
     int32_t feature_dim = ss[0]->FeatureDim();
 
-    std::vector<float> features_vec(n * chunk_size * feature_dim);
-    std::vector<std::vector<Ort::Value>> encoder_states(n);
+    // Frames of all streams are written directly into this buffer, which
+    // is reused across calls
+    auto features_buf = features_pool_.Acquire(n * chunk_size * feature_dim);
 
     for (int32_t i = 0; i != n; ++i) {
       const auto num_processed_frames = ss[i]->GetNumProcessedFrames();
-      std::vector<float> features =
-          ss[i]->GetFrames(num_processed_frames, chunk_size);
+      ss[i]->GetFrames(num_processed_frames, chunk_size,
+                       features_buf.Data() + i * chunk_size * feature_dim);
 
       // Question: should num_processed_frames include chunk_shift?
       ss[i]->GetNumProcessedFrames() += chunk_shift;
-
-      std::copy(features.begin(), features.end(),
-                features_vec.data() + i * chunk_size * feature_dim);
-
-      encoder_states[i] = std::move(ss[i]->GetStates());
     }
 
     auto memory_info =
@@ -170,11 +169,28 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
 
     std::array<int64_t, 3> x_shape{n, chunk_size, feature_dim};
 
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_vec.data(),
-                                            features_vec.size(), x_shape.data(),
+    Ort::Value x = Ort::Value::CreateTensor(memory_info, features_buf.Data(),
+                                            features_buf.Size(), x_shape.data(),
                                             x_shape.size());
 
-    auto states = model_->StackStates(std::move(encoder_states));
+    std::vector<Ort::Value> states;
+    if (HasSameBatchedStates(ss, n)) {
+      // The batch is the same as the previous one, so we can skip
+      // unstacking and stacking the states
+      states = ss[0]->GetBatchedStates()->TakeAll();
+    } else if (!GetStatesBatchAxes().empty()) {
+      // Copy only the rows of the streams in this batch
+      states = GatherStates(model_->Allocator(), ss, n, GetStatesBatchAxes());
+    }
+
+    if (states.empty()) {
+      std::vector<std::vector<Ort::Value>> encoder_states(n);
+      for (int32_t i = 0; i != n; ++i) {
+        encoder_states[i] = std::move(ss[i]->GetStates());
+      }
+      states = model_->StackStates(std::move(encoder_states));
+    }
+
     int32_t num_states = states.size();  // num_states = 3
     auto t = model_->RunEncoder(std::move(x), std::move(states));
     // t[0] encoder_out, float tensor, (batch_size, dim, T)
@@ -187,9 +203,15 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
       out_states.push_back(std::move(t[k]));
     }
 
-    auto unstacked_states = model_->UnStackStates(std::move(out_states));
+    // The next states are unstacked lazily. See OnlineBatchedStates
+    auto next_states = std::make_shared<OnlineBatchedStates>(
+        std::move(out_states), n, GetStatesBatchAxes(), model_->Allocator(),
+        [model = model_.get()](std::vector<Ort::Value> states) {
+          return model->UnStackStates(std::move(states));
+        });
+
     for (int32_t i = 0; i != n; ++i) {
-      ss[i]->SetStates(std::move(unstacked_states[i]));
+      ss[i]->SetBatchedStates(next_states, i);
     }
 
     Ort::Value encoder_out = Transpose12(model_->Allocator(), &t[0]);
@@ -206,6 +228,21 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
   }
 
  private:
+  // Return the batch axis of each encoder state. It is empty if the
+  // states cannot be gathered by row. See FindStatesBatchAxes()
+  const std::vector<int32_t> &GetStatesBatchAxes() const {
+    std::call_once(states_batch_axes_once_, [this]() {
+      std::vector<std::vector<Ort::Value>> states_vec(2);
+      states_vec[0] = model_->GetEncoderInitStates();
+      states_vec[1] = model_->GetEncoderInitStates();
+      auto stacked = model_->StackStates(std::move(states_vec));
+      auto single = model_->GetEncoderInitStates();
+      states_batch_axes_ = FindStatesBatchAxes(single, stacked);
+    });
+
+    return states_batch_axes_;
+  }
+
   void PostInit() {
     config_.feat_config.nemo_normalize_type =
         model_->FeatureNormalizationMethod();
@@ -245,6 +282,13 @@ class OnlineRecognizerTransducerNeMoImpl : public OnlineRecognizerImpl {
   std::unique_ptr<OnlineTransducerNeMoModel> model_;
   std::unique_ptr<OnlineTransducerGreedySearchNeMoDecoder> decoder_;
   Endpoint endpoint_;
+
+  // For the batched features input of the encoder
+  mutable FloatBufferPool features_pool_;
+
+  // Computed on first use by GetStatesBatchAxes()
+  mutable std::once_flag states_batch_axes_once_;
+  mutable std::vector<int32_t> states_batch_axes_;
 };
 
 }  // namespace sherpa_onnx
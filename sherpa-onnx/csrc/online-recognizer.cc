@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
 #include <iomanip>
 #include <memory>
 #include <sstream>
@@ -94,7 +95,8 @@ void OnlineRecognizerConfig::Register(ParseOptions *po) {
   po->Register("enable-endpoint", &enable_endpoint,
                "True to enable endpoint detection. False to disable it.");
   po->Register("max-active-paths", &max_active_paths,
-               "beam size used in modified beam search.");
+               "beam size used in modified beam search and prefix beam "
+               "search.");
   po->Register("blank-penalty", &blank_penalty,
                "The penalty applied on blank symbol during decoding. "
                "Note: It is a positive value. "
@@ -103,7 +105,8 @@ void OnlineRecognizerConfig::Register(ParseOptions *po) {
                "Currently only applicable for transducer models.");
   po->Register("hotwords-score", &hotwords_score,
                "The bonus score for each token in context word/phrase. "
-               "Used only when decoding_method is modified_beam_search");
+               "Used only when decoding_method is modified_beam_search "
+               "or prefix_beam_search");
   po->Register(
       "hotwords-file", &hotwords_file,
       "The file containing hotwords, one words/phrases per line, For example: "
@@ -111,7 +114,8 @@ void OnlineRecognizerConfig::Register(ParseOptions *po) {
       "你好世界");
   po->Register("decoding-method", &decoding_method,
                "decoding method,"
-               "now support greedy_search and modified_beam_search.");
+               "now support greedy_search and modified_beam_search. "
+               "prefix_beam_search is supported for streaming CTC models.");
   po->Register("temperature-scale", &temperature_scale,
                "Temperature scale for confidence computation in decoding.");
   po->Register(
@@ -127,10 +131,24 @@ void OnlineRecognizerConfig::Register(ParseOptions *po) {
   po->Register("reset-encoder", &reset_encoder,
                "True to reset encoder_state on an endpoint after empty segment."
                "Done in `Reset()` method, after an endpoint was detected.");
+
+  po->Register("decoder-out-cache-size", &decoder_out_cache_size,
+               "Max number of decoder outputs cached and shared across "
+               "streams. 0 to disable it. Used only for transducer models "
+               "with greedy_search or modified_beam_search.");
 }
 
 bool OnlineRecognizerConfig::Validate() const {
-  if (decoding_method == "modified_beam_search" && !lm_config.model.empty()) {
+  bool is_beam_search = decoding_method == "modified_beam_search" ||
+                        decoding_method == "prefix_beam_search";
+
+  if (decoding_method == "prefix_beam_search" && max_active_paths <= 0) {
+    SHERPA_ONNX_LOGE("max_active_paths should be > 0. Given: %d",
+                     max_active_paths);
+    return false;
+  }
+
+  if (is_beam_search && !lm_config.model.empty()) {
     if (max_active_paths <= 0) {
       SHERPA_ONNX_LOGE("max_active_paths is less than 0! Given: %d",
                        max_active_paths);
@@ -142,14 +160,21 @@ bool OnlineRecognizerConfig::Validate() const {
     }
   }
 
-  if (!hotwords_file.empty() && decoding_method != "modified_beam_search") {
+  if (!hotwords_file.empty() && !is_beam_search) {
     SHERPA_ONNX_LOGE(
-        "Please use --decoding-method=modified_beam_search if you"
-        " provide --hotwords-file. Given --decoding-method=%s",
+        "Please use --decoding-method=modified_beam_search or "
+        "prefix_beam_search if you provide --hotwords-file. "
+        "Given --decoding-method=%s",
         decoding_method.c_str());
     return false;
   }
 
+  if (decoder_out_cache_size < 0) {
+    SHERPA_ONNX_LOGE("decoder_out_cache_size should be >= 0. Given: %d",
+                     decoder_out_cache_size);
+    return false;
+  }
+
   if (!ctc_fst_decoder_config.graph.empty() &&
       !ctc_fst_decoder_config.Validate()) {
     SHERPA_ONNX_LOGE("Errors in ctc_fst_decoder_config");
@@ -211,6 +236,7 @@ std::string OnlineRecognizerConfig::ToString() const {
   os << "rule_fsts=\"" << rule_fsts << "\", ";
   os << "rule_fars=\"" << rule_fars << "\", ";
   os << "reset_encoder=" << (reset_encoder ? "True" : "False") << ", ";
+  os << "decoder_out_cache_size=" << decoder_out_cache_size << ", ";
   os << "hr=" << hr.ToString() << ")";
 
   return os.str();
@@ -236,7 +262,12 @@ std::unique_ptr<OnlineStream> OnlineRecognizer::CreateStream(
 }
 
 bool OnlineRecognizer::IsReady(OnlineStream *s) const {
-  return impl_->IsReady(s);
+  bool ready = impl_->IsReady(s);
+  if (ready && impl_->GetStatsCollector()->IsEnabled()) {
+    s->MarkReady();
+  }
+
+  return ready;
 }
 
 void OnlineRecognizer::WarmpUpRecognizer(int32_t warmup, int32_t mbs) const {
@@ -246,7 +277,32 @@ void OnlineRecognizer::WarmpUpRecognizer(int32_t warmup, int32_t mbs) const {
 }
 
 void OnlineRecognizer::DecodeStreams(OnlineStream **ss, int32_t n) const {
+  auto stats = impl_->GetStatsCollector();
+  if (!stats->IsEnabled()) {
+    impl_->DecodeStreams(ss, n);
+    return;
+  }
+
+  int64_t num_processed_frames = 0;
+  for (int32_t i = 0; i != n; ++i) {
+    double queue_wait = ss[i]->TakeQueueWait();
+    if (queue_wait >= 0) {
+      stats->AddQueueWait(queue_wait);
+    }
+
+    num_processed_frames -= ss[i]->GetNumProcessedFrames();
+  }
+
+  auto start = std::chrono::steady_clock::now();
   impl_->DecodeStreams(ss, n);
+  auto end = std::chrono::steady_clock::now();
+
+  for (int32_t i = 0; i != n; ++i) {
+    num_processed_frames += ss[i]->GetNumProcessedFrames();
+  }
+
+  stats->AddBatch(n, num_processed_frames,
+                  std::chrono::duration<double>(end - start).count());
 }
 
 OnlineRecognizerResult OnlineRecognizer::GetResult(OnlineStream *s) const {
@@ -254,11 +310,25 @@ OnlineRecognizerResult OnlineRecognizer::GetResult(OnlineStream *s) const {
 }
 
 bool OnlineRecognizer::IsEndpoint(OnlineStream *s) const {
+  ScopedStageTimer timer(impl_->GetStatsCollector(),
+                         OnlineRecognizerStage::kEndpoint);
   return impl_->IsEndpoint(s);
 }
 
 void OnlineRecognizer::Reset(OnlineStream *s) const { impl_->Reset(s); }
 
+void OnlineRecognizer::EnableStats(bool enable /*= true*/) const {
+  impl_->GetStatsCollector()->Enable(enable);
+}
+
+OnlineRecognizerStats OnlineRecognizer::GetStats() const {
+  return impl_->GetStatsCollector()->GetStats();
+}
+
+void OnlineRecognizer::ResetStats() const {
+  impl_->GetStatsCollector()->Reset();
+}
+
 #if __ANDROID_API__ >= 9
 template OnlineRecognizer::OnlineRecognizer(
     AAssetManager *mgr, const OnlineRecognizerConfig &config);
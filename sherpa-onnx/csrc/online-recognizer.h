@@ -15,6 +15,7 @@
 #include "sherpa-onnx/csrc/online-ctc-fst-decoder-config.h"
 #include "sherpa-onnx/csrc/online-lm-config.h"
 #include "sherpa-onnx/csrc/online-model-config.h"
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/online-transducer-model-config.h"
 #include "sherpa-onnx/csrc/parse-options.h"
@@ -121,6 +122,12 @@ struct OnlineRecognizerConfig {
   /// "hotwords_file"
   std::string hotwords_buf;
 
+  /// Max number of decoder outputs cached across streams. The decoder of a
+  /// stateless transducer sees only the last context_size tokens, so its
+  /// output can be shared by all streams of a recognizer.
+  /// 0 disables the cache. Used only for transducer models.
+  int32_t decoder_out_cache_size = 0;
+
   OnlineRecognizerConfig() = default;
 
   OnlineRecognizerConfig(
@@ -220,6 +227,19 @@ class OnlineRecognizer {
   // after calling this function, IsEndpoint(s) will return false
   void Reset(OnlineStream *s) const;
 
+  /** Enable or disable the latency statistics. It is disabled by default.
+   *
+   * When enabled, the recognizer measures the stages of DecodeStreams()
+   * and IsEndpoint(), the batch sizes, the real-time factor and the time
+   * streams wait between IsReady() and DecodeStreams().
+   */
+  void EnableStats(bool enable = true) const;
+
+  // Return a snapshot of the statistics collected so far
+  OnlineRecognizerStats GetStats() const;
+
+  void ResetStats() const;
+
  private:
   std::unique_ptr<OnlineRecognizerImpl> impl_;
 };
@@ -6,16 +6,29 @@
 #include "sherpa-onnx/csrc/online-rnn-lm.h"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#if __ANDROID_API__ >= 9
+#include "android/asset_manager.h"
+#include "android/asset_manager_jni.h"
+#endif
+
+#if __OHOS__
+#include "rawfile/raw_file_manager.h"
+#endif
+
 #include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/cat.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
+#include "sherpa-onnx/csrc/unbind.h"
 
 namespace sherpa_onnx {
 
@@ -26,30 +39,144 @@ class OnlineRnnLM::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_{GetSessionOptions(config)},
         allocator_{} {
-    Init(config);
+    MappedFile buf(config_.model);
+    Init(buf.data(), buf.size());
+  }
+
+  template <typename Manager>
+  Impl(Manager *mgr, const OnlineLMConfig &config)
+      : config_(config),
+        env_(ORT_LOGGING_LEVEL_ERROR),
+        sess_opts_{GetSessionOptions(config)},
+        allocator_{} {
+    auto buf = ReadFile(mgr, config_.model);
+    Init(buf.data(), buf.size());
   }
 
   // shallow fusion scoring function
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) {
-    if (hyp->nn_lm_states.empty()) {
+    AddLMScoreSF(scale, hyp);
+    UpdateLMStatesSF({hyp});
+  }
+
+  void AddLMScoreSF(float scale, Hypothesis *hyp) {
+    if (!hyp->nn_lm_state) {
       auto init_states = GetInitStatesSF();
-      hyp->nn_lm_scores.value = std::move(init_states.first);
-      hyp->nn_lm_states = Convert(std::move(init_states.second));
+      auto state = std::make_shared<LMState>();
+      state->scores = std::move(init_states.first);
+      state->states = std::move(init_states.second);
+      hyp->nn_lm_state = std::move(state);
     }
 
     // get lm score for cur token given the hyp->ys[:-1] and save to lm_log_prob
-    const float *nn_lm_scores = hyp->nn_lm_scores.value.GetTensorData<float>();
+    const float *nn_lm_scores = hyp->nn_lm_state->scores.GetTensorData<float>();
     hyp->lm_log_prob += nn_lm_scores[hyp->ys.back()] * scale;
+  }
 
-    // get lm scores for next tokens given the hyp->ys[:] and save to
-    // nn_lm_scores
-    std::array<int64_t, 2> x_shape{1, 1};
+  // get lm scores for next tokens given the hyp->ys[:] and save to
+  // nn_lm_state, for all hyps with a single run of the LM
+  void UpdateLMStatesSF(const std::vector<Hypothesis *> &hyps) {
+    // Hyps that extend the same state with the same token share one run.
+    // parents[j] and tokens[j] are the inputs of the j-th run and
+    // run_index[i] is the run used by hyps[i]
+    std::vector<std::shared_ptr<const LMState>> parents;
+    std::vector<int64_t> tokens;
+    std::vector<int32_t> run_index(hyps.size(), -1);
+    std::map<std::pair<const LMState *, int64_t>, int32_t> runs;
+
+    for (int32_t i = 0; i != static_cast<int32_t>(hyps.size()); ++i) {
+      auto &parent = hyps[i]->nn_lm_state;
+      int64_t token = hyps[i]->ys.back();
+
+      auto it = parent->children.find(token);
+      if (it != parent->children.end()) {
+        auto child = it->second.lock();
+        if (child) {
+          hyps[i]->nn_lm_state = std::move(child);
+          hyps[i]->cur_scored_pos += 1;
+          continue;
+        }
+      }
+
+      auto r = runs.emplace(std::make_pair(parent.get(), token),
+                            static_cast<int32_t>(parents.size()));
+      if (r.second) {
+        parents.push_back(parent);
+        tokens.push_back(token);
+      }
+      run_index[i] = r.first->second;
+    }
+
+    int32_t n = static_cast<int32_t>(parents.size());
+    if (n == 0) {
+      return;
+    }
+
+    std::array<int64_t, 2> x_shape{n, 1};
     Ort::Value x = Ort::Value::CreateTensor<int64_t>(allocator_, x_shape.data(),
                                                      x_shape.size());
-    *x.GetTensorMutableData<int64_t>() = hyp->ys.back();
-    auto lm_out = ScoreToken(std::move(x), Convert(hyp->nn_lm_states));
-    hyp->nn_lm_scores.value = std::move(lm_out.first);
-    hyp->nn_lm_states = Convert(std::move(lm_out.second));
+    std::copy(tokens.begin(), tokens.end(), x.GetTensorMutableData<int64_t>());
+
+    std::vector<std::shared_ptr<LMState>> children(n);
+    for (auto &c : children) {
+      c = std::make_shared<LMState>();
+    }
+
+    if (n == 1) {
+      auto lm_out = ScoreToken(std::move(x), ViewStates(*parents[0]));
+      children[0]->scores = std::move(lm_out.first);
+      children[0]->states = std::move(lm_out.second);
+    } else {
+      // Each state has shape (num_layers, 1, hidden_size), so we stack them
+      // along dim 1
+      int32_t num_states = static_cast<int32_t>(parents[0]->states.size());
+      std::vector<Ort::Value> states;
+      states.reserve(num_states);
+
+      std::vector<const Ort::Value *> buf(n);
+      for (int32_t s = 0; s != num_states; ++s) {
+        for (int32_t j = 0; j != n; ++j) {
+          buf[j] = &parents[j]->states[s];
+        }
+        states.push_back(Cat(allocator_, buf, 1));
+      }
+
+      auto lm_out = ScoreToken(std::move(x), std::move(states));
+
+      std::vector<Ort::Value> scores = Unbind(allocator_, &lm_out.first, 0);
+      for (int32_t j = 0; j != n; ++j) {
+        children[j]->scores = std::move(scores[j]);
+      }
+
+      for (auto &v : lm_out.second) {
+        std::vector<Ort::Value> next_states = Unbind(allocator_, &v, 1);
+        for (int32_t j = 0; j != n; ++j) {
+          children[j]->states.push_back(std::move(next_states[j]));
+        }
+      }
+    }
+
+    for (int32_t j = 0; j != n; ++j) {
+      auto &cache = parents[j]->children;
+
+      // Remove states that are no longer used by any hyp
+      for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.expired()) {
+          it = cache.erase(it);
+        } else {
+          ++it;
+        }
+      }
+
+      cache[tokens[j]] = children[j];
+    }
+
+    for (int32_t i = 0; i != static_cast<int32_t>(hyps.size()); ++i) {
+      if (run_index[i] != -1) {
+        hyps[i]->nn_lm_state = children[run_index[i]];
+        hyps[i]->cur_scored_pos += 1;
+      }
+    }
   }
 
   // classic rescore function
@@ -57,6 +184,16 @@ class OnlineRnnLM::Impl {
                       std::vector<Hypotheses> *hyps) {
     Ort::AllocatorWithDefaultOptions allocator;
 
+    // Hyps that feed the same tokens into the same state share one run.
+    // It maps (state, tokens) to (next state, nll)
+    std::map<std::pair<const LMState *, std::vector<int64_t>>,
+             std::pair<std::shared_ptr<const LMState>, float>>
+        done;
+
+    // Keep the states used in the keys of `done` alive, so that their
+    // addresses are not reused by new states
+    std::vector<std::shared_ptr<const LMState>> used_states;
+
     for (auto &hyp : *hyps) {
       for (auto &h_m : hyp) {
         auto &h = h_m.second;
@@ -68,29 +205,46 @@ class OnlineRnnLM::Impl {
           continue;
         }
 
-        if (h.nn_lm_states.empty()) {
-          h.nn_lm_states = Convert(GetInitStates());
+        if (!h.nn_lm_state) {
+          auto state = std::make_shared<LMState>();
+          for (auto &s : init_states_) {
+            state->states.push_back(View(&s));
+          }
+          h.nn_lm_state = std::move(state);
         }
 
         if (token_num_in_chunk >= h.lm_rescore_min_chunk) {
-          std::array<int64_t, 2> x_shape{1, token_num_in_chunk};
+          std::vector<int64_t> tokens(
+              ys.begin() + context_size + h.cur_scored_pos, ys.end() - 1);
+
+          auto key = std::make_pair(h.nn_lm_state.get(), tokens);
+          auto it = done.find(key);
+          if (it == done.end()) {
+            std::array<int64_t, 2> x_shape{1, token_num_in_chunk};
 
-          Ort::Value x = Ort::Value::CreateTensor<int64_t>(
-              allocator, x_shape.data(), x_shape.size());
-          int64_t *p_x = x.GetTensorMutableData<int64_t>();
-          std::copy(ys.begin() + context_size + h.cur_scored_pos, ys.end() - 1,
-                    p_x);
+            Ort::Value x = Ort::Value::CreateTensor<int64_t>(
+                allocator, x_shape.data(), x_shape.size());
+            std::copy(tokens.begin(), tokens.end(),
+                      x.GetTensorMutableData<int64_t>());
 
-          // streaming forward by NN LM
-          auto out =
-              ScoreToken(std::move(x), Convert(std::move(h.nn_lm_states)));
+            // streaming forward by NN LM
+            auto out = ScoreToken(std::move(x), ViewStates(*h.nn_lm_state));
+
+            auto state = std::make_shared<LMState>();
+            state->states = std::move(out.second);
+
+            const float *p_nll = out.first.GetTensorData<float>();
+            used_states.push_back(h.nn_lm_state);
+            it = done.emplace(std::move(key),
+                              std::make_pair(std::move(state), *p_nll))
+                     .first;
+          }
 
           // update NN LM score in hyp
-          const float *p_nll = out.first.GetTensorData<float>();
-          h.lm_log_prob = -scale * (*p_nll);
+          h.lm_log_prob = -scale * it->second.second;
 
           // update NN LM states in hyp
-          h.nn_lm_states = Convert(std::move(out.second));
+          h.nn_lm_state = it->second.first;
 
           h.cur_scored_pos += token_num_in_chunk;
         }
@@ -125,6 +279,17 @@ class OnlineRnnLM::Impl {
     return {View(&init_scores_.value), std::move(ans)};
   }
 
+  // The LM does not modify its inputs, so we can run it on views of the
+  // shared states without copying them
+  static std::vector<Ort::Value> ViewStates(const LMState &state) {
+    std::vector<Ort::Value> ans;
+    ans.reserve(state.states.size());
+    for (const auto &s : state.states) {
+      ans.push_back(View(const_cast<Ort::Value *>(&s)));
+    }
+    return ans;
+  }
+
   // get init states for classic rescore
   std::vector<Ort::Value> GetInitStates() {
     std::vector<Ort::Value> ans;
@@ -138,11 +303,8 @@ class OnlineRnnLM::Impl {
   }
 
  private:
-  void Init(const OnlineLMConfig &config) {
-    auto buf = ReadFile(config_.model);
-
-    sess_ = std::make_unique<Ort::Session>(env_, buf.data(), buf.size(),
-                                           sess_opts_);
+  void Init(void *model_data, size_t model_data_length) {
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
     GetOutputNames(sess_.get(), &output_names_, &output_names_ptr_);
@@ -208,6 +370,10 @@ class OnlineRnnLM::Impl {
 OnlineRnnLM::OnlineRnnLM(const OnlineLMConfig &config)
     : impl_(std::make_unique<Impl>(config)) {}
 
+template <typename Manager>
+OnlineRnnLM::OnlineRnnLM(Manager *mgr, const OnlineLMConfig &config)
+    : impl_(std::make_unique<Impl>(mgr, config)) {}
+
 OnlineRnnLM::~OnlineRnnLM() = default;
 
 // classic rescore state init
@@ -236,4 +402,22 @@ void OnlineRnnLM::ComputeLMScoreSF(float scale, Hypothesis *hyp) {
   return impl_->ComputeLMScoreSF(scale, hyp);
 }
 
+void OnlineRnnLM::AddLMScoreSF(float scale, Hypothesis *hyp) {
+  return impl_->AddLMScoreSF(scale, hyp);
+}
+
+void OnlineRnnLM::UpdateLMStatesSF(const std::vector<Hypothesis *> &hyps) {
+  return impl_->UpdateLMStatesSF(hyps);
+}
+
+#if __ANDROID_API__ >= 9
+template OnlineRnnLM::OnlineRnnLM(AAssetManager *mgr,
+                                  const OnlineLMConfig &config);
+#endif
+
+#if __OHOS__
+template OnlineRnnLM::OnlineRnnLM(NativeResourceManager *mgr,
+                                  const OnlineLMConfig &config);
+#endif
+
 }  // namespace sherpa_onnx
@@ -22,6 +22,9 @@ class OnlineRnnLM : public OnlineLM {
 
   explicit OnlineRnnLM(const OnlineLMConfig &config);
 
+  template <typename Manager>
+  OnlineRnnLM(Manager *mgr, const OnlineLMConfig &config);
+
   // init scores for classic rescore
   std::vector<Ort::Value> GetInitStates() override;
 
@@ -50,7 +53,7 @@ class OnlineRnnLM : public OnlineLM {
   void ComputeLMScore(float scale, int32_t context_size,
                               std::vector<Hypotheses> *hyps) override;
 
-   /** This function updates lm_lob_prob and nn_lm_scores of hyp (shallow fusion).
+   /** This function updates lm_lob_prob and nn_lm_state of hyp (shallow fusion).
    *
    * @param scale LM score
    * @param hyps It is changed in-place.
@@ -58,6 +61,10 @@ class OnlineRnnLM : public OnlineLM {
    */
   void ComputeLMScoreSF(float scale, Hypothesis *hyp) override;
 
+  void AddLMScoreSF(float scale, Hypothesis *hyp) override;
+
+  void UpdateLMStatesSF(const std::vector<Hypothesis *> &hyps) override;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
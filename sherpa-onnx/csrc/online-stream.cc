@@ -3,6 +3,8 @@
 // Copyright (c)  2023  Xiaomi Corporation
 #include "sherpa-onnx/csrc/online-stream.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <utility>
 #include <vector>
@@ -12,6 +14,12 @@
 
 namespace sherpa_onnx {
 
+static int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 class OnlineStream::Impl {
  public:
   explicit Impl(const FeatureExtractorConfig &config,
@@ -22,6 +30,11 @@ class OnlineStream::Impl {
     feat_extractor_.AcceptWaveform(sampling_rate, waveform, n);
   }
 
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) {
+    feat_extractor_.AcceptWaveform(sampling_rate, waveform, n);
+  }
+
   void InputFinished() const { feat_extractor_.InputFinished(); }
 
   int32_t NumFramesReady() const {
@@ -36,6 +49,10 @@ class OnlineStream::Impl {
     return feat_extractor_.GetFrames(frame_index + start_frame_index_, n);
   }
 
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const {
+    feat_extractor_.GetFrames(frame_index + start_frame_index_, n, out);
+  }
+
   void Reset() {
     // we don't reset the feature extractor
     start_frame_index_ += num_processed_frames_;
@@ -75,6 +92,8 @@ class OnlineStream::Impl {
 
   void SetCtcResult(const OnlineCtcDecoderResult &r) { ctc_result_ = r; }
 
+  void SetCtcResult(OnlineCtcDecoderResult &&r) { ctc_result_ = std::move(r); }
+
   void SetParaformerResult(const OnlineParaformerDecoderResult &r) {
     paraformer_result_ = r;
   }
@@ -87,9 +106,32 @@ class OnlineStream::Impl {
 
   void SetStates(std::vector<Ort::Value> states) {
     states_ = std::move(states);
+    batched_states_.reset();
+    batched_states_row_ = -1;
+  }
+
+  std::vector<Ort::Value> &GetStates() {
+    if (batched_states_) {
+      states_ = batched_states_->TakeRow(batched_states_row_);
+      batched_states_.reset();
+      batched_states_row_ = -1;
+    }
+
+    return states_;
+  }
+
+  void SetBatchedStates(std::shared_ptr<OnlineBatchedStates> states,
+                        int32_t row) {
+    states_.clear();
+    batched_states_ = std::move(states);
+    batched_states_row_ = row;
+  }
+
+  const std::shared_ptr<OnlineBatchedStates> &GetBatchedStates() const {
+    return batched_states_;
   }
 
-  std::vector<Ort::Value> &GetStates() { return states_; }
+  int32_t GetBatchedStatesRow() const { return batched_states_row_; }
 
   void SetNeMoDecoderStates(std::vector<Ort::Value> decoder_states) {
     decoder_states_ = std::move(decoder_states);
@@ -123,6 +165,20 @@ class OnlineStream::Impl {
     return faster_decoder_processed_frames_;
   }
 
+  void MarkReady() {
+    int64_t expected = 0;
+    ready_time_ns_.compare_exchange_strong(expected, NowNs());
+  }
+
+  double TakeQueueWait() {
+    int64_t t = ready_time_ns_.exchange(0);
+    if (t == 0) {
+      return -1;
+    }
+
+    return (NowNs() - t) * 1e-9;
+  }
+
  private:
   FeatureExtractor feat_extractor_;
   /// For contextual-biasing
@@ -136,6 +192,11 @@ class OnlineStream::Impl {
   TransducerKeywordResult empty_keyword_result_;
   OnlineCtcDecoderResult ctc_result_;
   std::vector<Ort::Value> states_;  // states for transducer or ctc models
+
+  // If not empty, states_ is not used and the states of this stream
+  // are in the row batched_states_row_ of batched_states_
+  std::shared_ptr<OnlineBatchedStates> batched_states_;
+  int32_t batched_states_row_ = -1;
   std::vector<Ort::Value> decoder_states_;  // states for nemo transducer models
   std::vector<float> paraformer_feat_cache_;
   std::vector<float> paraformer_encoder_out_cache_;
@@ -143,6 +204,10 @@ class OnlineStream::Impl {
   OnlineParaformerDecoderResult paraformer_result_;
   std::unique_ptr<kaldi_decoder::FasterDecoder> faster_decoder_;
   int32_t faster_decoder_processed_frames_ = 0;
+
+  // See MarkReady(). 0 means not marked. It is atomic since IsReady()
+  // and DecodeStreams() may be called from different threads.
+  std::atomic<int64_t> ready_time_ns_{0};
 };
 
 OnlineStream::OnlineStream(const FeatureExtractorConfig &config /*= {}*/,
@@ -156,6 +221,11 @@ void OnlineStream::AcceptWaveform(int32_t sampling_rate, const float *waveform,
   impl_->AcceptWaveform(sampling_rate, waveform, n);
 }
 
+void OnlineStream::AcceptWaveform(int32_t sampling_rate,
+                                  const int16_t *waveform, int32_t n) const {
+  impl_->AcceptWaveform(sampling_rate, waveform, n);
+}
+
 void OnlineStream::InputFinished() const { impl_->InputFinished(); }
 
 int32_t OnlineStream::NumFramesReady() const { return impl_->NumFramesReady(); }
@@ -169,6 +239,11 @@ std::vector<float> OnlineStream::GetFrames(int32_t frame_index,
   return impl_->GetFrames(frame_index, n);
 }
 
+void OnlineStream::GetFrames(int32_t frame_index, int32_t n,
+                             float *out) const {
+  impl_->GetFrames(frame_index, n, out);
+}
+
 void OnlineStream::Reset() { impl_->Reset(); }
 
 int32_t OnlineStream::FeatureDim() const { return impl_->FeatureDim(); }
@@ -210,6 +285,10 @@ void OnlineStream::SetCtcResult(const OnlineCtcDecoderResult &r) {
   impl_->SetCtcResult(r);
 }
 
+void OnlineStream::SetCtcResult(OnlineCtcDecoderResult &&r) {
+  impl_->SetCtcResult(std::move(r));
+}
+
 void OnlineStream::SetParaformerResult(const OnlineParaformerDecoderResult &r) {
   impl_->SetParaformerResult(r);
 }
@@ -226,6 +305,20 @@ std::vector<Ort::Value> &OnlineStream::GetStates() {
   return impl_->GetStates();
 }
 
+void OnlineStream::SetBatchedStates(
+    std::shared_ptr<OnlineBatchedStates> states, int32_t row) {
+  impl_->SetBatchedStates(std::move(states), row);
+}
+
+const std::shared_ptr<OnlineBatchedStates> &OnlineStream::GetBatchedStates()
+    const {
+  return impl_->GetBatchedStates();
+}
+
+int32_t OnlineStream::GetBatchedStatesRow() const {
+  return impl_->GetBatchedStatesRow();
+}
+
 void OnlineStream::SetNeMoDecoderStates(
     std::vector<Ort::Value> decoder_states) {
   return impl_->SetNeMoDecoderStates(std::move(decoder_states));
@@ -264,4 +357,8 @@ std::vector<float> &OnlineStream::GetParaformerAlphaCache() {
   return impl_->GetParaformerAlphaCache();
 }
 
+void OnlineStream::MarkReady() const { impl_->MarkReady(); }
+
+double OnlineStream::TakeQueueWait() const { return impl_->TakeQueueWait(); }
+
 }  // namespace sherpa_onnx
@@ -12,6 +12,7 @@
 #include "onnxruntime_cxx_api.h"  // NOLINT
 #include "sherpa-onnx/csrc/context-graph.h"
 #include "sherpa-onnx/csrc/features.h"
+#include "sherpa-onnx/csrc/online-batched-states.h"
 #include "sherpa-onnx/csrc/online-ctc-decoder.h"
 #include "sherpa-onnx/csrc/online-paraformer-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
@@ -37,6 +38,11 @@ class OnlineStream {
   void AcceptWaveform(int32_t sampling_rate, const float *waveform,
                       int32_t n) const;
 
+  // Same as above except that the input is 16-bit PCM, i.e., samples are
+  // in the range [-32768, 32767]
+  void AcceptWaveform(int32_t sampling_rate, const int16_t *waveform,
+                      int32_t n) const;
+
   /**
    * InputFinished() tells the class you won't be providing any
    * more waveform.  This will help flush out the last frame or two
@@ -61,6 +67,13 @@ class OnlineStream {
    */
   std::vector<float> GetFrames(int32_t frame_index, int32_t n) const;
 
+  /** Get n frames starting from the given frame index and write them
+   * to the given buffer, which must have room for n * FeatureDim() floats.
+   *
+   * It is used to fill the batched input of the model in-place.
+   */
+  void GetFrames(int32_t frame_index, int32_t n, float *out) const;
+
   void Reset();
 
   int32_t FeatureDim() const;
@@ -83,14 +96,30 @@ class OnlineStream {
   TransducerKeywordResult &GetKeywordResult(bool remove_duplicates = false);
 
   void SetCtcResult(const OnlineCtcDecoderResult &r);
+  void SetCtcResult(OnlineCtcDecoderResult &&r);
   OnlineCtcDecoderResult &GetCtcResult();
 
   void SetParaformerResult(const OnlineParaformerDecoderResult &r);
   OnlineParaformerDecoderResult &GetParaformerResult();
 
+  // It also releases the reference to the batched states, if any.
   void SetStates(std::vector<Ort::Value> states);
+
+  // If the states of this stream are held in a batch, they are
+  // unstacked before returning.
   std::vector<Ort::Value> &GetStates();
 
+  /** Let this stream use the given row of the batched states as its
+   * states. See also OnlineBatchedStates.
+   */
+  void SetBatchedStates(std::shared_ptr<OnlineBatchedStates> states,
+                        int32_t row);
+
+  // Return nullptr if the states of this stream are not held in a batch
+  const std::shared_ptr<OnlineBatchedStates> &GetBatchedStates() const;
+
+  int32_t GetBatchedStatesRow() const;
+
   void SetNeMoDecoderStates(std::vector<Ort::Value> decoder_states);
   std::vector<Ort::Value> &GetNeMoDecoderStates();
 
@@ -111,6 +140,17 @@ class OnlineStream {
   std::vector<float> &GetParaformerEncoderOutCache();
   std::vector<float> &GetParaformerAlphaCache();
 
+  // For the queue wait statistics of OnlineRecognizer.
+  // See OnlineRecognizer::EnableStats()
+  //
+  // Record the current time as the time when this stream became ready for
+  // decoding. It does nothing if a time has already been recorded.
+  void MarkReady() const;
+
+  // Return the seconds since the recorded time and clear it.
+  // Return a negative value if no time is recorded.
+  double TakeQueueWait() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
@@ -0,0 +1,160 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+namespace {
+
+// The decoder output of a context (a, b) is (a + b, 10 * a, 100 * b)
+class FakeTransducerModel : public OnlineTransducerModel {
+ public:
+  std::vector<Ort::Value> StackStates(
+      const std::vector<std::vector<Ort::Value>> & /*states*/) const override {
+    return {};
+  }
+
+  std::vector<std::vector<Ort::Value>> UnStackStates(
+      const std::vector<Ort::Value> & /*states*/) const override {
+    return {};
+  }
+
+  std::vector<Ort::Value> GetEncoderInitStates() override { return {}; }
+
+  std::pair<Ort::Value, std::vector<Ort::Value>> RunEncoder(
+      Ort::Value /*features*/, std::vector<Ort::Value> /*states*/,
+      Ort::Value /*processed_frames*/) override {
+    return {Ort::Value{nullptr}, {}};
+  }
+
+  Ort::Value RunDecoder(Ort::Value decoder_input) override {
+    auto shape = decoder_input.GetTensorTypeAndShapeInfo().GetShape();
+    const int64_t *p = decoder_input.GetTensorData<int64_t>();
+
+    std::array<int64_t, 2> out_shape{shape[0], 3};
+    Ort::Value ans = Ort::Value::CreateTensor<float>(
+        allocator_, out_shape.data(), out_shape.size());
+    float *q = ans.GetTensorMutableData<float>();
+    for (int64_t i = 0; i != shape[0]; ++i, p += 2, q += 3) {
+      q[0] = p[0] + p[1];
+      q[1] = 10 * p[0];
+      q[2] = 100 * p[1];
+    }
+
+    num_calls += 1;
+    num_rows += shape[0];
+
+    return ans;
+  }
+
+  Ort::Value RunJoiner(Ort::Value /*encoder_out*/,
+                       Ort::Value /*decoder_out*/) override {
+    return Ort::Value{nullptr};
+  }
+
+  int32_t ContextSize() const override { return 2; }
+  int32_t ChunkSize() const override { return 0; }
+  int32_t ChunkShift() const override { return 0; }
+  int32_t VocabSize() const override { return 500; }
+  OrtAllocator *Allocator() override { return allocator_; }
+
+  int32_t num_calls = 0;
+  int32_t num_rows = 0;
+
+ private:
+  Ort::AllocatorWithDefaultOptions allocator_;
+};
+
+Ort::Value MakeInput(const std::vector<int64_t> &tokens) {
+  Ort::AllocatorWithDefaultOptions allocator;
+  std::array<int64_t, 2> shape{static_cast<int64_t>(tokens.size() / 2), 2};
+  Ort::Value ans =
+      Ort::Value::CreateTensor<int64_t>(allocator, shape.data(), shape.size());
+  std::copy(tokens.begin(), tokens.end(),
+            ans.GetTensorMutableData<int64_t>());
+  return ans;
+}
+
+void CheckOutput(const std::vector<int64_t> &tokens, Ort::Value *out) {
+  auto shape = out->GetTensorTypeAndShapeInfo().GetShape();
+  ASSERT_EQ(shape.size(), 2);
+  ASSERT_EQ(shape[0], static_cast<int64_t>(tokens.size() / 2));
+  ASSERT_EQ(shape[1], 3);
+
+  const float *p = out->GetTensorData<float>();
+  for (int32_t i = 0; i != shape[0]; ++i, p += 3) {
+    EXPECT_EQ(p[0], tokens[2 * i] + tokens[2 * i + 1]);
+    EXPECT_EQ(p[1], 10 * tokens[2 * i]);
+    EXPECT_EQ(p[2], 100 * tokens[2 * i + 1]);
+  }
+}
+
+}  // namespace
+
+TEST(OnlineTransducerDecoderOutCache, HitAndMiss) {
+  FakeTransducerModel model;
+  OnlineTransducerDecoderOutCache cache(10);
+
+  // Duplicated contexts in a batch are computed only once
+  std::vector<int64_t> tokens = {0, 0, 1, 2, 0, 0, 3, 4};
+  auto out = cache.Run(&model, MakeInput(tokens));
+  CheckOutput(tokens, &out);
+  EXPECT_EQ(model.num_calls, 1);
+  EXPECT_EQ(model.num_rows, 3);
+  EXPECT_EQ(cache.NumHits(), 1);
+  EXPECT_EQ(cache.NumMisses(), 3);
+  EXPECT_EQ(cache.Size(), 3);
+
+  // All of them are in the cache
+  tokens = {3, 4, 0, 0};
+  out = cache.Run(&model, MakeInput(tokens));
+  CheckOutput(tokens, &out);
+  EXPECT_EQ(model.num_calls, 1);
+  EXPECT_EQ(cache.NumHits(), 3);
+
+  // Only the new context is computed
+  tokens = {1, 2, 5, 6, 0, 0};
+  out = cache.Run(&model, MakeInput(tokens));
+  CheckOutput(tokens, &out);
+  EXPECT_EQ(model.num_calls, 2);
+  EXPECT_EQ(model.num_rows, 4);
+  EXPECT_EQ(cache.NumHits(), 5);
+  EXPECT_EQ(cache.NumMisses(), 4);
+  EXPECT_FLOAT_EQ(cache.HitRate(), 5.0f / 9);
+}
+
+TEST(OnlineTransducerDecoderOutCache, Eviction) {
+  FakeTransducerModel model;
+  OnlineTransducerDecoderOutCache cache(2);
+
+  std::vector<int64_t> tokens = {1, 1, 2, 2};
+  auto out = cache.Run(&model, MakeInput(tokens));
+
+  // (1, 1) becomes the most recently used entry
+  tokens = {1, 1};
+  out = cache.Run(&model, MakeInput(tokens));
+  EXPECT_EQ(model.num_calls, 1);
+
+  // (2, 2) is evicted
+  tokens = {3, 3};
+  out = cache.Run(&model, MakeInput(tokens));
+  EXPECT_EQ(model.num_calls, 2);
+  EXPECT_EQ(cache.Size(), 2);
+
+  tokens = {1, 1, 2, 2};
+  out = cache.Run(&model, MakeInput(tokens));
+  CheckOutput(tokens, &out);
+  EXPECT_EQ(model.num_calls, 3);
+  EXPECT_EQ(model.num_rows, 4);
+}
+
+}  // namespace sherpa_onnx
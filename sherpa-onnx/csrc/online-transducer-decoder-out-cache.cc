@@ -0,0 +1,168 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace sherpa_onnx {
+
+std::size_t OnlineTransducerDecoderOutCache::KeyHash::operator()(
+    const std::vector<int64_t> &key) const {
+  std::size_t h = key.size();
+  for (auto k : key) {
+    h ^= std::hash<int64_t>()(k) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+OnlineTransducerDecoderOutCache::OnlineTransducerDecoderOutCache(
+    int32_t max_size)
+    : max_size_(std::max(max_size, 1)) {}
+
+Ort::Value OnlineTransducerDecoderOutCache::Run(OnlineTransducerModel *model,
+                                                Ort::Value decoder_input) {
+  std::vector<int64_t> input_shape =
+      decoder_input.GetTensorTypeAndShapeInfo().GetShape();
+  int32_t batch_size = static_cast<int32_t>(input_shape[0]);
+  int32_t context_size = static_cast<int32_t>(input_shape[1]);
+  const int64_t *p = decoder_input.GetTensorData<int64_t>();
+
+  std::vector<std::vector<int64_t>> keys;
+  keys.reserve(batch_size);
+  for (int32_t i = 0; i != batch_size; ++i) {
+    keys.emplace_back(p + i * context_size, p + (i + 1) * context_size);
+  }
+
+  Ort::Value ans{nullptr};
+  float *dst = nullptr;
+
+  int32_t decoder_dim;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoder_dim = decoder_dim_;
+  }
+
+  if (decoder_dim > 0) {
+    std::array<int64_t, 2> shape{batch_size, decoder_dim};
+    ans = Ort::Value::CreateTensor<float>(model->Allocator(), shape.data(),
+                                          shape.size());
+    dst = ans.GetTensorMutableData<float>();
+  }
+
+  // miss_index[i] is -1 if row i is found in the cache; otherwise it is
+  // an index into unique_misses
+  std::vector<int32_t> miss_index(batch_size, -1);
+
+  // Row index of the first occurrence of each context that is not in
+  // the cache. Duplicated contexts in a batch are computed only once.
+  std::vector<int32_t> unique_misses;
+  std::unordered_map<std::vector<int64_t>, int32_t, KeyHash> pending;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int32_t i = 0; i != batch_size; ++i) {
+      if (dst) {
+        auto it = map_.find(keys[i]);
+        if (it != map_.end()) {
+          entries_.splice(entries_.begin(), entries_, it->second);
+          std::copy(it->second->value.begin(), it->second->value.end(),
+                    dst + i * decoder_dim);
+          continue;
+        }
+      }
+
+      auto r = pending.emplace(keys[i],
+                               static_cast<int32_t>(unique_misses.size()));
+      if (r.second) {
+        unique_misses.push_back(i);
+      }
+      miss_index[i] = r.first->second;
+    }
+  }
+
+  int32_t num_misses = static_cast<int32_t>(unique_misses.size());
+  num_hits_ += batch_size - num_misses;
+  num_misses_ += num_misses;
+
+  if (num_misses == 0) {
+    return ans;
+  }
+
+  Ort::Value miss_input{nullptr};
+  if (num_misses == batch_size) {
+    miss_input = std::move(decoder_input);
+  } else {
+    std::array<int64_t, 2> shape{num_misses, context_size};
+    miss_input = Ort::Value::CreateTensor<int64_t>(
+        model->Allocator(), shape.data(), shape.size());
+    int64_t *q = miss_input.GetTensorMutableData<int64_t>();
+    for (auto i : unique_misses) {
+      std::copy(keys[i].begin(), keys[i].end(), q);
+      q += context_size;
+    }
+  }
+
+  Ort::Value decoder_out = model->RunDecoder(std::move(miss_input));
+  int32_t dim = static_cast<int32_t>(
+      decoder_out.GetTensorTypeAndShapeInfo().GetElementCount() / num_misses);
+  const float *src = decoder_out.GetTensorData<float>();
+
+  if (!dst) {
+    std::array<int64_t, 2> shape{batch_size, dim};
+    ans = Ort::Value::CreateTensor<float>(model->Allocator(), shape.data(),
+                                          shape.size());
+    dst = ans.GetTensorMutableData<float>();
+  }
+
+  for (int32_t i = 0; i != batch_size; ++i) {
+    if (miss_index[i] != -1) {
+      std::copy(src + miss_index[i] * dim, src + (miss_index[i] + 1) * dim,
+                dst + i * dim);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  decoder_dim_ = dim;
+  for (int32_t k = 0; k != num_misses; ++k) {
+    InsertLocked(std::move(keys[unique_misses[k]]), src + k * dim);
+  }
+
+  return ans;
+}
+
+float OnlineTransducerDecoderOutCache::HitRate() const {
+  int64_t hits = num_hits_;
+  int64_t total = hits + num_misses_;
+  return total > 0 ? static_cast<float>(hits) / total : 0;
+}
+
+int32_t OnlineTransducerDecoderOutCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int32_t>(map_.size());
+}
+
+void OnlineTransducerDecoderOutCache::InsertLocked(std::vector<int64_t> key,
+                                                   const float *value) {
+  auto it = map_.find(key);
+  if (it != map_.end()) {
+    // Another thread has inserted it while we were running the decoder
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if (static_cast<int32_t>(map_.size()) >= max_size_) {
+    map_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+
+  entries_.push_front({key, std::vector<float>(value, value + decoder_dim_)});
+  map_.emplace(std::move(key), entries_.begin());
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,93 @@
+// sherpa-onnx/csrc/online-transducer-decoder-out-cache.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
+#define SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "onnxruntime_cxx_api.h"  // NOLINT
+#include "sherpa-onnx/csrc/online-transducer-model.h"
+
+namespace sherpa_onnx {
+
+/** A bounded LRU cache for the output of the transducer decoder.
+ *
+ * The decoder of a stateless transducer sees only the last `context_size`
+ * tokens, so its output is a pure function of them. Streams that are decoded
+ * by the same recognizer share lots of contexts, e.g., the initial blank
+ * context and frequent token pairs, so the result of the decoder network
+ * can be reused across streams and across chunks.
+ *
+ * It is safe to call Run() from multiple threads.
+ */
+class OnlineTransducerDecoderOutCache {
+ public:
+  /**
+   * @param max_size  Max number of contexts kept in the cache. The least
+   *                  recently used entry is evicted when it is full.
+   */
+  explicit OnlineTransducerDecoderOutCache(int32_t max_size);
+
+  /** A drop-in replacement of model->RunDecoder(decoder_input).
+   *
+   * @param model  The model to run for contexts that are not in the cache.
+   * @param decoder_input  A tensor of shape (N, context_size) with dtype
+   *                       int64, e.g., the return value of
+   *                       model->BuildDecoderInput().
+   *
+   * @return Return a tensor of shape (N, decoder_dim). Unlike the output of
+   *         model->RunDecoder(), it is always owned by the caller.
+   */
+  Ort::Value Run(OnlineTransducerModel *model, Ort::Value decoder_input);
+
+  // Number of rows whose decoder output was taken from the cache
+  int64_t NumHits() const { return num_hits_; }
+
+  // Number of rows for which the decoder network was run
+  int64_t NumMisses() const { return num_misses_; }
+
+  float HitRate() const;
+
+  // Number of contexts in the cache
+  int32_t Size() const;
+
+ private:
+  struct KeyHash {
+    std::size_t operator()(const std::vector<int64_t> &key) const;
+  };
+
+  struct Entry {
+    std::vector<int64_t> key;
+    std::vector<float> value;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // Must be called with mutex_ held
+  void InsertLocked(std::vector<int64_t> key, const float *value);
+
+ private:
+  int32_t max_size_;
+
+  mutable std::mutex mutex_;
+
+  // Front is the most recently used entry
+  EntryList entries_;
+  std::unordered_map<std::vector<int64_t>, EntryList::iterator, KeyHash> map_;
+
+  // 0 until the decoder has been run once
+  int32_t decoder_dim_ = 0;
+
+  std::atomic<int64_t> num_hits_{0};
+  std::atomic<int64_t> num_misses_{0};
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_ONLINE_TRANSDUCER_DECODER_OUT_CACHE_H_
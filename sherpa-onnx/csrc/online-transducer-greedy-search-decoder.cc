@@ -109,7 +109,7 @@ void OnlineTransducerGreedySearchDecoder::Decode(
     UseCachedDecoderOut(*result, &decoder_out);
   } else {
     Ort::Value decoder_input = model_->BuildDecoderInput(*result);
-    decoder_out = model_->RunDecoder(std::move(decoder_input));
+    decoder_out = RunDecoder(std::move(decoder_input));
   }
 
   for (int32_t t = 0; t != num_frames; ++t) {
@@ -159,7 +159,7 @@ void OnlineTransducerGreedySearchDecoder::Decode(
     }
     if (emitted) {
       Ort::Value decoder_input = model_->BuildDecoderInput(*result);
-      decoder_out = model_->RunDecoder(std::move(decoder_input));
+      decoder_out = RunDecoder(std::move(decoder_input));
     }
   }
 
@@ -171,4 +171,13 @@ void OnlineTransducerGreedySearchDecoder::Decode(
   }
 }
 
+Ort::Value OnlineTransducerGreedySearchDecoder::RunDecoder(
+    Ort::Value decoder_input) const {
+  if (decoder_out_cache_) {
+    return decoder_out_cache_->Run(model_, std::move(decoder_input));
+  }
+
+  return model_->RunDecoder(std::move(decoder_input));
+}
+
 }  // namespace sherpa_onnx
@@ -7,6 +7,7 @@
 
 #include <vector>
 
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 
@@ -17,11 +18,14 @@ class OnlineTransducerGreedySearchDecoder : public OnlineTransducerDecoder {
   OnlineTransducerGreedySearchDecoder(OnlineTransducerModel *model,
                                       int32_t unk_id,
                                       float blank_penalty,
-                                      float temperature_scale)
+                                      float temperature_scale,
+                                      OnlineTransducerDecoderOutCache
+                                          *decoder_out_cache = nullptr)
       : model_(model),
       unk_id_(unk_id),
       blank_penalty_(blank_penalty),
-      temperature_scale_(temperature_scale) {}
+      temperature_scale_(temperature_scale),
+      decoder_out_cache_(decoder_out_cache) {}
 
   OnlineTransducerDecoderResult GetEmptyResult() const override;
 
@@ -30,11 +34,17 @@ class OnlineTransducerGreedySearchDecoder : public OnlineTransducerDecoder {
   void Decode(Ort::Value encoder_out,
               std::vector<OnlineTransducerDecoderResult> *result) override;
 
+ private:
+  Ort::Value RunDecoder(Ort::Value decoder_input) const;
+
  private:
   OnlineTransducerModel *model_;  // Not owned
   int32_t unk_id_;
   float blank_penalty_;
   float temperature_scale_;
+
+  // If not nullptr, the decoder output is looked up here first
+  OnlineTransducerDecoderOutCache *decoder_out_cache_;  // Not owned
 };
 
 }  // namespace sherpa_onnx
@@ -14,6 +14,10 @@ void OnlineTransducerModelConfig::Register(ParseOptions *po) {
   po->Register("encoder", &encoder, "Path to encoder.onnx");
   po->Register("decoder", &decoder, "Path to decoder.onnx");
   po->Register("joiner", &joiner, "Path to joiner.onnx");
+  po->Register("use-io-binding", &use_io_binding,
+               "true to run the decoder and joiner with IoBinding so that "
+               "their outputs are written into reused buffers. It reduces "
+               "memory allocations per chunk.");
 }
 
 bool OnlineTransducerModelConfig::Validate() const {
@@ -43,7 +47,8 @@ std::string OnlineTransducerModelConfig::ToString() const {
   os << "OnlineTransducerModelConfig(";
   os << "encoder=\"" << encoder << "\", ";
   os << "decoder=\"" << decoder << "\", ";
-  os << "joiner=\"" << joiner << "\")";
+  os << "joiner=\"" << joiner << "\", ";
+  os << "use_io_binding=" << (use_io_binding ? "True" : "False") << ")";
 
   return os.str();
 }
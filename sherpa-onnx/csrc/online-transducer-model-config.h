@@ -15,6 +15,12 @@ struct OnlineTransducerModelConfig {
   std::string decoder;
   std::string joiner;
 
+  // If true, the decoder and the joiner are run through Ort::IoBinding and
+  // their outputs are written into pre-allocated buffers that are reused
+  // across calls. Supported by zipformer, zipformer2, conformer, lstm and
+  // ebranchformer transducer models.
+  bool use_io_binding = false;
+
   OnlineTransducerModelConfig() = default;
   OnlineTransducerModelConfig(const std::string &encoder,
                               const std::string &decoder,
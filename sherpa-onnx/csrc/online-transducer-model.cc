@@ -26,6 +26,7 @@
 #include "sherpa-onnx/csrc/online-zipformer-transducer-model.h"
 #include "sherpa-onnx/csrc/online-zipformer2-transducer-model.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/session.h"
 
 namespace {
 
@@ -45,9 +46,7 @@ namespace sherpa_onnx {
 static ModelType GetModelType(char *model_data, size_t model_data_length,
                               bool debug) {
   Ort::Env env(ORT_LOGGING_LEVEL_ERROR);
-  Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(1);
-  sess_opts.SetInterOpNumThreads(1);
+  Ort::SessionOptions sess_opts = GetMetadataSessionOptions();
 
   auto sess = std::make_unique<Ort::Session>(env, model_data, model_data_length,
                                              sess_opts);
@@ -113,7 +112,7 @@ std::unique_ptr<OnlineTransducerModel> OnlineTransducerModel::Create(
   ModelType model_type = ModelType::kUnknown;
 
   {
-    auto buffer = ReadFile(config.transducer.encoder);
+    MappedFile buffer(config.transducer.encoder);
 
     model_type = GetModelType(buffer.data(), buffer.size(), config.debug);
   }
@@ -116,7 +116,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
     cur.reserve(batch_size);
 
     Ort::Value decoder_input = model_->BuildDecoderInput(prev);
-    Ort::Value decoder_out = model_->RunDecoder(std::move(decoder_input));
+    Ort::Value decoder_out = RunDecoder(std::move(decoder_input));
     if (t == 0) {
       UseCachedDecoderOut(hyps_row_splits, *result, &decoder_out);
     }
@@ -187,7 +187,7 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
+          new_hyp.AppendToken(new_token);
           new_hyp.timestamps.push_back(t + frame_offset);
           new_hyp.num_trailing_blanks = 0;
           if (ss != nullptr && ss[b]->GetContextGraph() != nullptr) {
@@ -197,7 +197,8 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
             new_hyp.context_state = std::get<1>(context_res);
           }
           if (lm_ && shallow_fusion_) {
-            lm_->ComputeLMScoreSF(lm_scale_, &new_hyp);
+            // The LM is run below for all streams at once
+            lm_->AddLMScoreSF(lm_scale_, &new_hyp);
           }
         } else {
           ++new_hyp.num_trailing_blanks;
@@ -238,10 +239,28 @@ void OnlineTransducerModifiedBeamSearchDecoder::Decode(
       cur.push_back(std::move(hyps));
       p_logprob += (end - start) * vocab_size;
     }  // for (int32_t b = 0; b != batch_size; ++b)
+
+    if (lm_ && shallow_fusion_) {
+      // Run the LM once on the new token of all surviving hyps of all streams
+      int32_t context_size = model_->ContextSize();
+      std::vector<Hypothesis *> lm_hyps;
+      for (auto &hyps : cur) {
+        for (auto &p : hyps) {
+          auto &h = p.second;
+          if (static_cast<int32_t>(h.ys.size()) - context_size >
+              h.cur_scored_pos) {
+            lm_hyps.push_back(&h);
+          }
+        }
+      }
+      ScopedStageTimer timer(stats_, OnlineRecognizerStage::kLM);
+      lm_->UpdateLMStatesSF(lm_hyps);
+    }
   }    // for (int32_t t = 0; t != num_frames; ++t)
 
   // classic lm rescore
   if (lm_ && !shallow_fusion_) {
+    ScopedStageTimer timer(stats_, OnlineRecognizerStage::kLM);
     lm_->ComputeLMScore(lm_scale_, model_->ContextSize(), &cur);
   }
 
@@ -264,7 +283,26 @@ void OnlineTransducerModifiedBeamSearchDecoder::UpdateDecoderOut(
     return;
   }
   Ort::Value decoder_input = model_->BuildDecoderInput({*result});
-  result->decoder_out = model_->RunDecoder(std::move(decoder_input));
+  Ort::Value decoder_out = RunDecoder(std::move(decoder_input));
+
+  if (decoder_out_cache_ || !use_io_binding_) {
+    // The output is owned by us, so no copy is needed
+    result->decoder_out = std::move(decoder_out);
+    return;
+  }
+
+  // With IoBinding, the output of RunDecoder() lives in a buffer that is
+  // reused by the next call, so we make a copy here.
+  result->decoder_out = Clone(model_->Allocator(), &decoder_out);
+}
+
+Ort::Value OnlineTransducerModifiedBeamSearchDecoder::RunDecoder(
+    Ort::Value decoder_input) const {
+  if (decoder_out_cache_) {
+    return decoder_out_cache_->Run(model_, std::move(decoder_input));
+  }
+
+  return model_->RunDecoder(std::move(decoder_input));
 }
 
 }  // namespace sherpa_onnx
@@ -9,7 +9,9 @@
 #include <vector>
 
 #include "sherpa-onnx/csrc/online-lm.h"
+#include "sherpa-onnx/csrc/online-recognizer-stats.h"
 #include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/online-transducer-decoder-out-cache.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/online-transducer-model.h"
 
@@ -25,7 +27,12 @@ class OnlineTransducerModifiedBeamSearchDecoder
                                             bool shallow_fusion,
                                             int32_t unk_id,
                                             float blank_penalty,
-                                            float temperature_scale)
+                                            float temperature_scale,
+                                            bool use_io_binding,
+                                            OnlineTransducerDecoderOutCache
+                                                *decoder_out_cache = nullptr,
+                                            OnlineRecognizerStatsCollector
+                                                *stats = nullptr)
       : model_(model),
         lm_(lm),
         max_active_paths_(max_active_paths),
@@ -33,7 +40,10 @@ class OnlineTransducerModifiedBeamSearchDecoder
         shallow_fusion_(shallow_fusion),
         unk_id_(unk_id),
         blank_penalty_(blank_penalty),
-        temperature_scale_(temperature_scale) {}
+        temperature_scale_(temperature_scale),
+        use_io_binding_(use_io_binding),
+        decoder_out_cache_(decoder_out_cache),
+        stats_(stats) {}
 
   OnlineTransducerDecoderResult GetEmptyResult() const override;
 
@@ -47,6 +57,9 @@ class OnlineTransducerModifiedBeamSearchDecoder
 
   void UpdateDecoderOut(OnlineTransducerDecoderResult *result) override;
 
+ private:
+  Ort::Value RunDecoder(Ort::Value decoder_input) const;
+
  private:
   OnlineTransducerModel *model_;  // Not owned
   OnlineLM *lm_;                  // Not owned
@@ -57,6 +70,15 @@ class OnlineTransducerModifiedBeamSearchDecoder
   int32_t unk_id_;
   float blank_penalty_;
   float temperature_scale_;
+
+  // True if the decoder output lives in a buffer reused by the next run
+  bool use_io_binding_;
+
+  // If not nullptr, the decoder output is looked up here first
+  OnlineTransducerDecoderOutCache *decoder_out_cache_;  // Not owned
+
+  // If not nullptr, the time spent in the LM is added to it
+  OnlineRecognizerStatsCollector *stats_;  // Not owned
 };
 
 }  // namespace sherpa_onnx
@@ -29,6 +29,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/run-in-parallel.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/transpose.h"
@@ -43,20 +44,16 @@ class OnlineTransducerNeMoModel::Impl {
         env_(ORT_LOGGING_LEVEL_ERROR),
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
-    {
-      auto buf = ReadFile(config.transducer.encoder);
-      InitEncoder(buf.data(), buf.size());
-    }
-
-    {
-      auto buf = ReadFile(config.transducer.decoder);
-      InitDecoder(buf.data(), buf.size());
-    }
+    // The decoder states depend on the meta data of the encoder, so they
+    // are initialized after all of the models are loaded.
+    LoadInParallel(
+        config.transducer.encoder, config.transducer.decoder,
+        config.transducer.joiner,
+        [this](void *data, size_t n) { InitEncoder(data, n); },
+        [this](void *data, size_t n) { InitDecoder(data, n); },
+        [this](void *data, size_t n) { InitJoiner(data, n); });
 
-    {
-      auto buf = ReadFile(config.transducer.joiner);
-      InitJoiner(buf.data(), buf.size());
-    }
+    InitDecoderStates();
   }
 
   template <typename Manager>
@@ -79,6 +76,8 @@ class OnlineTransducerNeMoModel::Impl {
       auto buf = ReadFile(mgr, config.transducer.joiner);
       InitJoiner(buf.data(), buf.size());
     }
+
+    InitDecoderStates();
   }
 
   std::vector<Ort::Value> RunEncoder(Ort::Value features,
@@ -291,8 +290,8 @@ class OnlineTransducerNeMoModel::Impl {
 
  private:
   void InitEncoder(void *model_data, size_t model_data_length) {
-    encoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                   &encoder_input_names_ptr_);
@@ -371,16 +370,14 @@ class OnlineTransducerNeMoModel::Impl {
   }
 
   void InitDecoder(void *model_data, size_t model_data_length) {
-    decoder_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                  sess_opts_);
 
     GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                   &decoder_input_names_ptr_);
 
     GetOutputNames(decoder_sess_.get(), &decoder_output_names_,
                    &decoder_output_names_ptr_);
-
-    InitDecoderStates();
   }
 
   void InitDecoderStates() {
@@ -400,8 +397,8 @@ class OnlineTransducerNeMoModel::Impl {
   }
 
   void InitJoiner(void *model_data, size_t model_data_length) {
-    joiner_sess_ = std::make_unique<Ort::Session>(
-        env_, model_data, model_data_length, sess_opts_);
+    joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                                 sess_opts_);
 
     GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                   &joiner_input_names_ptr_);
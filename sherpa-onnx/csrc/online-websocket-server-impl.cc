@@ -4,31 +4,52 @@
 
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/cpu-affinity.h"
 #include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/log.h"
+#include "sherpa-onnx/csrc/math.h"
+#include "sherpa-onnx/csrc/session.h"
+#include "sherpa-onnx/csrc/text-utils.h"
 
 namespace sherpa_onnx {
 
 void OnlineWebsocketDecoderConfig::Register(ParseOptions *po) {
   recognizer_config.Register(po);
 
-  po->Register("loop-interval-ms", &loop_interval_ms,
-               "It determines how often the decoder loop runs. ");
+  po->Register("max-wait-ms", &max_wait_ms,
+               "Max time in milliseconds a ready stream waits for other "
+               "streams to form a batch. A batch is dispatched once it "
+               "contains max-batch-size streams or its oldest stream has "
+               "waited for this amount of time. Use 0 to dispatch ready "
+               "streams immediately.");
 
   po->Register("max-batch-size", &max_batch_size,
                "Max batch size for recognition.");
 
   po->Register("end-tail-padding", &end_tail_padding,
                "It determines the length of tail_padding at the end of audio.");
+
+  po->Register("stats-interval-seconds", &stats_interval_seconds,
+               "If positive, log the latency statistics of the recognizer, "
+               "e.g., p50/p95/p99 latencies and real-time factor of each "
+               "stage of decoding, as JSON every this number of seconds. "
+               "The statistics are reset after each log. "
+               "Use 0 to disable it.");
 }
 
 void OnlineWebsocketDecoderConfig::Validate() const {
   recognizer_config.Validate();
-  SHERPA_ONNX_CHECK_GT(loop_interval_ms, 0);
+  SHERPA_ONNX_CHECK_GE(max_wait_ms, 0);
   SHERPA_ONNX_CHECK_GT(max_batch_size, 0);
   SHERPA_ONNX_CHECK_GT(end_tail_padding, 0);
+  SHERPA_ONNX_CHECK_GE(stats_interval_seconds, 0);
 }
 
 void OnlineWebsocketServerConfig::Register(sherpa_onnx::ParseOptions *po) {
@@ -37,17 +58,224 @@ void OnlineWebsocketServerConfig::Register(sherpa_onnx::ParseOptions *po) {
   po->Register("log-file", &log_file,
                "Path to the log file. Logs are "
                "appended to this file");
+
+  po->Register("num-work-threads", &num_work_threads,
+               "Number of threads of each replica for neural network "
+               "computation and decoding.");
+
+  po->Register("num-replicas", &num_replicas,
+               "Number of recognizer replicas. Each replica loads its own "
+               "copy of the model and has its own onnxruntime thread pools "
+               "and --num-work-threads work threads. A connection is "
+               "assigned to the replica with the fewest connections when it "
+               "is opened and stays there. Use it with --replica-cpus on "
+               "hosts with many cores.");
+
+  po->Register("replica-cpus", &replica_cpus,
+               "CPUs to bind the threads of each replica to. Either empty "
+               "for no binding, numa to bind replica i to NUMA node "
+               "i % number-of-nodes, or semicolon-separated CPU lists, one "
+               "per replica, e.g., 0-15;16-31. Only supported on Linux. "
+               "Remember to set --num-threads, i.e., the number of "
+               "onnxruntime intra-op threads, to at most the number of CPUs "
+               "of a replica. It cannot be used with the global "
+               "onnxruntime context, whose thread pools are shared by all "
+               "replicas.");
+
+  po->Register("max-queued-seconds", &max_queued_seconds,
+               "Max duration in seconds of the received audio of a "
+               "connection that is waiting for feature extraction. "
+               "See also --overflow-policy. Use 0 for no limit.");
+
+  po->Register("max-total-queued-seconds", &max_total_queued_seconds,
+               "Same as --max-queued-seconds, but summed over all "
+               "connections. Use 0 for no limit.");
+
+  po->Register("overflow-policy", &overflow_policy,
+               "What to do when a message exceeds --max-queued-seconds "
+               "or --max-total-queued-seconds. Valid values: pause, drop, "
+               "close. pause: stop reading from the client until the queue "
+               "is drained to half of the limit. drop: discard the message. "
+               "close: close the connection.");
+
+  po->Register("idle-timeout-seconds", &idle_timeout_seconds,
+               "Close a connection if we have neither received a message "
+               "from it nor sent a result to it for this number of "
+               "seconds. Use 0 to disable it.");
+
+  po->Register("sample-format", &sample_format,
+               "Format of the audio samples in binary messages from the "
+               "client. Valid values: float32, int16. Samples are in "
+               "little endian. float32 samples are normalized to the "
+               "range [-1, 1].");
+
+  po->Register("compute-features-on-io-threads",
+               &compute_features_on_io_threads,
+               "If true, the I/O threads compute features as soon as they "
+               "receive audio samples. Otherwise, samples are queued for "
+               "the work threads. It saves a hop between threads per "
+               "message at the cost of more work on the I/O threads. "
+               "--max-queued-seconds and --overflow-policy have no effect "
+               "if it is true since no samples are queued.");
 }
 
 void OnlineWebsocketServerConfig::Validate() const {
   decoder_config.Validate();
+
+  if (num_work_threads <= 0) {
+    SHERPA_ONNX_LOGE("Expect --num-work-threads > 0. Given: %d",
+                     num_work_threads);
+    exit(-1);
+  }
+
+  if (num_replicas <= 0) {
+    SHERPA_ONNX_LOGE("Expect --num-replicas > 0. Given: %d", num_replicas);
+    exit(-1);
+  }
+
+  if (!replica_cpus.empty() && HasOrtGlobalContext()) {
+    SHERPA_ONNX_LOGE(
+        "--replica-cpus=%s is given, but the global onnxruntime context is "
+        "enabled. Its thread pools are shared by all replicas and are not "
+        "bound to the CPUs of any replica.",
+        replica_cpus.c_str());
+    exit(-1);
+  }
+
+  if (replica_cpus == "numa") {
+    if (GetNumNumaNodes() == 0) {
+      SHERPA_ONNX_LOGE(
+          "--replica-cpus=numa is given, but NUMA nodes are not available "
+          "on this platform");
+      exit(-1);
+    }
+  } else if (!replica_cpus.empty()) {
+    std::vector<std::string> lists;
+    SplitStringToVector(replica_cpus, ";", false, &lists);
+    if (static_cast<int32_t>(lists.size()) != num_replicas) {
+      SHERPA_ONNX_LOGE(
+          "Expect one CPU list per replica in --replica-cpus. Number of "
+          "replicas: %d. Given: %s",
+          num_replicas, replica_cpus.c_str());
+      exit(-1);
+    }
+
+    for (const auto &l : lists) {
+      if (ParseCpuList(l).empty()) {
+        SHERPA_ONNX_LOGE("Invalid CPU list '%s' in --replica-cpus=%s",
+                         l.c_str(), replica_cpus.c_str());
+        exit(-1);
+      }
+    }
+  }
+
+  if (max_queued_seconds < 0) {
+    SHERPA_ONNX_LOGE("Expect --max-queued-seconds >= 0. Given: %f",
+                     max_queued_seconds);
+    exit(-1);
+  }
+
+  if (max_total_queued_seconds < 0) {
+    SHERPA_ONNX_LOGE("Expect --max-total-queued-seconds >= 0. Given: %f",
+                     max_total_queued_seconds);
+    exit(-1);
+  }
+
+  if (overflow_policy != "pause" && overflow_policy != "drop" &&
+      overflow_policy != "close") {
+    SHERPA_ONNX_LOGE(
+        "Expect --overflow-policy to be one of pause, drop, close. Given: %s",
+        overflow_policy.c_str());
+    exit(-1);
+  }
+
+  if (idle_timeout_seconds < 0) {
+    SHERPA_ONNX_LOGE("Expect --idle-timeout-seconds >= 0. Given: %d",
+                     idle_timeout_seconds);
+    exit(-1);
+  }
+
+  if (sample_format != "float32" && sample_format != "int16") {
+    SHERPA_ONNX_LOGE(
+        "Expect --sample-format to be one of float32, int16. Given: %s",
+        sample_format.c_str());
+    exit(-1);
+  }
+}
+
+std::vector<std::vector<int32_t>> OnlineWebsocketServerConfig::GetReplicaCpus()
+    const {
+  std::vector<std::vector<int32_t>> ans(num_replicas);
+  if (replica_cpus == "numa") {
+    int32_t num_nodes = GetNumNumaNodes();
+    for (int32_t i = 0; i != num_replicas; ++i) {
+      ans[i] = GetNumaNodeCpus(i % num_nodes);
+    }
+  } else if (!replica_cpus.empty()) {
+    std::vector<std::string> lists;
+    SplitStringToVector(replica_cpus, ";", false, &lists);
+    for (int32_t i = 0; i != num_replicas; ++i) {
+      ans[i] = ParseCpuList(lists[i]);
+    }
+  }
+
+  return ans;
+}
+
+static std::string CpusToString(const std::vector<int32_t> &cpus) {
+  if (cpus.empty()) {
+    return "all";
+  }
+
+  std::ostringstream os;
+  for (size_t i = 0; i != cpus.size(); ++i) {
+    os << (i ? "," : "") << cpus[i];
+  }
+  return os.str();
 }
 
-OnlineWebsocketDecoder::OnlineWebsocketDecoder(OnlineWebsocketServer *server)
+OnlineWebsocketDecoder::OnlineWebsocketDecoder(OnlineWebsocketServer *server,
+                                               int32_t replica,
+                                               std::vector<int32_t> cpus)
     : server_(server),
+      replica_(replica),
+      cpus_(std::move(cpus)),
       config_(server->GetConfig().decoder_config),
-      timer_(server->GetWorkContext()) {
+      timer_(io_work_),
+      stats_timer_(io_work_) {
+  // onnxruntime creates its intra-op threads when the model is loaded.
+  // They inherit the CPU binding of the calling thread.
+  ScopedThreadAffinity affinity(cpus_);
   recognizer_ = std::make_unique<OnlineRecognizer>(config_.recognizer_config);
+
+  SHERPA_ONNX_LOGE("Replica %d is created. CPUs: %s", replica_,
+                   CpusToString(cpus_).c_str());
+}
+
+OnlineWebsocketDecoder::~OnlineWebsocketDecoder() {
+  work_guard_.reset();
+  io_work_.stop();
+
+  for (auto &t : work_threads_) {
+    t.join();
+  }
+}
+
+void OnlineWebsocketDecoder::StartWorkThreads(int32_t num_threads) {
+  work_guard_ = std::make_unique<
+      asio::executor_work_guard<asio::io_context::executor_type>>(
+      asio::make_work_guard(io_work_));
+
+  for (int32_t i = 0; i != num_threads; ++i) {
+    work_threads_.emplace_back([this]() {
+      if (!cpus_.empty() && !SetThreadAffinity(cpus_)) {
+        SHERPA_ONNX_LOGE("Failed to bind a work thread of replica %d to %s",
+                         replica_, CpusToString(cpus_).c_str());
+      }
+
+      io_work_.run();
+    });
+  }
 }
 
 std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
@@ -59,149 +287,308 @@ std::shared_ptr<Connection> OnlineWebsocketDecoder::GetOrCreateConnection(
   } else {
     // create a new connection
     std::shared_ptr<OnlineStream> s = recognizer_->CreateStream();
-    auto c = std::make_shared<Connection>(hdl, s);
+
+    // 1 second of audio. It is large enough for the usual 10-100 ms
+    // messages; larger bursts go to Connection::overflow.
+    int32_t capacity = config_.recognizer_config.feat_config.sampling_rate;
+    auto c = std::make_shared<Connection>(hdl, s, replica_, capacity);
     connections_.insert({hdl, c});
     return c;
   }
 }
 
-void OnlineWebsocketDecoder::AcceptWaveform(std::shared_ptr<Connection> c) {
-  std::lock_guard<std::mutex> lock(c->mutex);
+void OnlineWebsocketDecoder::AcceptQueuedSamplesLocked(Connection *c) {
   float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
-  while (!c->samples.empty()) {
-    const auto &s = c->samples.front();
-    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
-    c->samples.pop_front();
+  int64_t n = 0;
+
+  // Samples are passed to the feature extractor directly from the ring
+  // buffer without copying
+  const float *p = nullptr;
+  int32_t k = 0;
+  while ((k = c->samples.Front(&p)) > 0) {
+    c->s->AcceptWaveform(sample_rate, p, k);
+    c->samples.Pop(k);
+    n += k;
+  }
+
+  // Since we hold c->mutex, the I/O thread cannot add to overflow now.
+  // Any samples it has put into overflow are newer than the ones we have
+  // consumed from the ring buffer above.
+  if (c->has_overflow.load(std::memory_order_acquire)) {
+    for (const auto &s : c->overflow) {
+      c->s->AcceptWaveform(sample_rate, s.data(), s.size());
+      n += s.size();
+    }
+    c->overflow.clear();
+    c->has_overflow.store(false, std::memory_order_release);
+  }
+
+  server_->OnSamplesConsumed(c, n);
+}
+
+void OnlineWebsocketDecoder::AcceptWaveform(std::shared_ptr<Connection> c) {
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    AcceptQueuedSamplesLocked(c.get());
   }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ScheduleLocked(c);
+  DispatchLocked();
 }
 
 void OnlineWebsocketDecoder::InputFinished(std::shared_ptr<Connection> c) {
-  std::lock_guard<std::mutex> lock(c->mutex);
+  {
+    std::lock_guard<std::mutex> lock(c->mutex);
+    if (c->eof) {
+      // The client has sent Done more than once
+      return;
+    }
 
-  float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+    AcceptQueuedSamplesLocked(c.get());
 
-  while (!c->samples.empty()) {
-    const auto &s = c->samples.front();
-    c->s->AcceptWaveform(sample_rate, s.data(), s.size());
-    c->samples.pop_front();
-  }
+    float sample_rate = config_.recognizer_config.feat_config.sampling_rate;
+    std::vector<float> tail_padding(
+        static_cast<int64_t>(config_.end_tail_padding * sample_rate));
 
-  std::vector<float> tail_padding(
-      static_cast<int64_t>(config_.end_tail_padding * sample_rate));
+    c->s->AcceptWaveform(sample_rate, tail_padding.data(),
+                         tail_padding.size());
 
-  c->s->AcceptWaveform(sample_rate, tail_padding.data(), tail_padding.size());
+    c->s->InputFinished();
+    c->eof = true;
+  }
 
-  c->s->InputFinished();
-  c->eof = true;
+  std::lock_guard<std::mutex> lock(mutex_);
+  ScheduleLocked(c);
+  DispatchLocked();
+}
+
+bool OnlineWebsocketDecoder::RemoveConnection(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // If the connection is still in the ready queue, it is skipped
+  // in DispatchLocked(). If it is being decoded, it is not rescheduled
+  // after decoding since it is no longer in connections_.
+  //
+  // A connection is removed from connections_ once it finishes decoding,
+  // so it is dropped if it is still there.
+  return connections_.erase(hdl) > 0;
 }
 
 void OnlineWebsocketDecoder::Warmup() const {
+  ScopedThreadAffinity affinity(cpus_);
   recognizer_->WarmpUpRecognizer(config_.recognizer_config.model_config.warm_up,
                                  config_.max_batch_size);
 }
 
 void OnlineWebsocketDecoder::Run() {
-  timer_.expires_after(std::chrono::milliseconds(config_.loop_interval_ms));
+  if (config_.stats_interval_seconds > 0) {
+    recognizer_->EnableStats();
 
-  timer_.async_wait(
-      [this](const asio::error_code &ec) { ProcessConnections(ec); });
+    stats_timer_.expires_after(
+        std::chrono::seconds(config_.stats_interval_seconds));
+    stats_timer_.async_wait(
+        [this](const asio::error_code &ec) { OnStatsTimer(ec); });
+  }
+
+  // Streams are scheduled when they become ready, so there is no
+  // polling loop to start. We only dispatch what might have been queued
+  // before the server started.
+  std::lock_guard<std::mutex> lock(mutex_);
+  DispatchLocked();
 }
 
-void OnlineWebsocketDecoder::ProcessConnections(const asio::error_code &ec) {
+void OnlineWebsocketDecoder::OnStatsTimer(const asio::error_code &ec) {
   if (ec) {
-    SHERPA_ONNX_LOG(FATAL) << "The decoder loop is aborted!";
+    SHERPA_ONNX_LOG(WARNING) << "The stats timer is aborted: " << ec.message();
+    return;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  std::vector<connection_hdl> to_remove;
-  for (auto &p : connections_) {
-    auto hdl = p.first;
-    auto c = p.second;
-
-    // The order of `if` below matters!
-    if (!server_->Contains(hdl)) {
-      // If the connection is disconnected, we stop processing it
-      to_remove.push_back(hdl);
-      continue;
-    }
+  auto stats = recognizer_->GetStats();
+  recognizer_->ResetStats();
 
-    if (active_.count(hdl)) {
-      // Another thread is decoding this stream, so skip it
-      continue;
-    }
+  float utilization = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    float elapsed = config_.stats_interval_seconds *
+                    server_->GetConfig().num_work_threads;
+    utilization = (busy_seconds_ - last_busy_seconds_) / elapsed;
+    last_busy_seconds_ = busy_seconds_;
+  }
 
-    if (!recognizer_->IsReady(c->s.get()) && !c->eof) {
-      // this stream has not enough frames to decode, so skip it
-      continue;
-    }
+  // Only log intervals with traffic to keep the log small
+  if (stats.num_batches > 0) {
+    SHERPA_ONNX_LOG(INFO) << "recognizer_stats replica " << replica_
+                          << " utilization " << utilization << " "
+                          << stats.ToString();
+  }
 
-    if (!recognizer_->IsReady(c->s.get()) && c->eof) {
-      // We won't receive samples from the client, so send a Done! to client
+  stats_timer_.expires_at(
+      stats_timer_.expiry() +
+      std::chrono::seconds(config_.stats_interval_seconds));
+  stats_timer_.async_wait(
+      [this](const asio::error_code &ec) { OnStatsTimer(ec); });
+}
 
-      asio::post(server_->GetWorkContext(),
-                 [this, hdl = c->hdl]() { server_->Send(hdl, "Done!"); });
+void OnlineWebsocketDecoder::ScheduleLocked(std::shared_ptr<Connection> c) {
+  auto it = connections_.find(c->hdl);
+  if (it == connections_.end() || it->second != c) {
+    // The connection has been removed
+    return;
+  }
 
-      to_remove.push_back(hdl);
-      continue;
-    }
+  // The order of `if` below matters!
+  if (!server_->Contains(c->hdl)) {
+    // If the connection is disconnected, we stop processing it
+    connections_.erase(it);
+    return;
+  }
 
-    // TODO(fangun): If the connection is timed out, we need to also
-    // add it to `to_remove`
+  if (active_.count(c->hdl)) {
+    // The stream is either in the ready queue or is being decoded by another
+    // thread. In the latter case, it is rescheduled after decoding.
+    return;
+  }
 
+  if (recognizer_->IsReady(c->s.get())) {
     // this stream has enough frames and is currently not processed by any
     // threads, so put it into the ready queue
+    c->ready_time = std::chrono::steady_clock::now();
     ready_connections_.push_back(c);
 
     // In `Decode()`, it will remove hdl from `active_`
     active_.insert(c->hdl);
+    return;
   }
 
-  for (auto hdl : to_remove) {
-    connections_.erase(hdl);
+  if (c->eof) {
+    // We won't receive samples from the client, so send a Done! to client
+    asio::post(server_->GetConnectionContext(),
+               [this, hdl = c->hdl]() { server_->Send(hdl, "Done!"); });
+
+    if (c->num_batches > 0) {
+      SHERPA_ONNX_LOG(INFO)
+          << "Queueing delay of a finished stream. Number of batches: "
+          << c->num_batches << ", average: "
+          << c->total_queue_delay_ms / c->num_batches
+          << " ms, max: " << c->max_queue_delay_ms << " ms\n";
+    }
+
+    connections_.erase(it);
   }
+  // Otherwise, this stream has not enough frames to decode. It is
+  // scheduled again once it receives more samples.
+}
+
+void OnlineWebsocketDecoder::DispatchLocked() {
+  using Clock = std::chrono::steady_clock;
 
-  if (!ready_connections_.empty()) {
-    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
+  auto max_wait = std::chrono::milliseconds(config_.max_wait_ms);
+
+  while (!ready_connections_.empty()) {
+    auto now = Clock::now();
+
+    // ready_connections_ is sorted by ready_time, so the front one has the
+    // earliest deadline
+    if (static_cast<int32_t>(ready_connections_.size()) <
+            config_.max_batch_size &&
+        now < ready_connections_.front()->ready_time + max_wait) {
+      break;
+    }
+
+    std::vector<std::shared_ptr<Connection>> c_vec;
+    while (!ready_connections_.empty() &&
+           static_cast<int32_t>(c_vec.size()) < config_.max_batch_size) {
+      auto c = ready_connections_.front();
+      ready_connections_.pop_front();
+
+      if (!connections_.count(c->hdl)) {
+        // The client is disconnected while waiting in the queue
+        active_.erase(c->hdl);
+        continue;
+      }
+
+      float delay_ms =
+          std::chrono::duration<float, std::milli>(now - c->ready_time)
+              .count();
+      c->num_batches += 1;
+      c->total_queue_delay_ms += delay_ms;
+      c->max_queue_delay_ms = std::max(c->max_queue_delay_ms, delay_ms);
+      server_->GetMetrics().OnQueueWait(delay_ms / 1000);
+
+      c_vec.push_back(std::move(c));
+    }
+
+    if (!c_vec.empty()) {
+      asio::post(io_work_,
+                 [this, c_vec = std::move(c_vec)]() { Decode(c_vec); });
+    }
+  }
+
+  server_->GetMetrics().SetQueueDepth(ready_connections_.size());
+
+  if (ready_connections_.empty()) {
+    return;
   }
 
-  // Schedule another call
-  timer_.expires_after(std::chrono::milliseconds(config_.loop_interval_ms));
+  // The batch is not full yet. Wait until the oldest stream reaches its
+  // deadline, unless the timer has already been armed for it.
+  auto expiry = ready_connections_.front()->ready_time + max_wait;
+  if (timer_armed_ && timer_expiry_ == expiry) {
+    return;
+  }
+
+  timer_armed_ = true;
+  timer_expiry_ = expiry;
 
-  timer_.async_wait(
-      [this](const asio::error_code &ec) { ProcessConnections(ec); });
+  // It cancels any pending wait, whose handler receives
+  // asio::error::operation_aborted
+  timer_.expires_at(expiry);
+  timer_.async_wait([this](const asio::error_code &ec) { OnTimer(ec); });
 }
 
-void OnlineWebsocketDecoder::Decode() {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (ready_connections_.empty()) {
-    // There are no connections that are ready for decoding,
-    // so we return directly
+void OnlineWebsocketDecoder::OnTimer(const asio::error_code &ec) {
+  if (ec == asio::error::operation_aborted) {
+    // The timer has been re-armed
     return;
   }
 
-  std::vector<std::shared_ptr<Connection>> c_vec;
-  std::vector<OnlineStream *> s_vec;
-  while (!ready_connections_.empty() &&
-         static_cast<int32_t>(s_vec.size()) < config_.max_batch_size) {
-    auto c = ready_connections_.front();
-    ready_connections_.pop_front();
+  if (ec) {
+    SHERPA_ONNX_LOG(FATAL) << "The decoder timer is aborted: " << ec.message();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  timer_armed_ = false;
+  DispatchLocked();
+}
 
-    c_vec.push_back(c);
+void OnlineWebsocketDecoder::Decode(
+    const std::vector<std::shared_ptr<Connection>> &c_vec) {
+  std::vector<OnlineStream *> s_vec;
+  s_vec.reserve(c_vec.size());
+  int64_t num_frames = 0;
+  for (const auto &c : c_vec) {
     s_vec.push_back(c->s.get());
+    num_frames -= c->s->GetNumProcessedFrames();
   }
 
-  if (!ready_connections_.empty()) {
-    // there are too many ready connections but this thread can only handle
-    // max_batch_size connections at a time, so we schedule another call
-    // to Decode() and let other threads to process the ready connections
-    asio::post(server_->GetWorkContext(), [this]() { Decode(); });
+  auto start = std::chrono::steady_clock::now();
+  recognizer_->DecodeStreams(s_vec.data(), s_vec.size());
+  auto end = std::chrono::steady_clock::now();
+
+  for (auto s : s_vec) {
+    num_frames += s->GetNumProcessedFrames();
   }
 
-  lock.unlock();
-  recognizer_->DecodeStreams(s_vec.data(), s_vec.size());
-  lock.lock();
+  float frame_shift_ms = config_.recognizer_config.feat_config.frame_shift_ms;
+  double seconds = std::chrono::duration<double>(end - start).count();
+  server_->GetMetrics().OnBatchDecoded(s_vec.size(), seconds,
+                                       num_frames * frame_shift_ms / 1000);
+  server_->GetMetrics().OnReplicaBusy(replica_, seconds);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  busy_seconds_ += seconds;
 
-  for (auto c : c_vec) {
+  for (const auto &c : c_vec) {
     auto result = recognizer_->GetResult(c->s.get());
     if (recognizer_->IsEndpoint(c->s.get())) {
       result.is_final = true;
@@ -218,20 +605,40 @@ void OnlineWebsocketDecoder::Decode() {
                  server_->Send(hdl, str);
                });
     active_.erase(c->hdl);
+
+    // The stream may have received enough samples while it was being
+    // decoded, so put it back into the ready queue if it is ready
+    ScheduleLocked(c);
   }
+
+  DispatchLocked();
 }
 
 OnlineWebsocketServer::OnlineWebsocketServer(
-    asio::io_context &io_conn, asio::io_context &io_work,
-    const OnlineWebsocketServerConfig &config)
+    asio::io_context &io_conn, const OnlineWebsocketServerConfig &config)
     : config_(config),
       io_conn_(io_conn),
-      io_work_(io_work),
       log_(config.log_file, std::ios::app),
       tee_(std::cout, log_),
-      decoder_(this) {
+      housekeeping_timer_(io_conn),
+      replica_connections_(config.num_replicas) {
   SetupLog();
 
+  auto replica_cpus = config_.GetReplicaCpus();
+  for (int32_t i = 0; i != config_.num_replicas; ++i) {
+    decoders_.push_back(
+        std::make_unique<OnlineWebsocketDecoder>(this, i, replica_cpus[i]));
+  }
+  metrics_.SetNumReplicas(config_.num_replicas, config_.num_work_threads);
+  if (config_.idle_timeout_seconds > 0) {
+    metrics_.EnableIdleTimeout();
+  }
+
+  float sample_rate = config_.decoder_config.recognizer_config.feat_config
+                          .sampling_rate;
+  max_queued_samples_ = config_.max_queued_seconds * sample_rate;
+  max_total_queued_samples_ = config_.max_total_queued_seconds * sample_rate;
+
   server_.init_asio(&io_conn_);
 
   server_.set_open_handler([this](connection_hdl hdl) { OnOpen(hdl); });
@@ -242,6 +649,8 @@ OnlineWebsocketServer::OnlineWebsocketServer(
       [this](connection_hdl hdl, server::message_ptr msg) {
         OnMessage(hdl, msg);
       });
+
+  server_.set_http_handler([this](connection_hdl hdl) { OnHttp(hdl); });
 }
 
 void OnlineWebsocketServer::Run(uint16_t port) {
@@ -253,7 +662,9 @@ void OnlineWebsocketServer::Run(uint16_t port) {
   const std::string &model_type = recognizer_config.model_config.model_type;
   if (0 < warm_up && warm_up < 100) {
     if (model_type == "zipformer2") {
-      decoder_.Warmup();
+      for (auto &d : decoders_) {
+        d->Warmup();
+      }
       SHERPA_ONNX_LOGE("Warm up completed : %d times.", warm_up);
     } else {
       SHERPA_ONNX_LOGE("Only Zipformer2 has warmup support for now.");
@@ -266,7 +677,177 @@ void OnlineWebsocketServer::Run(uint16_t port) {
     SHERPA_ONNX_LOGE("Invalid Warm up Value!. Expected 0 < warm_up < 100");
     exit(0);
   }
-  decoder_.Run();
+  for (auto &d : decoders_) {
+    d->Run();
+    d->StartWorkThreads(config_.num_work_threads);
+  }
+
+  if (config_.idle_timeout_seconds > 0 || config_.overflow_policy == "pause") {
+    housekeeping_timer_.expires_after(std::chrono::seconds(1));
+    housekeeping_timer_.async_wait(
+        [this](const asio::error_code &ec) { OnHousekeepingTimer(ec); });
+  }
+}
+
+void OnlineWebsocketServer::OnHousekeepingTimer(const asio::error_code &ec) {
+  if (ec) {
+    SHERPA_ONNX_LOG(WARNING) << "The housekeeping timer is aborted: "
+                             << ec.message();
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  auto idle_timeout = std::chrono::seconds(config_.idle_timeout_seconds);
+
+  std::vector<connection_hdl> to_close;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &p : connections_) {
+      Connection *c = p.second.get();
+
+      if (c->paused) {
+        // A connection may stay paused after draining its own queue if the
+        // total queue is still too large, so we check it here.
+        //
+        // A paused connection is not idle since it is us who stop reading
+        // from it.
+        MaybeResume(c);
+        continue;
+      }
+
+      if (config_.idle_timeout_seconds > 0 &&
+          now - c->last_active.load() > idle_timeout) {
+        to_close.push_back(p.first);
+      }
+    }
+  }
+
+  for (const auto &hdl : to_close) {
+    metrics_.OnConnectionTimedOut();
+
+    SHERPA_ONNX_LOG(INFO) << "Close a connection that is inactive for more "
+                          << "than " << config_.idle_timeout_seconds
+                          << " seconds";
+
+    websocketpp::lib::error_code ec;
+    server_.close(hdl, websocketpp::close::status::going_away, "Idle timeout",
+                  ec);
+  }
+
+  housekeeping_timer_.expires_at(housekeeping_timer_.expiry() +
+                                 std::chrono::seconds(1));
+  housekeeping_timer_.async_wait(
+      [this](const asio::error_code &ec) { OnHousekeepingTimer(ec); });
+}
+
+bool OnlineWebsocketServer::CanQueue(int64_t num_queued, int64_t n) const {
+  if (max_queued_samples_ > 0 && num_queued + n > max_queued_samples_) {
+    return false;
+  }
+
+  if (max_total_queued_samples_ > 0 &&
+      num_queued_samples_.load(std::memory_order_relaxed) + n >
+          max_total_queued_samples_) {
+    return false;
+  }
+
+  return true;
+}
+
+bool OnlineWebsocketServer::CanResume(int64_t num_queued) const {
+  // Resume at half of the limits so that we don't pause and resume
+  // the connection for every message
+  if (max_queued_samples_ > 0 && num_queued > max_queued_samples_ / 2) {
+    return false;
+  }
+
+  if (max_total_queued_samples_ > 0 &&
+      num_queued_samples_.load(std::memory_order_relaxed) >
+          max_total_queued_samples_ / 2) {
+    return false;
+  }
+
+  return true;
+}
+
+void OnlineWebsocketServer::OnSamplesConsumed(Connection *c, int64_t n) {
+  c->num_queued_samples.fetch_sub(n);
+  int64_t total = num_queued_samples_.fetch_sub(n) - n;
+  metrics_.SetQueuedBytes(total * sizeof(float));
+
+  MaybeResume(c);
+}
+
+void OnlineWebsocketServer::MaybeResume(Connection *c) {
+  if (!c->paused.load() || !CanResume(c->num_queued_samples.load())) {
+    return;
+  }
+
+  // Only one thread can win the exchange
+  if (!c->paused.exchange(false)) {
+    return;
+  }
+
+  c->last_active.store(std::chrono::steady_clock::now());
+
+  // websocketpp runs it in the strand of the connection, after the
+  // pause_reading() issued in OnMessage() that has set c->paused
+  websocketpp::lib::error_code ec;
+  server_.resume_reading(c->hdl, ec);
+}
+
+int32_t OnlineWebsocketServer::QueueSamples(Connection *c,
+                                            const std::string &payload) {
+  bool is_int16 = config_.sample_format == "int16";
+  int32_t num_samples =
+      payload.size() / (is_int16 ? sizeof(int16_t) : sizeof(float));
+
+  auto p_int16 = reinterpret_cast<const int16_t *>(payload.data());
+  auto p_float = reinterpret_cast<const float *>(payload.data());
+
+  // Fast path: decode the message into the ring buffer without locks.
+  // Once a message has gone to the overflow queue, later messages have to
+  // follow it there until the work thread drains it.
+  if (!c->has_overflow.load(std::memory_order_acquire)) {
+    bool ok = is_int16 ? c->samples.PushInt16(p_int16, num_samples)
+                       : c->samples.Push(p_float, num_samples);
+    if (ok) {
+      return num_samples;
+    }
+  }
+
+  std::vector<float> samples;
+  if (is_int16) {
+    samples.resize(num_samples);
+    VecInt16ToFloat(p_int16, num_samples, 1.0f / 32768, samples.data());
+  } else {
+    samples.assign(p_float, p_float + num_samples);
+  }
+
+  std::lock_guard<std::mutex> lock(c->mutex);
+  c->overflow.push_back(std::move(samples));
+  c->has_overflow.store(true, std::memory_order_release);
+
+  return num_samples;
+}
+
+void OnlineWebsocketServer::ComputeFeatures(Connection *c,
+                                            const std::string &payload) {
+  float sample_rate =
+      config_.decoder_config.recognizer_config.feat_config.sampling_rate;
+
+  if (config_.sample_format == "float32") {
+    c->s->AcceptWaveform(sample_rate,
+                         reinterpret_cast<const float *>(payload.data()),
+                         payload.size() / sizeof(float));
+    return;
+  }
+
+  // The samples are converted to float while they are fed to the feature
+  // extractor, so no intermediate float buffer is needed
+  c->s->AcceptWaveform(sample_rate,
+                       reinterpret_cast<const int16_t *>(payload.data()),
+                       payload.size() / sizeof(int16_t));
 }
 
 void OnlineWebsocketServer::SetupLog() {
@@ -280,34 +861,114 @@ void OnlineWebsocketServer::SetupLog() {
 }
 
 void OnlineWebsocketServer::Send(connection_hdl hdl, const std::string &text) {
-  websocketpp::lib::error_code ec;
-  if (!Contains(hdl)) {
-    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(hdl);
+    if (it == connections_.end()) {
+      return;
+    }
+
+    // Sending a result to the client also counts as activity
+    it->second->last_active.store(std::chrono::steady_clock::now());
   }
 
+  websocketpp::lib::error_code ec;
+
   server_.send(hdl, text, websocketpp::frame::opcode::text, ec);
   if (ec) {
     server_.get_alog().write(websocketpp::log::alevel::app, ec.message());
   }
 }
 
+int32_t OnlineWebsocketServer::SelectReplicaLocked() const {
+  return std::min_element(replica_connections_.begin(),
+                          replica_connections_.end()) -
+         replica_connections_.begin();
+}
+
 void OnlineWebsocketServer::OnOpen(connection_hdl hdl) {
+  int32_t replica = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    replica = SelectReplicaLocked();
+    replica_connections_[replica] += 1;
+  }
+
+  // Note: It has to be called without holding mutex_ since the decoder
+  // calls Contains() while holding its own lock.
+  auto c = decoders_[replica]->GetOrCreateConnection(hdl);
+
   std::lock_guard<std::mutex> lock(mutex_);
-  connections_.insert(hdl);
+  connections_.emplace(hdl, std::move(c));
+  metrics_.OnConnectionOpened();
+  metrics_.OnReplicaConnectionOpened(replica);
 
   std::ostringstream os;
   os << "New connection: "
      << server_.get_con_from_hdl(hdl)->get_remote_endpoint() << ". "
+     << "Replica: " << replica << ". "
      << "Number of active connections: " << connections_.size() << ".\n";
   SHERPA_ONNX_LOG(INFO) << os.str();
 }
 
 void OnlineWebsocketServer::OnClose(connection_hdl hdl) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  connections_.erase(hdl);
+  std::shared_ptr<Connection> c;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(hdl);
+    if (it != connections_.end()) {
+      c = std::move(it->second);
+      connections_.erase(it);
+
+      replica_connections_[c->replica] -= 1;
+      metrics_.OnReplicaConnectionClosed(c->replica);
+    }
+    metrics_.OnConnectionClosed();
+
+    SHERPA_ONNX_LOG(INFO) << "Number of active connections: "
+                          << connections_.size() << "\n";
+  }
+
+  if (c) {
+    SHERPA_ONNX_LOG(INFO) << "Peak queued audio of the closed connection: "
+                          << c->max_queued_samples * sizeof(float) / 1024
+                          << " KB. Dropped messages: "
+                          << c->num_dropped_messages << "\n";
+
+    // Discard samples that have not been consumed. We hold c->mutex so
+    // that we are the only consumer.
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->samples.Clear();
+    c->overflow.clear();
+    c->has_overflow.store(false);
+
+    int64_t n = c->num_queued_samples.exchange(0);
+    int64_t total = num_queued_samples_.fetch_sub(n) - n;
+    metrics_.SetQueuedBytes(total * sizeof(float));
+  }
+
+  // Note: It has to be called without holding mutex_ since the decoder
+  // calls Contains() while holding its own lock.
+  if (c && decoders_[c->replica]->RemoveConnection(hdl)) {
+    metrics_.OnConnectionDropped();
+  }
+}
+
+void OnlineWebsocketServer::OnHttp(connection_hdl hdl) {
+  auto con = server_.get_con_from_hdl(hdl);
+
+  // Ignore the query string, if any
+  std::string resource = con->get_resource();
+  resource = resource.substr(0, resource.find('?'));
 
-  SHERPA_ONNX_LOG(INFO) << "Number of active connections: "
-                        << connections_.size() << "\n";
+  if (resource == "/metrics") {
+    con->set_status(websocketpp::http::status_code::ok);
+    con->append_header("Content-Type", "text/plain; version=0.0.4");
+    con->set_body(metrics_.ToPrometheus());
+  } else {
+    con->set_status(websocketpp::http::status_code::not_found);
+    con->set_body("Not found. Supported endpoints: /metrics\n");
+  }
 }
 
 bool OnlineWebsocketServer::Contains(connection_hdl hdl) const {
@@ -317,27 +978,92 @@ bool OnlineWebsocketServer::Contains(connection_hdl hdl) const {
 
 void OnlineWebsocketServer::OnMessage(connection_hdl hdl,
                                       server::message_ptr msg) {
-  auto c = decoder_.GetOrCreateConnection(hdl);
+  std::shared_ptr<Connection> c;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(hdl);
+    if (it == connections_.end()) {
+      return;
+    }
+    c = it->second;
+  }
 
+  OnlineWebsocketDecoder *decoder = decoders_[c->replica].get();
   const std::string &payload = msg->get_payload();
 
   switch (msg->get_opcode()) {
     case websocketpp::frame::opcode::text:
-      if (payload == "Done") {
-        asio::post(io_work_, [this, c]() { decoder_.InputFinished(c); });
+      if (payload == "Done" && !c->done) {
+        c->done = true;
+        c->last_active.store(std::chrono::steady_clock::now());
+        asio::post(decoder->GetWorkContext(),
+                   [decoder, c]() { decoder->InputFinished(c); });
       }
       break;
     case websocketpp::frame::opcode::binary: {
-      auto p = reinterpret_cast<const float *>(payload.data());
-      int32_t num_samples = payload.size() / sizeof(float);
-      std::vector<float> samples(p, p + num_samples);
+      c->last_active.store(std::chrono::steady_clock::now());
+
+      if (c->done) {
+        // The client has sent Done. Ignore any audio after it.
+        break;
+      }
+
+      if (config_.compute_features_on_io_threads) {
+        ComputeFeatures(c.get(), payload);
+
+        // The work thread only needs to schedule it for decoding
+        asio::post(decoder->GetWorkContext(),
+                   [decoder, c]() { decoder->AcceptWaveform(c); });
+        break;
+      }
 
-      {
-        std::lock_guard<std::mutex> lock(c->mutex);
-        c->samples.push_back(std::move(samples));
+      int32_t bytes_per_sample =
+          config_.sample_format == "int16" ? sizeof(int16_t) : sizeof(float);
+      int32_t num_samples = payload.size() / bytes_per_sample;
+
+      if (!CanQueue(c->num_queued_samples.load(), num_samples)) {
+        if (config_.overflow_policy == "drop") {
+          c->num_dropped_messages += 1;
+          metrics_.OnMessageDropped();
+          break;
+        }
+
+        if (config_.overflow_policy == "close") {
+          metrics_.OnConnectionRejected();
+          Close(hdl, websocketpp::close::status::try_again_later,
+                "Too many queued samples");
+          break;
+        }
+
+        if (!c->paused.load()) {
+          SHERPA_ONNX_LOG(INFO)
+              << "Pause reading from a connection with "
+              << c->num_queued_samples.load() * sizeof(float) / 1024
+              << " KB of queued audio\n";
+
+          // c->paused is set before pause_reading() so that any
+          // resume_reading() triggered by it is run after pause_reading()
+          // in the strand of the connection
+          c->paused.store(true);
+          websocketpp::lib::error_code ec;
+          server_.pause_reading(hdl, ec);
+        }
       }
 
-      asio::post(io_work_, [this, c]() { decoder_.AcceptWaveform(c); });
+      // Count the samples before queueing them so that the counters never
+      // go negative when a work thread consumes them
+      int64_t num_queued = c->num_queued_samples.fetch_add(num_samples) +
+                           num_samples;
+      c->max_queued_samples = std::max(c->max_queued_samples, num_queued);
+
+      int64_t total =
+          num_queued_samples_.fetch_add(num_samples) + num_samples;
+      metrics_.SetQueuedBytes(total * sizeof(float));
+
+      QueueSamples(c.get(), payload);
+
+      asio::post(decoder->GetWorkContext(),
+                 [decoder, c]() { decoder->AcceptWaveform(c); });
       break;
     }
     default:
@@ -5,6 +5,8 @@
 #ifndef SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 #define SHERPA_ONNX_CSRC_ONLINE_WEBSOCKET_SERVER_IMPL_H_
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <deque>
 #include <fstream>
 #include <map>
@@ -12,6 +14,7 @@
 #include <mutex>  // NOLINT
 #include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -20,6 +23,8 @@
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/server-metrics.h"
+#include "sherpa-onnx/csrc/spsc-ring-buffer.h"
 #include "sherpa-onnx/csrc/tee-stream.h"
 #include "websocketpp/config/asio_no_tls.hpp"  // TODO(fangjun): support TLS
 #include "websocketpp/server.hpp"
@@ -33,49 +38,126 @@ struct Connection {
   connection_hdl hdl;
   std::shared_ptr<OnlineStream> s;
 
+  // Index of the recognizer replica that owns `s`. A connection stays with
+  // the same replica for its whole lifetime since the state of its stream
+  // lives there.
+  int32_t replica = 0;
+
   // set it to true when InputFinished() is called
-  bool eof = false;
+  std::atomic<bool> eof{false};
 
-  // The last time we received a message from the client
-  // TODO(fangjun): Use it to disconnect from a client if it is inactive
-  // for a specified time.
-  std::chrono::steady_clock::time_point last_active;
+  // set it to true when the I/O thread receives Done from the client.
+  // Only the I/O thread of this connection accesses it.
+  bool done = false;
 
-  std::mutex mutex;  // protect samples
+  // The last time we received a message from or sent a result to the client.
+  // The connection is closed if it is inactive for
+  // --idle-timeout-seconds seconds.
+  std::atomic<std::chrono::steady_clock::time_point> last_active;
 
   // Audio samples received from the client.
   //
-  // The I/O threads receive audio samples into this queue
-  // and invoke work threads to compute features
-  std::deque<std::vector<float>> samples;
+  // The I/O thread of this connection decodes messages into it without
+  // locks and the work thread holding `mutex` consumes them to compute
+  // features. Messages that do not fit go to `overflow`.
+  SpscRingBuffer samples;
+
+  // It serializes the work threads consuming `samples` and protects
+  // `overflow`. The I/O thread takes it only if `samples` is full.
+  std::mutex mutex;
+
+  // Messages that are received when `samples` is full. They are newer than
+  // the samples in `samples`. has_overflow is true if it is not empty.
+  std::deque<std::vector<float>> overflow;
+  std::atomic<bool> has_overflow{false};
+
+  // Number of samples in `samples` and `overflow`
+  std::atomic<int64_t> num_queued_samples{0};
+
+  // Peak of num_queued_samples. Only the I/O thread accesses it.
+  int64_t max_queued_samples = 0;
+
+  // Number of messages dropped because of --overflow-policy=drop.
+  // Only the I/O thread accesses it.
+  int32_t num_dropped_messages = 0;
+
+  // True if we have stopped reading from the client because too many
+  // samples are queued. See --overflow-policy=pause
+  std::atomic<bool> paused{false};
+
+  // The time when this connection was put into the ready queue.
+  // It is used to compute the queueing delay.
+  std::chrono::steady_clock::time_point ready_time;
 
-  Connection() = default;
-  Connection(connection_hdl hdl, std::shared_ptr<OnlineStream> s)
-      : hdl(hdl), s(s), last_active(std::chrono::steady_clock::now()) {}
+  // Number of times this connection has been put into a batch
+  int32_t num_batches = 0;
+
+  // Sum and max of the queueing delay, i.e., the time between the connection
+  // becomes ready and the time it is put into a batch, in milliseconds
+  float total_queue_delay_ms = 0;
+  float max_queue_delay_ms = 0;
+
+  /**
+   * @param replica  Index of the recognizer replica of this connection.
+   * @param ring_buffer_capacity  Capacity in samples of `samples`.
+   */
+  Connection(connection_hdl hdl, std::shared_ptr<OnlineStream> s,
+             int32_t replica, int32_t ring_buffer_capacity)
+      : hdl(hdl),
+        s(s),
+        replica(replica),
+        last_active(std::chrono::steady_clock::now()),
+        samples(ring_buffer_capacity) {}
 };
 
 struct OnlineWebsocketDecoderConfig {
   OnlineRecognizerConfig recognizer_config;
 
-  // It determines how often the decoder loop runs.
-  int32_t loop_interval_ms = 10;
+  // A batch is dispatched as soon as it contains max_batch_size streams
+  // or the oldest stream in it has waited for max_wait_ms milliseconds,
+  // whichever comes first.
+  int32_t max_wait_ms = 5;
 
   int32_t max_batch_size = 5;
 
   float end_tail_padding = 0.8;
 
+  // If positive, the latency statistics of the recognizer are logged
+  // as JSON every stats_interval_seconds seconds. 0 disables it.
+  int32_t stats_interval_seconds = 0;
+
   void Register(ParseOptions *po);
   void Validate() const;
 };
 
 class OnlineWebsocketServer;
 
+/** A replica of the recognizer with its own work threads.
+ *
+ * The server hosts one or more replicas. Each replica has its own
+ * OnlineRecognizer, whose onnxruntime sessions have their own intra-op
+ * thread pools, and its own io_context for its work threads, so replicas
+ * do not contend with each other. If the global onnxruntime context is
+ * enabled, all replicas share its thread pools instead.
+ */
 class OnlineWebsocketDecoder {
  public:
   /**
    * @param server  Not owned.
+   * @param replica  Index of this replica.
+   * @param cpus  If not empty, the work threads of this replica and the
+   *              intra-op threads of its recognizer are bound to these CPUs.
    */
-  explicit OnlineWebsocketDecoder(OnlineWebsocketServer *server);
+  OnlineWebsocketDecoder(OnlineWebsocketServer *server, int32_t replica,
+                         std::vector<int32_t> cpus);
+
+  // It stops and joins the work threads
+  ~OnlineWebsocketDecoder();
+
+  OnlineWebsocketDecoder(const OnlineWebsocketDecoder &) = delete;
+  OnlineWebsocketDecoder &operator=(const OnlineWebsocketDecoder &) = delete;
+
+  asio::io_context &GetWorkContext() { return io_work_; }
 
   std::shared_ptr<Connection> GetOrCreateConnection(connection_hdl hdl);
 
@@ -85,36 +167,93 @@ class OnlineWebsocketDecoder {
   // signal that there will be no more audio samples for a stream
   void InputFinished(std::shared_ptr<Connection> c);
 
+  /** It is called when the client of a connection is disconnected.
+   *
+   * @return Return true if the connection had not finished decoding.
+   */
+  bool RemoveConnection(connection_hdl hdl);
+
   void Warmup() const;
 
   void Run();
 
+  // Start num_threads work threads, which are bound to the CPUs of this
+  // replica
+  void StartWorkThreads(int32_t num_threads);
+
  private:
-  void ProcessConnections(const asio::error_code &ec);
+  /** Put the given connection into the ready queue if it has enough
+   * frames to decode and it is not being decoded by any thread.
+   *
+   * Caution: The caller must hold mutex_.
+   */
+  void ScheduleLocked(std::shared_ptr<Connection> c);
+
+  /** Form batches from the ready queue in the order of their deadlines.
+   * A batch is dispatched if it is full or if the oldest stream in it has
+   * reached its deadline. Otherwise, the timer is armed to fire at
+   * the deadline of the oldest stream.
+   *
+   * Caution: The caller must hold mutex_.
+   */
+  void DispatchLocked();
+
+  void OnTimer(const asio::error_code &ec);
+
+  /** Move the queued samples of c into its stream.
+   *
+   * Caution: The caller must hold c->mutex.
+   */
+  void AcceptQueuedSamplesLocked(Connection *c);
+
+  // Log the statistics of the recognizer and re-arm stats_timer_
+  void OnStatsTimer(const asio::error_code &ec);
 
   /** It is called by one of the worker thread.
    */
-  void Decode();
+  void Decode(const std::vector<std::shared_ptr<Connection>> &c_vec);
 
  private:
   OnlineWebsocketServer *server_;  // not owned
+  int32_t replica_;
+  std::vector<int32_t> cpus_;
+
+  // for neural network computation and decoding of this replica
+  asio::io_context io_work_;
+  std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>>
+      work_guard_;
+  std::vector<std::thread> work_threads_;
+
   std::unique_ptr<OnlineRecognizer> recognizer_;
   OnlineWebsocketDecoderConfig config_;
+  // It fires when the oldest stream in the ready queue reaches its deadline
   asio::steady_timer timer_;
+  bool timer_armed_ = false;
+  std::chrono::steady_clock::time_point timer_expiry_;
+
+  // It fires every config_.stats_interval_seconds seconds
+  asio::steady_timer stats_timer_;
 
-  // It protects `connections_`, `ready_connections_`, and `active_`
+  // It protects `connections_`, `ready_connections_`, `active_`,
+  // `busy_seconds_` and `timer_`
   std::mutex mutex_;
 
+  // Time the work threads have spent decoding, and its value when the
+  // statistics were logged last time
+  double busy_seconds_ = 0;
+  double last_busy_seconds_ = 0;
+
   std::map<connection_hdl, std::shared_ptr<Connection>,
            std::owner_less<connection_hdl>>
       connections_;
 
   // Whenever a connection has enough feature frames for decoding, we put
-  // it in this queue
+  // it in this queue. Connections are sorted by ready_time since they
+  // are always appended at the back.
   std::deque<std::shared_ptr<Connection>> ready_connections_;
 
-  // If we are decoding a stream, we put it in the active_ set so that
-  // only one thread can decode a stream at a time.
+  // If a stream is in the ready queue or we are decoding it, we put it in
+  // the active_ set so that only one thread can decode a stream at a time.
   std::set<connection_hdl, std::owner_less<connection_hdl>> active_;
 };
 
@@ -123,27 +262,76 @@ struct OnlineWebsocketServerConfig {
 
   std::string log_file = "./log.txt";
 
+  // Number of work threads of each replica
+  int32_t num_work_threads = 3;
+
+  // Number of recognizer replicas. Each replica loads its own copy of the
+  // model and has num_work_threads work threads.
+  int32_t num_replicas = 1;
+
+  // CPUs of each replica. It is either empty (no binding), "numa" (replica
+  // i is bound to NUMA node i % number of nodes), or semicolon-separated
+  // CPU lists, one per replica, e.g., "0-15;16-31".
+  std::string replica_cpus;
+
+  // Max duration in seconds of the audio samples of a connection that are
+  // received but not yet consumed by the feature extractor. 0 means no limit.
+  float max_queued_seconds = 10;
+
+  // Same as max_queued_seconds, but summed over all connections.
+  // 0 means no limit.
+  float max_total_queued_seconds = 0;
+
+  // What to do when a message exceeds one of the above limits:
+  //  - pause: accept the message and stop reading from the client until
+  //           the queue is drained to half of the limit
+  //  - drop: discard the message
+  //  - close: close the connection
+  std::string overflow_policy = "pause";
+
+  // Close a connection if we have neither received a message from it nor
+  // sent a result to it for this number of seconds. 0 disables it.
+  int32_t idle_timeout_seconds = 0;
+
+  // Format of the audio samples in binary messages from the client:
+  // float32 or int16, in little endian
+  std::string sample_format = "float32";
+
+  // If true, the I/O threads compute features as soon as they receive
+  // audio samples instead of queueing them for the work threads.
+  bool compute_features_on_io_threads = false;
+
   void Register(sherpa_onnx::ParseOptions *po);
   void Validate() const;
+
+  // Return the CPUs of each replica from replica_cpus. An empty list
+  // means the replica is not bound to any CPUs.
+  std::vector<std::vector<int32_t>> GetReplicaCpus() const;
 };
 
 class OnlineWebsocketServer {
  public:
   explicit OnlineWebsocketServer(asio::io_context &io_conn,  // NOLINT
-                                 asio::io_context &io_work,  // NOLINT
                                  const OnlineWebsocketServerConfig &config);
 
+  // It starts listening on the given port and starts the work threads of
+  // all replicas
   void Run(uint16_t port);
 
   const OnlineWebsocketServerConfig &GetConfig() const { return config_; }
   asio::io_context &GetConnectionContext() { return io_conn_; }
-  asio::io_context &GetWorkContext() { return io_work_; }
   server &GetServer() { return server_; }
+  ServerMetrics &GetMetrics() { return metrics_; }
 
   void Send(connection_hdl hdl, const std::string &text);
 
   bool Contains(connection_hdl hdl) const;
 
+  /** It is called by the decoder after it has moved n queued samples of c
+   * to the stream of c. It may resume reading from the client.
+   */
+  void OnSamplesConsumed(Connection *c, int64_t n);
+
  private:
   void SetupLog();
 
@@ -156,24 +344,76 @@ class OnlineWebsocketServer {
 
   void OnMessage(connection_hdl hdl, server::message_ptr msg);
 
+  // It resumes reading from paused connections whose queues have been
+  // drained and closes idle connections. It runs every second.
+  void OnHousekeepingTimer(const asio::error_code &ec);
+
+  // Return true if we can queue n more samples for a connection that
+  // already has num_queued samples
+  bool CanQueue(int64_t num_queued, int64_t n) const;
+
+  // Return true if a paused connection with num_queued samples can be
+  // resumed
+  bool CanResume(int64_t num_queued) const;
+
+  // Resume reading from c if it is paused and its queue is drained
+  void MaybeResume(Connection *c);
+
+  // Queue the samples in the given binary message for c.
+  // Return the number of samples.
+  int32_t QueueSamples(Connection *c, const std::string &payload);
+
+  // Compute features of the samples in the given binary message for c
+  // in the calling thread.
+  void ComputeFeatures(Connection *c, const std::string &payload);
+
+  // It handles plain HTTP requests. Only GET /metrics is supported, which
+  // returns metrics in the Prometheus text format.
+  void OnHttp(connection_hdl hdl);
+
   // Close a websocket connection with given code and reason
   void Close(connection_hdl hdl, websocketpp::close::status::value code,
              const std::string &reason);
 
+  /** Return the replica with the fewest connections.
+   *
+   * Caution: The caller must hold mutex_.
+   */
+  int32_t SelectReplicaLocked() const;
+
  private:
   OnlineWebsocketServerConfig config_;
   asio::io_context &io_conn_;
-  asio::io_context &io_work_;
   server server_;
 
   std::ofstream log_;
   sherpa_onnx::TeeStream tee_;
 
-  OnlineWebsocketDecoder decoder_;
+  ServerMetrics metrics_;
+
+  // It fires every second. See OnHousekeepingTimer()
+  asio::steady_timer housekeeping_timer_;
 
+  // Limits in number of samples. 0 means no limit.
+  int64_t max_queued_samples_ = 0;
+  int64_t max_total_queued_samples_ = 0;
+
+  // Number of queued samples summed over all connections
+  std::atomic<int64_t> num_queued_samples_{0};
+
+  // It protects connections_ and replica_connections_
   mutable std::mutex mutex_;
 
-  std::set<connection_hdl, std::owner_less<connection_hdl>> connections_;
+  std::map<connection_hdl, std::shared_ptr<Connection>,
+           std::owner_less<connection_hdl>>
+      connections_;
+
+  // replica_connections_[i] is the number of connections of replica i
+  std::vector<int32_t> replica_connections_;
+
+  // Declared last so that the work threads of the replicas, which use the
+  // members above, are joined before any of them is destroyed.
+  std::vector<std::unique_ptr<OnlineWebsocketDecoder>> decoders_;
 };
 
 }  // namespace sherpa_onnx
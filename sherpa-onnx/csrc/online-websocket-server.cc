@@ -2,10 +2,13 @@
 //
 // Copyright (c)  2022-2023  Xiaomi Corporation
 
+#include <string>
+
 #include "asio.hpp"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-websocket-server-impl.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
 
 static constexpr const char *kUsageMessage = R"(
 Automatic speech recognition with sherpa-onnx using websocket.
@@ -23,7 +26,22 @@ Usage:
   --joiner=/path/to/joiner.onnx \
   --log-file=./log.txt \
   --max-batch-size=5 \
-  --loop-interval-ms=10
+  --max-wait-ms=5
+
+On hosts with many cores, you can run several recognizer replicas, each
+bound to its own CPUs, e.g.,
+
+  --num-replicas=4 --replica-cpus=numa --num-threads=16 --num-work-threads=2
+
+Idle connections are kept open by default. To close a connection that
+has neither sent audio nor received a result for 60 seconds, use
+
+  --idle-timeout-seconds=60
+
+Metrics in the Prometheus text format are available over HTTP on the
+same port, e.g.,
+
+  curl http://localhost:6006/metrics
 
 Please refer to
 https://k2-fsa.github.io/sherpa/onnx/pretrained_models/index.html
@@ -41,18 +59,24 @@ int32_t main(int32_t argc, char *argv[]) {
   // size of the thread pool for handling network connections
   int32_t num_io_threads = 1;
 
-  // size of the thread pool for neural network computation and decoding
-  int32_t num_work_threads = 3;
-
   po.Register("num-io-threads", &num_io_threads,
               "Thread pool size for network connections.");
 
-  po.Register("num-work-threads", &num_work_threads,
-              "Thread pool size for for neural network "
-              "computation and decoding.");
-
   po.Register("port", &port, "The port on which the server will listen.");
 
+  std::string model_cache_dir;
+  po.Register("model-cache-dir", &model_cache_dir,
+              "If not empty, optimized models are cached in this existing "
+              "directory to speed up later startups. It overrides the "
+              "environment variable SHERPA_ONNX_MODEL_CACHE_DIR.");
+
+  // Streams are scheduled as soon as they are ready, so there is no
+  // decoding loop any longer. It is kept so that existing command lines
+  // still work.
+  int32_t loop_interval_ms = 0;
+  po.Register("loop-interval-ms", &loop_interval_ms,
+              "Deprecated and ignored. Use --max-wait-ms instead.");
+
   config.Register(&po);
 
   if (argc == 1) {
@@ -68,20 +92,31 @@ int32_t main(int32_t argc, char *argv[]) {
     exit(EXIT_FAILURE);
   }
 
+  if (loop_interval_ms != 0) {
+    SHERPA_ONNX_LOGE(
+        "--loop-interval-ms is deprecated and ignored. Please use "
+        "--max-wait-ms instead. Given: %d",
+        loop_interval_ms);
+  }
+
   config.Validate();
 
+  if (!model_cache_dir.empty()) {
+    sherpa_onnx::SetOptimizedModelCacheDir(model_cache_dir);
+  }
+
   asio::io_context io_conn;  // for network connections
-  asio::io_context io_work;  // for neural network and decoding
 
-  sherpa_onnx::OnlineWebsocketServer server(io_conn, io_work, config);
+  // Each recognizer replica of the server has its own work threads for
+  // neural network computation and decoding. They are started in Run().
+  sherpa_onnx::OnlineWebsocketServer server(io_conn, config);
   server.Run(port);
 
   SHERPA_ONNX_LOGE("Started!");
   SHERPA_ONNX_LOGE("Listening on: %d", port);
-  SHERPA_ONNX_LOGE("Number of work threads: %d", num_work_threads);
-
-  // give some work to do for the io_work pool
-  auto work_guard = asio::make_work_guard(io_work);
+  SHERPA_ONNX_LOGE("Number of replicas: %d", config.num_replicas);
+  SHERPA_ONNX_LOGE("Number of work threads per replica: %d",
+                   config.num_work_threads);
 
   std::vector<std::thread> io_threads;
 
@@ -90,20 +125,11 @@ int32_t main(int32_t argc, char *argv[]) {
     io_threads.emplace_back([&io_conn]() { io_conn.run(); });
   }
 
-  std::vector<std::thread> work_threads;
-  for (int32_t i = 0; i < num_work_threads; ++i) {
-    work_threads.emplace_back([&io_work]() { io_work.run(); });
-  }
-
   io_conn.run();
 
   for (auto &t : io_threads) {
     t.join();
   }
 
-  for (auto &t : work_threads) {
-    t.join();
-  }
-
   return 0;
 }
@@ -37,7 +37,7 @@ class OnlineZipformer2CtcModel::Impl {
         sess_opts_(GetSessionOptions(config)),
         allocator_{} {
     {
-      auto buf = ReadFile(config.zipformer2_ctc.model);
+      MappedFile buf(config.zipformer2_ctc.model);
       Init(buf.data(), buf.size());
     }
   }
@@ -246,8 +246,7 @@ class OnlineZipformer2CtcModel::Impl {
 
  private:
   void Init(void *model_data, size_t model_data_length) {
-    sess_ = std::make_unique<Ort::Session>(env_, model_data, model_data_length,
-                                           sess_opts_);
+    sess_ = CreateSession(env_, model_data, model_data_length, sess_opts_);
 
     GetInputNames(sess_.get(), &input_names_, &input_names_ptr_);
 
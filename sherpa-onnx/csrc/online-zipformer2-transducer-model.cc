@@ -29,6 +29,7 @@
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/online-transducer-decoder.h"
 #include "sherpa-onnx/csrc/onnx-utils.h"
+#include "sherpa-onnx/csrc/run-in-parallel.h"
 #include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/text-utils.h"
 #include "sherpa-onnx/csrc/unbind.h"
@@ -43,20 +44,12 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
       joiner_sess_opts_(GetSessionOptions(config, "joiner")),
       config_(config),
       allocator_{} {
-  {
-    auto buf = ReadFile(config.transducer.encoder);
-    InitEncoder(buf.data(), buf.size());
-  }
-
-  {
-    auto buf = ReadFile(config.transducer.decoder);
-    InitDecoder(buf.data(), buf.size());
-  }
-
-  {
-    auto buf = ReadFile(config.transducer.joiner);
-    InitJoiner(buf.data(), buf.size());
-  }
+  LoadInParallel(
+      config.transducer.encoder, config.transducer.decoder,
+      config.transducer.joiner,
+      [this](void *data, size_t n) { InitEncoder(data, n); },
+      [this](void *data, size_t n) { InitDecoder(data, n); },
+      [this](void *data, size_t n) { InitJoiner(data, n); });
 }
 
 template <typename Manager>
@@ -86,8 +79,8 @@ OnlineZipformer2TransducerModel::OnlineZipformer2TransducerModel(
 
 void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
                                                   size_t model_data_length) {
-  encoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, encoder_sess_opts_);
+  encoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                encoder_sess_opts_);
 
   GetInputNames(encoder_sess_.get(), &encoder_input_names_,
                 &encoder_input_names_ptr_);
@@ -153,8 +146,8 @@ void OnlineZipformer2TransducerModel::InitEncoder(void *model_data,
 
 void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
                                                   size_t model_data_length) {
-  decoder_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, decoder_sess_opts_);
+  decoder_sess_ = CreateSession(env_, model_data, model_data_length,
+                                decoder_sess_opts_);
 
   GetInputNames(decoder_sess_.get(), &decoder_input_names_,
                 &decoder_input_names_ptr_);
@@ -162,6 +155,12 @@ void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
   GetOutputNames(decoder_sess_.get(), &decoder_output_names_,
                  &decoder_output_names_ptr_);
 
+  if (config_.transducer.use_io_binding) {
+    decoder_runner_ = std::make_unique<IoBindingRunner>(
+        decoder_sess_.get(), decoder_input_names_ptr_,
+        decoder_output_names_ptr_);
+  }
+
   // get meta data
   Ort::ModelMetadata meta_data = decoder_sess_->GetModelMetadata();
   if (config_.debug) {
@@ -178,8 +177,8 @@ void OnlineZipformer2TransducerModel::InitDecoder(void *model_data,
 
 void OnlineZipformer2TransducerModel::InitJoiner(void *model_data,
                                                  size_t model_data_length) {
-  joiner_sess_ = std::make_unique<Ort::Session>(
-      env_, model_data, model_data_length, joiner_sess_opts_);
+  joiner_sess_ = CreateSession(env_, model_data, model_data_length,
+                               joiner_sess_opts_);
 
   GetInputNames(joiner_sess_.get(), &joiner_input_names_,
                 &joiner_input_names_ptr_);
@@ -187,6 +186,12 @@ void OnlineZipformer2TransducerModel::InitJoiner(void *model_data,
   GetOutputNames(joiner_sess_.get(), &joiner_output_names_,
                  &joiner_output_names_ptr_);
 
+  if (config_.transducer.use_io_binding) {
+    joiner_runner_ = std::make_unique<IoBindingRunner>(
+        joiner_sess_.get(), joiner_input_names_ptr_,
+        joiner_output_names_ptr_);
+  }
+
   // get meta data
   Ort::ModelMetadata meta_data = joiner_sess_->GetModelMetadata();
   if (config_.debug) {
@@ -474,6 +479,10 @@ OnlineZipformer2TransducerModel::RunEncoder(Ort::Value features,
 
 Ort::Value OnlineZipformer2TransducerModel::RunDecoder(
     Ort::Value decoder_input) {
+  if (decoder_runner_) {
+    return std::move(decoder_runner_->Run(&decoder_input, 1)[0]);
+  }
+
   auto decoder_out = decoder_sess_->Run(
       {}, decoder_input_names_ptr_.data(), &decoder_input, 1,
       decoder_output_names_ptr_.data(), decoder_output_names_ptr_.size());
@@ -484,6 +493,11 @@ Ort::Value OnlineZipformer2TransducerModel::RunJoiner(Ort::Value encoder_out,
                                                       Ort::Value decoder_out) {
   std::array<Ort::Value, 2> joiner_input = {std::move(encoder_out),
                                             std::move(decoder_out)};
+  if (joiner_runner_) {
+    return std::move(
+        joiner_runner_->Run(joiner_input.data(), joiner_input.size())[0]);
+  }
+
   auto logit =
       joiner_sess_->Run({}, joiner_input_names_ptr_.data(), joiner_input.data(),
                         joiner_input.size(), joiner_output_names_ptr_.data(),
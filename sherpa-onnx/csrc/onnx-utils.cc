@@ -123,6 +123,29 @@ void PrintModelMetadata(std::ostream &os, const Ort::ModelMetadata &meta_data) {
 #endif
 }
 
+int32_t GetElementSize(ONNXTensorElementDataType type) {
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+      return 4;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
+      return 8;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+      return 2;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+      return 1;
+    default:
+      return 0;  // unsupported
+  }
+}
+
 Ort::Value Clone(OrtAllocator *allocator, const Ort::Value *v) {
   auto type_and_shape = v->GetTensorTypeAndShapeInfo();
   std::vector<int64_t> shape = type_and_shape.GetShape();
@@ -323,6 +346,59 @@ Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
   return ans;
 }
 
+Ort::Value IndexSelectAxis0(OrtAllocator *allocator, const Ort::Value *v,
+                            const std::vector<int32_t> &indexes) {
+  std::vector<int64_t> shape = v->GetTensorTypeAndShapeInfo().GetShape();
+
+  int64_t inner_size = 1;
+  for (size_t i = 1; i < shape.size(); ++i) {
+    inner_size *= shape[i];
+  }
+
+  std::vector<int64_t> ans_shape = shape;
+  ans_shape[0] = indexes.size();
+
+  Ort::Value ans = Ort::Value::CreateTensor<float>(allocator, ans_shape.data(),
+                                                   ans_shape.size());
+
+  const float *src = v->GetTensorData<float>();
+  float *dst = ans.GetTensorMutableData<float>();
+
+  for (auto k : indexes) {
+    dst = std::copy(src + k * inner_size, src + (k + 1) * inner_size, dst);
+  }
+
+  return ans;
+}
+
+Ort::Value IndexSelectAxis1(OrtAllocator *allocator, const Ort::Value *v,
+                            const std::vector<int32_t> &indexes) {
+  std::vector<int64_t> shape = v->GetTensorTypeAndShapeInfo().GetShape();
+
+  int64_t inner_size = 1;
+  for (size_t i = 2; i < shape.size(); ++i) {
+    inner_size *= shape[i];
+  }
+
+  std::vector<int64_t> ans_shape = shape;
+  ans_shape[1] = indexes.size();
+
+  Ort::Value ans = Ort::Value::CreateTensor<float>(allocator, ans_shape.data(),
+                                                   ans_shape.size());
+
+  const float *src = v->GetTensorData<float>();
+  float *dst = ans.GetTensorMutableData<float>();
+
+  for (int64_t i = 0; i != shape[0]; ++i) {
+    const float *p = src + i * shape[1] * inner_size;
+    for (auto k : indexes) {
+      dst = std::copy(p + k * inner_size, p + (k + 1) * inner_size, dst);
+    }
+  }
+
+  return ans;
+}
+
 CopyableOrtValue::CopyableOrtValue(const CopyableOrtValue &other) {
   *this = other;
 }
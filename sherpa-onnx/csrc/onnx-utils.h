@@ -60,6 +60,10 @@ std::string LookupCustomModelMetaData(const Ort::ModelMetadata &meta_data,
 void PrintModelMetadata(std::ostream &os,
                         const Ort::ModelMetadata &meta_data);  // NOLINT
 
+// Return the number of bytes of an element of the given type.
+// Return 0 if the type is not supported.
+int32_t GetElementSize(ONNXTensorElementDataType type);
+
 // Return a deep copy of v
 Ort::Value Clone(OrtAllocator *allocator, const Ort::Value *v);
 
@@ -92,6 +96,26 @@ void Fill(Ort::Value *tensor, T value) {
   std::fill(p, p + n, value);
 }
 
+/** Select entries along axis 0 of a float tensor.
+ *
+ * @param v  A float tensor of shape (d0, ...) with at least 1 axis.
+ * @param indexes  Indexes into axis 0 of v. They may repeat.
+ *
+ * @return Return a tensor of shape (indexes.size(), ...)
+ */
+Ort::Value IndexSelectAxis0(OrtAllocator *allocator, const Ort::Value *v,
+                            const std::vector<int32_t> &indexes);
+
+/** Select entries along axis 1 of a float tensor.
+ *
+ * @param v  A float tensor of shape (d0, d1, ...) with at least 2 axes.
+ * @param indexes  Indexes into axis 1 of v. They may repeat.
+ *
+ * @return Return a tensor of shape (d0, indexes.size(), ...)
+ */
+Ort::Value IndexSelectAxis1(OrtAllocator *allocator, const Ort::Value *v,
+                            const std::vector<int32_t> &indexes);
+
 // TODO(fangjun): Document it
 Ort::Value Repeat(OrtAllocator *allocator, Ort::Value *cur_encoder_out,
                   const std::vector<int32_t> &hyps_num_split);
@@ -189,7 +189,7 @@ class OnlineRecognizerCtcRknnImpl : public OnlineRecognizerImpl {
 
     decoder_->Decode(p.first.data(), attr.dims[0], attr.dims[1], attr.dims[2],
                      &results, reinterpret_cast<OnlineStream **>(&s), 1);
-    s->SetCtcResult(results[0]);
+    s->SetCtcResult(std::move(results[0]));
   }
 
  private:
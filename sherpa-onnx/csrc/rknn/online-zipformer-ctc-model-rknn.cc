@@ -38,7 +38,7 @@ class OnlineZipformerCtcModelRknn::Impl {
 
   explicit Impl(const OnlineModelConfig &config) : config_(config) {
     {
-      auto buf = ReadFile(config.zipformer2_ctc.model);
+      MappedFile buf(config.zipformer2_ctc.model);
       Init(buf.data(), buf.size());
     }
 
@@ -48,17 +48,17 @@ class OnlineZipformerTransducerModelRknn::Impl {
 
   explicit Impl(const OnlineModelConfig &config) : config_(config) {
     {
-      auto buf = ReadFile(config.transducer.encoder);
+      MappedFile buf(config.transducer.encoder);
       InitEncoder(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.transducer.decoder);
+      MappedFile buf(config.transducer.decoder);
       InitDecoder(buf.data(), buf.size());
     }
 
     {
-      auto buf = ReadFile(config.transducer.joiner);
+      MappedFile buf(config.transducer.joiner);
       InitJoiner(buf.data(), buf.size());
     }
 
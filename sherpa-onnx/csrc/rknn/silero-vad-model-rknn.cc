@@ -37,7 +37,7 @@ class SileroVadModelRknn::Impl {
 
   explicit Impl(const VadModelConfig &config)
       : config_(config), sample_rate_(config.sample_rate) {
-    auto buf = ReadFile(config.silero_vad.model);
+    MappedFile buf(config.silero_vad.model);
     Init(buf.data(), buf.size());
 
     SetCoreMask(ctx_, config_.num_threads);
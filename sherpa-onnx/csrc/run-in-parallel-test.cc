@@ -0,0 +1,95 @@
+// sherpa-onnx/csrc/run-in-parallel-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/run-in-parallel.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(RunInParallel, AllTasksRun) {
+  for (int32_t max_num_threads : {0, 1, 2, 3, 8}) {
+    std::vector<int32_t> done(10, 0);
+    std::vector<std::function<void()>> tasks;
+    for (int32_t i = 0; i != static_cast<int32_t>(done.size()); ++i) {
+      tasks.emplace_back([&done, i]() { done[i] += 1; });
+    }
+
+    RunInParallel(tasks, max_num_threads);
+
+    EXPECT_EQ(done, std::vector<int32_t>(done.size(), 1)) << max_num_threads;
+  }
+
+  RunInParallel({});
+}
+
+// All tasks must run at the same time to finish, so it hangs if they
+// are run one after another
+TEST(RunInParallel, Concurrent) {
+  std::atomic<int32_t> arrived{0};
+  auto task = [&arrived]() {
+    arrived += 1;
+    while (arrived < 3) {
+    }
+  };
+
+  RunInParallel({task, task, task}, 3);
+  EXPECT_EQ(arrived, 3);
+}
+
+TEST(RunInParallel, Exception) {
+  std::atomic<int32_t> num_done{0};
+  std::vector<std::function<void()>> tasks = {
+      [&num_done]() { num_done += 1; },
+      []() { throw std::runtime_error("first"); },
+      []() { throw std::logic_error("second"); },
+      [&num_done]() { num_done += 1; },
+  };
+
+  for (int32_t max_num_threads : {1, 4}) {
+    num_done = 0;
+    try {
+      RunInParallel(tasks, max_num_threads);
+      FAIL() << "No exception is thrown";
+    } catch (const std::runtime_error &e) {
+      EXPECT_STREQ(e.what(), "first");
+    }
+    EXPECT_EQ(num_done, 2);
+  }
+}
+
+TEST(LoadInParallel, Files) {
+  std::vector<std::string> filenames = {"encoder.tmp", "decoder.tmp",
+                                        "joiner.tmp"};
+  for (const auto &f : filenames) {
+    std::ofstream os(f, std::ios::binary);
+    os << "model " << f;
+  }
+
+  std::vector<std::string> loaded(filenames.size());
+  auto init = [&loaded](int32_t i) {
+    return [&loaded, i](void *model_data, size_t model_data_length) {
+      loaded[i].assign(static_cast<const char *>(model_data),
+                       model_data_length);
+    };
+  };
+
+  LoadInParallel(filenames[0], filenames[1], filenames[2], init(0), init(1),
+                 init(2));
+
+  for (int32_t i = 0; i != static_cast<int32_t>(filenames.size()); ++i) {
+    EXPECT_EQ(loaded[i], "model " + filenames[i]);
+    std::remove(filenames[i].c_str());
+  }
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,89 @@
+// sherpa-onnx/csrc/run-in-parallel.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/run-in-parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sherpa-onnx/csrc/file-utils.h"
+
+namespace sherpa_onnx {
+
+// Loading models is mostly bound by memory bandwidth and graph
+// optimization, so a few threads are enough
+static constexpr int32_t kDefaultMaxNumThreads = 4;
+
+void RunInParallel(const std::vector<std::function<void()>> &tasks,
+                   int32_t max_num_threads /*= 0*/) {
+  int32_t num_tasks = static_cast<int32_t>(tasks.size());
+
+  if (max_num_threads <= 0) {
+    int32_t num_cores =
+        static_cast<int32_t>(std::thread::hardware_concurrency());
+    max_num_threads = std::min(kDefaultMaxNumThreads, std::max(num_cores, 1));
+  }
+
+  int32_t num_threads = std::min(num_tasks, max_num_threads);
+  if (num_threads == 0) {
+    return;
+  }
+
+  std::atomic<int32_t> next{0};
+  std::vector<std::exception_ptr> errors(num_tasks);
+
+  auto worker = [&tasks, &next, &errors, num_tasks]() {
+    for (int32_t i = next++; i < num_tasks; i = next++) {
+      try {
+        tasks[i]();
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int32_t i = 1; i != num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  // The calling thread is also a worker
+  worker();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  for (const auto &e : errors) {
+    if (e) {
+      std::rethrow_exception(e);
+    }
+  }
+}
+
+void LoadInParallel(const std::string &encoder, const std::string &decoder,
+                    const std::string &joiner,
+                    const ModelInitializer &init_encoder,
+                    const ModelInitializer &init_decoder,
+                    const ModelInitializer &init_joiner) {
+  auto load = [](const std::string &filename, const ModelInitializer &init) {
+    return [&filename, &init]() {
+      MappedFile buf(filename);
+      init(buf.data(), buf.size());
+    };
+  };
+
+  RunInParallel({
+      load(encoder, init_encoder),
+      load(decoder, init_decoder),
+      load(joiner, init_joiner),
+  });
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,52 @@
+// sherpa-onnx/csrc/run-in-parallel.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_RUN_IN_PARALLEL_H_
+#define SHERPA_ONNX_CSRC_RUN_IN_PARALLEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** Run independent tasks concurrently and wait for all of them to finish.
+ *
+ * It is used at startup to, e.g., create the encoder, decoder and joiner
+ * sessions of a model at the same time. The tasks run on a small pool of
+ * at most max_num_threads threads, one of which is the calling thread.
+ *
+ * If a task throws, the remaining tasks are still run and the exception
+ * of the first failed task (in the order of tasks) is rethrown after all
+ * tasks have finished.
+ *
+ * @param tasks  Tasks to run. They must not depend on each other.
+ * @param max_num_threads  Max number of threads to use. If it is less than
+ *                         or equal to 0, min(4, number of CPU cores) is used.
+ */
+void RunInParallel(const std::vector<std::function<void()>> &tasks,
+                   int32_t max_num_threads = 0);
+
+using ModelInitializer =
+    std::function<void(void *model_data, size_t model_data_length)>;
+
+/** Load the encoder, decoder and joiner of a transducer model.
+ *
+ * The three models are independent of each other, so their files are
+ * mapped and their sessions are created concurrently with RunInParallel()
+ * to reduce the startup time.
+ *
+ * @param encoder  Path to the encoder model. It is passed to init_encoder.
+ * @param decoder  Path to the decoder model. It is passed to init_decoder.
+ * @param joiner  Path to the joiner model. It is passed to init_joiner.
+ */
+void LoadInParallel(const std::string &encoder, const std::string &decoder,
+                    const std::string &joiner,
+                    const ModelInitializer &init_encoder,
+                    const ModelInitializer &init_decoder,
+                    const ModelInitializer &init_joiner);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_RUN_IN_PARALLEL_H_
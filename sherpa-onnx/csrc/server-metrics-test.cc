@@ -0,0 +1,112 @@
+// sherpa-onnx/csrc/server-metrics-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/server-metrics.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(PrometheusHistogram, Write) {
+  PrometheusHistogram h({1, 2, 4});
+  h.Observe(1);
+  h.Observe(1.5);
+  h.Observe(3);
+  h.Observe(100);
+
+  EXPECT_EQ(h.Count(), 4);
+  EXPECT_NEAR(h.Sum(), 105.5, 1e-9);
+
+  std::ostringstream os;
+  h.Write("x", "help", os);
+
+  std::string expected = R"(# HELP x help
+# TYPE x histogram
+x_bucket{le="1"} 1
+x_bucket{le="2"} 2
+x_bucket{le="4"} 3
+x_bucket{le="+Inf"} 4
+x_sum 105.5
+x_count 4
+)";
+  EXPECT_EQ(os.str(), expected);
+}
+
+TEST(ServerMetrics, ToPrometheus) {
+  ServerMetrics m;
+  m.OnConnectionOpened();
+  m.OnConnectionOpened();
+  m.OnConnectionClosed();
+  m.OnConnectionDropped();
+  m.SetQueueDepth(3);
+  m.OnQueueWait(0.002);
+  m.OnBatchDecoded(2, 0.05, 0.5);
+  m.OnBatchDecoded(4, 0.15, 1.5);
+
+  std::string s = m.ToPrometheus();
+
+  EXPECT_NE(s.find("\nsherpa_onnx_connections_total 2\n"), std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_active_connections 1\n"), std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_dropped_connections_total 1\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_ready_queue_depth 3\n"), std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_batch_size_bucket{le=\"2\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_batch_size_bucket{le=\"4\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_decode_latency_seconds_count 2\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_queue_wait_seconds_count 1\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_decoded_audio_seconds_total 2\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_real_time_factor 0.1\n"), std::string::npos);
+
+#if defined(__linux__)
+  EXPECT_NE(s.find("\nprocess_resident_memory_bytes "), std::string::npos);
+#endif
+
+  // Per-replica metrics are not exported unless there are replicas
+  EXPECT_EQ(s.find("sherpa_onnx_replica_"), std::string::npos);
+
+  // Nor are timed out connections unless the idle timeout is enabled
+  EXPECT_EQ(s.find("sherpa_onnx_timed_out_connections_total"),
+            std::string::npos);
+
+  m.EnableIdleTimeout();
+  m.OnConnectionTimedOut();
+  s = m.ToPrometheus();
+  EXPECT_NE(s.find("\nsherpa_onnx_timed_out_connections_total 1\n"),
+            std::string::npos);
+}
+
+TEST(ServerMetrics, Replicas) {
+  ServerMetrics m;
+  m.SetNumReplicas(2, 3);
+  m.OnReplicaConnectionOpened(0);
+  m.OnReplicaConnectionOpened(1);
+  m.OnReplicaConnectionOpened(1);
+  m.OnReplicaConnectionClosed(0);
+  m.OnReplicaBusy(1, 0.25);
+  m.OnReplicaBusy(1, 0.5);
+
+  std::string s = m.ToPrometheus();
+
+  EXPECT_NE(s.find("\nsherpa_onnx_replica_work_threads 3\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_replica_active_connections{replica=\"0\"} "
+                   "0\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_replica_active_connections{replica=\"1\"} "
+                   "2\n"),
+            std::string::npos);
+  EXPECT_NE(s.find("\nsherpa_onnx_replica_busy_seconds_total{replica=\"1\"} "
+                   "0.75\n"),
+            std::string::npos);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,318 @@
+// sherpa-onnx/csrc/server-metrics.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/server-metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+namespace sherpa_onnx {
+
+PrometheusHistogram::PrometheusHistogram(std::vector<double> upper_bounds)
+    : upper_bounds_(std::move(upper_bounds)),
+      counts_(upper_bounds_.size() + 1) {}
+
+void PrometheusHistogram::Observe(double v) {
+  // Index of the first bucket whose upper bound is >= v
+  int32_t i = static_cast<int32_t>(
+      std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), v) -
+      upper_bounds_.begin());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  counts_[i] += 1;
+  sum_ += v;
+}
+
+int64_t PrometheusHistogram::Count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t ans = 0;
+  for (auto c : counts_) {
+    ans += c;
+  }
+  return ans;
+}
+
+double PrometheusHistogram::Sum() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sum_;
+}
+
+void PrometheusHistogram::Write(const std::string &name,
+                                const std::string &help,
+                                std::ostream &os) const {
+  std::vector<int64_t> counts;
+  double sum = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counts = counts_;
+    sum = sum_;
+  }
+
+  os << "# HELP " << name << " " << help << "\n";
+  os << "# TYPE " << name << " histogram\n";
+
+  // Buckets are cumulative in the Prometheus format
+  int64_t acc = 0;
+  for (size_t i = 0; i != upper_bounds_.size(); ++i) {
+    acc += counts[i];
+    os << name << "_bucket{le=\"" << upper_bounds_[i] << "\"} " << acc << "\n";
+  }
+  acc += counts.back();
+  os << name << "_bucket{le=\"+Inf\"} " << acc << "\n";
+  os << name << "_sum " << sum << "\n";
+  os << name << "_count " << acc << "\n";
+}
+
+static void WriteMetric(const std::string &name, const std::string &type,
+                        const std::string &help, double value,
+                        std::ostream &os) {
+  os << "# HELP " << name << " " << help << "\n";
+  os << "# TYPE " << name << " " << type << "\n";
+  os << name << " " << value << "\n";
+}
+
+static void WriteReplicaMetric(const std::string &name,
+                               const std::string &type,
+                               const std::string &help,
+                               const std::vector<double> &values,
+                               std::ostream &os) {
+  os << "# HELP " << name << " " << help << "\n";
+  os << "# TYPE " << name << " " << type << "\n";
+  for (size_t i = 0; i != values.size(); ++i) {
+    os << name << "{replica=\"" << i << "\"} " << values[i] << "\n";
+  }
+}
+
+ServerMetrics::ServerMetrics()
+    : batch_size_({1, 2, 4, 8, 16, 32, 64, 128}),
+      decode_latency_({0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25,
+                       0.5, 1, 2.5, 5, 10}),
+      queue_wait_({0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1,
+                   2.5, 5, 10}) {}
+
+void ServerMetrics::OnConnectionOpened() {
+  connections_total_.fetch_add(1, std::memory_order_relaxed);
+  active_connections_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnConnectionClosed() {
+  active_connections_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnConnectionDropped() {
+  dropped_connections_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnConnectionRejected() {
+  rejected_connections_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::EnableIdleTimeout() {
+  idle_timeout_enabled_.store(true, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnConnectionTimedOut() {
+  timed_out_connections_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnMessageDropped() {
+  dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::SetQueueDepth(int32_t n) {
+  queue_depth_.store(n, std::memory_order_relaxed);
+}
+
+void ServerMetrics::SetQueuedBytes(int64_t n) {
+  queued_bytes_.store(n, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnQueueWait(double seconds) {
+  queue_wait_.Observe(seconds);
+}
+
+void ServerMetrics::OnBatchDecoded(int32_t batch_size, double seconds,
+                                   double audio_seconds) {
+  batch_size_.Observe(batch_size);
+  decode_latency_.Observe(seconds);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  decode_seconds_ += seconds;
+  audio_seconds_ += audio_seconds;
+}
+
+void ServerMetrics::SetNumReplicas(int32_t n, int32_t num_work_threads) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_work_threads_per_replica_ = num_work_threads;
+  replica_connections_.assign(n, 0);
+  replica_busy_seconds_.assign(n, 0);
+}
+
+void ServerMetrics::OnReplicaConnectionOpened(int32_t replica) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  replica_connections_[replica] += 1;
+}
+
+void ServerMetrics::OnReplicaConnectionClosed(int32_t replica) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  replica_connections_[replica] -= 1;
+}
+
+void ServerMetrics::OnReplicaBusy(int32_t replica, double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  replica_busy_seconds_[replica] += seconds;
+}
+
+std::string ServerMetrics::ToPrometheus() const {
+  std::ostringstream os;
+  os << std::setprecision(10);
+
+  WriteMetric("sherpa_onnx_connections_total", "counter",
+              "Number of accepted websocket connections.",
+              connections_total_.load(), os);
+
+  WriteMetric("sherpa_onnx_active_connections", "gauge",
+              "Number of open websocket connections.",
+              active_connections_.load(), os);
+
+  WriteMetric("sherpa_onnx_dropped_connections_total", "counter",
+              "Number of connections closed by the client before the server "
+              "finished processing its audio.",
+              dropped_connections_.load(), os);
+
+  WriteMetric("sherpa_onnx_rejected_connections_total", "counter",
+              "Number of connections closed by the server because of "
+              "invalid input or exceeded limits.",
+              rejected_connections_.load(), os);
+
+  if (idle_timeout_enabled_.load(std::memory_order_relaxed)) {
+    WriteMetric("sherpa_onnx_timed_out_connections_total", "counter",
+                "Number of connections closed by the server because they "
+                "were inactive for too long.",
+                timed_out_connections_.load(), os);
+  }
+
+  WriteMetric("sherpa_onnx_dropped_messages_total", "counter",
+              "Number of messages discarded because too much audio was "
+              "queued.",
+              dropped_messages_.load(), os);
+
+  WriteMetric("sherpa_onnx_queued_audio_bytes", "gauge",
+              "Size of the received audio waiting for feature extraction.",
+              queued_bytes_.load(), os);
+
+  WriteMetric("sherpa_onnx_ready_queue_depth", "gauge",
+              "Number of streams waiting in the ready queue.",
+              queue_depth_.load(), os);
+
+  batch_size_.Write("sherpa_onnx_batch_size",
+                    "Number of streams per decoded batch.", os);
+
+  decode_latency_.Write("sherpa_onnx_decode_latency_seconds",
+                        "Time to decode a batch.", os);
+
+  queue_wait_.Write("sherpa_onnx_queue_wait_seconds",
+                    "Time a stream waits in the ready queue before it is "
+                    "decoded.",
+                    os);
+
+  double audio_seconds = 0;
+  double decode_seconds = 0;
+  int32_t num_work_threads_per_replica = 0;
+  std::vector<double> replica_connections;
+  std::vector<double> replica_busy_seconds;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_seconds = audio_seconds_;
+    decode_seconds = decode_seconds_;
+    num_work_threads_per_replica = num_work_threads_per_replica_;
+    replica_connections.assign(replica_connections_.begin(),
+                               replica_connections_.end());
+    replica_busy_seconds = replica_busy_seconds_;
+  }
+
+  WriteMetric("sherpa_onnx_decoded_audio_seconds_total", "counter",
+              "Duration of decoded audio summed over all streams.",
+              audio_seconds, os);
+
+  WriteMetric("sherpa_onnx_decode_seconds_total", "counter",
+              "Time spent decoding batches.", decode_seconds, os);
+
+  WriteMetric("sherpa_onnx_real_time_factor", "gauge",
+              "sherpa_onnx_decode_seconds_total divided by "
+              "sherpa_onnx_decoded_audio_seconds_total.",
+              audio_seconds > 0 ? decode_seconds / audio_seconds : 0, os);
+
+  if (!replica_connections.empty()) {
+    WriteMetric("sherpa_onnx_replica_work_threads", "gauge",
+                "Number of work threads of each recognizer replica.",
+                num_work_threads_per_replica, os);
+
+    WriteReplicaMetric("sherpa_onnx_replica_active_connections", "gauge",
+                       "Number of open connections assigned to each "
+                       "recognizer replica.",
+                       replica_connections, os);
+
+    WriteReplicaMetric("sherpa_onnx_replica_busy_seconds_total", "counter",
+                       "Time the work threads of each recognizer replica "
+                       "spent decoding. Its rate divided by "
+                       "sherpa_onnx_replica_work_threads is the utilization "
+                       "of the replica.",
+                       replica_busy_seconds, os);
+  }
+
+  int64_t resident_bytes = -1;
+  int64_t virtual_bytes = -1;
+  GetProcessMemory(&resident_bytes, &virtual_bytes);
+
+  if (resident_bytes >= 0) {
+    WriteMetric("process_resident_memory_bytes", "gauge",
+                "Resident memory size in bytes.", resident_bytes, os);
+  }
+
+  if (virtual_bytes >= 0) {
+    WriteMetric("process_virtual_memory_bytes", "gauge",
+                "Virtual memory size in bytes.", virtual_bytes, os);
+  }
+
+  return os.str();
+}
+
+void GetProcessMemory(int64_t *resident_bytes, int64_t *virtual_bytes) {
+  *resident_bytes = -1;
+  *virtual_bytes = -1;
+
+#if defined(__linux__) || defined(__ANDROID__)
+  // See man 5 proc. Both values are in pages.
+  std::ifstream is("/proc/self/statm");
+  int64_t size = 0;
+  int64_t resident = 0;
+  if (is >> size >> resident) {
+    int64_t page_size = sysconf(_SC_PAGESIZE);
+    *resident_bytes = resident * page_size;
+    *virtual_bytes = size * page_size;
+  }
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+    *resident_bytes = info.resident_size;
+    *virtual_bytes = info.virtual_size;
+  }
+#endif
+}
+
+}  // namespace sherpa_onnx
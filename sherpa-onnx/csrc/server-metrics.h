@@ -0,0 +1,145 @@
+// sherpa-onnx/csrc/server-metrics.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_SERVER_METRICS_H_
+#define SHERPA_ONNX_CSRC_SERVER_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** A histogram with fixed bucket upper bounds, exported in the
+ * Prometheus text format. All methods are thread-safe.
+ */
+class PrometheusHistogram {
+ public:
+  // upper_bounds must be sorted in increasing order. An implicit +Inf
+  // bucket is appended.
+  explicit PrometheusHistogram(std::vector<double> upper_bounds);
+
+  void Observe(double v);
+
+  int64_t Count() const;
+
+  double Sum() const;
+
+  // Write the HELP, TYPE, _bucket, _sum and _count lines of this histogram
+  void Write(const std::string &name, const std::string &help,
+             std::ostream &os) const;
+
+ private:
+  std::vector<double> upper_bounds_;
+
+  mutable std::mutex mutex_;
+  // counts_[i] is the number of values in the i-th bucket (not cumulative).
+  // counts_.back() is for the +Inf bucket.
+  std::vector<int64_t> counts_;
+  double sum_ = 0;
+};
+
+/** Metrics of a websocket server. They are exported in the Prometheus
+ * text exposition format by ToPrometheus(), which the servers serve
+ * at the HTTP endpoint /metrics.
+ *
+ * All methods are thread-safe.
+ */
+class ServerMetrics {
+ public:
+  ServerMetrics();
+
+  void OnConnectionOpened();
+  void OnConnectionClosed();
+
+  // The client disconnected before all of its audio was decoded
+  void OnConnectionDropped();
+
+  // The server closed the connection because of invalid input or
+  // exceeded limits
+  void OnConnectionRejected();
+
+  // The server closes connections that are inactive for too long.
+  // The number of timed out connections is exported only after it is
+  // called.
+  void EnableIdleTimeout();
+
+  // The server closed the connection because it was inactive for too long
+  void OnConnectionTimedOut();
+
+  // A message from the client is discarded because too much audio
+  // is queued
+  void OnMessageDropped();
+
+  // Number of streams waiting in the ready queue
+  void SetQueueDepth(int32_t n);
+
+  // Size in bytes of the received audio waiting for feature extraction,
+  // summed over all connections
+  void SetQueuedBytes(int64_t n);
+
+  // Time a stream waited in the ready queue before it was decoded
+  void OnQueueWait(double seconds);
+
+  /**
+   * @param batch_size Number of streams in the batch.
+   * @param seconds Time to decode the batch.
+   * @param audio_seconds Duration of the audio decoded in this batch,
+   *                      summed over all streams.
+   */
+  void OnBatchDecoded(int32_t batch_size, double seconds,
+                      double audio_seconds);
+
+  /** The online server hosts n recognizer replicas, each with
+   * num_work_threads work threads. Per-replica metrics are exported only
+   * after it is called. It must be called before any of the OnReplica*
+   * methods.
+   */
+  void SetNumReplicas(int32_t n, int32_t num_work_threads);
+
+  void OnReplicaConnectionOpened(int32_t replica);
+  void OnReplicaConnectionClosed(int32_t replica);
+
+  // A work thread of the given replica spent this long decoding a batch
+  void OnReplicaBusy(int32_t replica, double seconds);
+
+  std::string ToPrometheus() const;
+
+ private:
+  std::atomic<int64_t> connections_total_{0};
+  std::atomic<int64_t> active_connections_{0};
+  std::atomic<int64_t> dropped_connections_{0};
+  std::atomic<int64_t> rejected_connections_{0};
+  std::atomic<bool> idle_timeout_enabled_{false};
+  std::atomic<int64_t> timed_out_connections_{0};
+  std::atomic<int64_t> dropped_messages_{0};
+  std::atomic<int32_t> queue_depth_{0};
+  std::atomic<int64_t> queued_bytes_{0};
+
+  PrometheusHistogram batch_size_;
+  PrometheusHistogram decode_latency_;
+  PrometheusHistogram queue_wait_;
+
+  // It protects audio_seconds_ and decode_seconds_, which are read together
+  // to compute the real-time factor, and the per-replica metrics below
+  mutable std::mutex mutex_;
+  double audio_seconds_ = 0;
+  double decode_seconds_ = 0;
+
+  int32_t num_work_threads_per_replica_ = 0;
+  std::vector<int64_t> replica_connections_;
+  std::vector<double> replica_busy_seconds_;
+};
+
+/** Return the resident set size and the virtual memory size of the current
+ * process in bytes. They are set to -1 if they are not available on the
+ * current platform.
+ */
+void GetProcessMemory(int64_t *resident_bytes, int64_t *virtual_bytes);
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_SERVER_METRICS_H_
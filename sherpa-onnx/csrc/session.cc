@@ -5,12 +5,25 @@
 #include "sherpa-onnx/csrc/session.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "sherpa-onnx/csrc/file-utils.h"
 #include "sherpa-onnx/csrc/macros.h"
 #include "sherpa-onnx/csrc/provider.h"
+#include "sherpa-onnx/csrc/text-utils.h"
 #if defined(__APPLE__)
 #include "coreml_provider_factory.h"  // NOLINT
 #endif
@@ -25,6 +38,220 @@
 
 namespace sherpa_onnx {
 
+namespace {
+
+struct OrtGlobalContext {
+  // ONNX Runtime has only one environment per process. It is created here
+  // with global thread pools, so Ort::Env objects created later by models
+  // refer to it and sessions can use its thread pools.
+  std::unique_ptr<Ort::Env> env;
+
+  OrtPrepackedWeightsContainer *prepacked_weights = nullptr;
+};
+
+std::mutex g_ort_global_context_mutex;
+
+// It is never freed, since sessions may outlive static objects
+std::atomic<OrtGlobalContext *> g_ort_global_context{nullptr};
+
+// Set when sherpa-onnx is about to create its first Ort::Env, i.e., when
+// the first session options are created for a model or for reading the
+// metadata of a model. ONNX Runtime has only one environment per process,
+// and the options of an Ort::Env created while another one is alive are
+// ignored, so the global context cannot be enabled after that.
+std::atomic<bool> g_ort_env_used{false};
+
+std::mutex g_model_cache_dir_mutex;
+bool g_model_cache_dir_initialized = false;
+std::string g_model_cache_dir;
+
+// A session config entry set by GetSessionOptionsImpl(). It identifies the
+// provider and its options for the optimized model cache and is absent if
+// the provider does not support it.
+constexpr const char *kModelCacheKey = "sherpa_onnx.model_cache_key";
+
+// 64-bit FNV-1a over 8-byte words, so that hashing a large model
+// takes little time compared to loading it
+uint64_t HashModel(const void *model_data, size_t model_data_length) {
+  constexpr uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL ^ model_data_length;
+
+  const char *p = static_cast<const char *>(model_data);
+  size_t n = model_data_length / sizeof(uint64_t);
+  for (size_t i = 0; i != n; ++i, p += sizeof(uint64_t)) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    h = (h ^ w) * kPrime;
+  }
+
+  for (size_t i = n * sizeof(uint64_t); i != model_data_length; ++i, ++p) {
+    h = (h ^ static_cast<unsigned char>(*p)) * kPrime;
+  }
+
+  return h;
+}
+
+// The level at which optimized models are saved. Optimizations above it,
+// e.g., the NCHWc layout transformations, depend on the instruction set of
+// the CPU. They are not saved and are applied again when a cached model is
+// loaded.
+constexpr GraphOptimizationLevel kModelCacheOptLevel = ORT_ENABLE_EXTENDED;
+
+std::string GetOptimizedModelFilename(const std::string &dir,
+                                      const void *model_data,
+                                      size_t model_data_length,
+                                      const std::string &cache_key) {
+  std::ostringstream os;
+  os << dir << "/" << std::hex << std::setw(16) << std::setfill('0')
+     << HashModel(model_data, model_data_length) << "-ort-"
+     << OrtGetApiBase()->GetVersionString() << "-" << cache_key << "-O"
+     << std::dec << static_cast<int32_t>(kModelCacheOptLevel) << ".onnx";
+  return os.str();
+}
+
+std::unique_ptr<Ort::Session> CreateSessionImpl(
+    const Ort::Env &env, const void *model_data, size_t model_data_length,
+    const Ort::SessionOptions &opts) {
+  OrtGlobalContext *context = g_ort_global_context;
+  if (context && context->prepacked_weights) {
+    return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                          opts, context->prepacked_weights);
+  }
+
+  return std::make_unique<Ort::Session>(env, model_data, model_data_length,
+                                        opts);
+}
+
+void SaveOptimizedModel(const Ort::Env &env, const void *model_data,
+                        size_t model_data_length,
+                        const Ort::SessionOptions &opts,
+                        const std::string &filename) {
+  // Write to a temporary file first, so that other processes never see a
+  // partially written model
+  std::ostringstream os;
+  os << filename << ".tmp."
+     << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+     << std::chrono::steady_clock::now().time_since_epoch().count();
+  std::string tmp_filename = os.str();
+
+  Ort::SessionOptions save_opts = opts.Clone();
+  save_opts.SetGraphOptimizationLevel(kModelCacheOptLevel);
+#if defined(_WIN32)
+  save_opts.SetOptimizedModelFilePath(ToWideString(tmp_filename).c_str());
+#else
+  save_opts.SetOptimizedModelFilePath(tmp_filename.c_str());
+#endif
+
+  try {
+    // The session is used only to save the model, so it does not share
+    // prepacked weights
+    Ort::Session sess(env, model_data, model_data_length, save_opts);
+  } catch (const Ort::Exception &e) {
+    SHERPA_ONNX_LOGE("Failed to save the optimized model to %s: %s",
+                     tmp_filename.c_str(), e.what());
+    std::remove(tmp_filename.c_str());
+    return;
+  }
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    // e.g., another process has saved it on Windows
+    std::remove(tmp_filename.c_str());
+  }
+}
+
+}  // namespace
+
+bool InitOrtGlobalContext(const OrtGlobalContextConfig &config) {
+  std::lock_guard<std::mutex> lock(g_ort_global_context_mutex);
+  if (g_ort_global_context) {
+    SHERPA_ONNX_LOGE("The global ONNX Runtime context is already enabled");
+    return false;
+  }
+
+  if (g_ort_env_used) {
+    SHERPA_ONNX_LOGE(
+        "Please enable the global ONNX Runtime context before creating any "
+        "model");
+    return false;
+  }
+
+  const auto &api = Ort::GetApi();
+  int32_t num_threads = std::max(config.num_threads, 1);
+
+  OrtThreadingOptions *threading_options = nullptr;
+  Ort::ThrowOnError(api.CreateThreadingOptions(&threading_options));
+  Ort::ThrowOnError(
+      api.SetGlobalIntraOpNumThreads(threading_options, num_threads));
+  Ort::ThrowOnError(
+      api.SetGlobalInterOpNumThreads(threading_options, num_threads));
+
+  auto context = std::make_unique<OrtGlobalContext>();
+  context->env = std::make_unique<Ort::Env>(
+      threading_options, ORT_LOGGING_LEVEL_ERROR, "sherpa-onnx");
+  api.ReleaseThreadingOptions(threading_options);
+
+  if (config.share_prepacked_weights) {
+    Ort::ThrowOnError(
+        api.CreatePrepackedWeightsContainer(&context->prepacked_weights));
+  }
+
+  g_ort_global_context = context.release();
+  return true;
+}
+
+bool HasOrtGlobalContext() { return g_ort_global_context != nullptr; }
+
+void SetOptimizedModelCacheDir(const std::string &dir) {
+  std::lock_guard<std::mutex> lock(g_model_cache_dir_mutex);
+  g_model_cache_dir = dir;
+  g_model_cache_dir_initialized = true;
+}
+
+std::string GetOptimizedModelCacheDir() {
+  std::lock_guard<std::mutex> lock(g_model_cache_dir_mutex);
+  if (!g_model_cache_dir_initialized) {
+    const char *dir = std::getenv("SHERPA_ONNX_MODEL_CACHE_DIR");
+    if (dir) {
+      g_model_cache_dir = dir;
+    }
+    g_model_cache_dir_initialized = true;
+  }
+  return g_model_cache_dir;
+}
+
+std::unique_ptr<Ort::Session> CreateSession(const Ort::Env &env,
+                                            const void *model_data,
+                                            size_t model_data_length,
+                                            const Ort::SessionOptions &opts) {
+  std::string dir = GetOptimizedModelCacheDir();
+  std::string cache_key =
+      dir.empty() ? "" : opts.GetConfigEntryOrDefault(kModelCacheKey, "");
+  if (cache_key.empty()) {
+    return CreateSessionImpl(env, model_data, model_data_length, opts);
+  }
+
+  std::string filename =
+      GetOptimizedModelFilename(dir, model_data, model_data_length, cache_key);
+
+  if (!FileExists(filename)) {
+    SaveOptimizedModel(env, model_data, model_data_length, opts, filename);
+  }
+
+  if (FileExists(filename)) {
+    // The hardware independent optimizations have been applied, so only
+    // the remaining ones are run when loading it
+    MappedFile buf(filename);
+    try {
+      return CreateSessionImpl(env, buf.data(), buf.size(), opts);
+    } catch (const Ort::Exception &e) {
+      SHERPA_ONNX_LOGE("Failed to load the cached model %s: %s. Ignore it",
+                       filename.c_str(), e.what());
+    }
+  }
+
+  return CreateSessionImpl(env, model_data, model_data_length, opts);
+}
+
 static void OrtStatusFailure(OrtStatus *status, const char *s) {
   const auto &api = Ort::GetApi();
   const char *msg = api.GetErrorMessage(status);
@@ -41,9 +268,16 @@ Ort::SessionOptions GetSessionOptionsImpl(
   Provider p = StringToProvider(provider_str);
 
   Ort::SessionOptions sess_opts;
-  sess_opts.SetIntraOpNumThreads(num_threads);
+  if (HasOrtGlobalContext()) {
+    // Use the global thread pools. See InitOrtGlobalContext()
+    sess_opts.DisablePerSessionThreads();
+  } else {
+    g_ort_env_used = true;
 
-  sess_opts.SetInterOpNumThreads(num_threads);
+    sess_opts.SetIntraOpNumThreads(num_threads);
+
+    sess_opts.SetInterOpNumThreads(num_threads);
+  }
 
   std::vector<std::string> available_providers = Ort::GetAvailableProviders();
   std::ostringstream os;
@@ -56,8 +290,13 @@ Ort::SessionOptions GetSessionOptionsImpl(
   // sess_opts.SetLogSeverityLevel(ORT_LOGGING_LEVEL_VERBOSE);
   // sess_opts.EnableProfiling("profile");
 
+  // Key of the optimized model cache. Graphs partitioned to other
+  // providers may contain compiled nodes, which cannot be saved
+  std::string cache_key;
+
   switch (p) {
     case Provider::kCPU:
+      cache_key = "cpu";
       break;  // nothing to do for the CPU provider
     case Provider::kXnnpack: {
 #if ORT_API_VERSION >= 12
@@ -169,11 +408,20 @@ Ort::SessionOptions GetSessionOptionsImpl(
           // set more options on need
         }
         sess_opts.AppendExecutionProvider_CUDA(options);
+
+        if (p == Provider::kCUDA) {
+          cache_key = "cuda" + std::to_string(options.device_id) + "-" +
+                      std::to_string(options.cudnn_conv_algo_search);
+        }
       } else {
         SHERPA_ONNX_LOGE(
             "Please compile with -DSHERPA_ONNX_ENABLE_GPU=ON. Available "
             "providers: %s. Fallback to cpu!",
             os.str().c_str());
+
+        if (p == Provider::kCUDA) {
+          cache_key = "cpu";
+        }
       }
       break;
     }
@@ -240,6 +488,23 @@ Ort::SessionOptions GetSessionOptionsImpl(
       break;
     }
   }
+
+  if (!cache_key.empty()) {
+    sess_opts.AddConfigEntry(kModelCacheKey, cache_key.c_str());
+  }
+
+  return sess_opts;
+}
+
+Ort::SessionOptions GetMetadataSessionOptions() {
+  if (!HasOrtGlobalContext()) {
+    g_ort_env_used = true;
+  }
+
+  Ort::SessionOptions sess_opts;
+  sess_opts.SetIntraOpNumThreads(1);
+  sess_opts.SetInterOpNumThreads(1);
+  sess_opts.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
   return sess_opts;
 }
 
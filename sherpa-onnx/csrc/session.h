@@ -5,6 +5,7 @@
 #ifndef SHERPA_ONNX_CSRC_SESSION_H_
 #define SHERPA_ONNX_CSRC_SESSION_H_
 
+#include <memory>
 #include <string>
 
 #include "onnxruntime_cxx_api.h"  // NOLINT
@@ -14,6 +15,64 @@
 
 namespace sherpa_onnx {
 
+// An opt-in process-wide context shared by all ONNX Runtime sessions
+// created by sherpa-onnx, e.g., for ASR, VAD, punctuation and speaker ID
+// models living in the same process.
+struct OrtGlobalContextConfig {
+  // Number of threads of the global intra-op and inter-op thread pools.
+  // Sessions no longer have their own thread pools, so num_threads in
+  // model configs is ignored.
+  int32_t num_threads = 1;
+
+  // True to share prepacked weights among sessions. Sessions loading the
+  // same model file then keep only one copy of them.
+  bool share_prepacked_weights = true;
+};
+
+/** Enable the global context. It must be called before creating any model
+ * or recognizer, since ONNX Runtime ignores the global thread pools if its
+ * environment already exists. An Ort::Env created by the application
+ * itself before this call is not detected.
+ *
+ * @return Return true on success. Return false if it has already been
+ *         enabled or if sherpa-onnx has created an Ort::Env before.
+ */
+bool InitOrtGlobalContext(const OrtGlobalContextConfig &config);
+
+bool HasOrtGlobalContext();
+
+/** Set the directory of the optimized model cache. An empty string
+ * disables the cache, which is the default. If it is never called, the
+ * environment variable SHERPA_ONNX_MODEL_CACHE_DIR is used.
+ *
+ * The first time a model is loaded, the graph with the hardware independent
+ * optimizations of ONNX Runtime (ORT_ENABLE_EXTENDED) is saved to the
+ * directory. Later loads read it and run only the remaining, hardware
+ * specific, optimizations. Cached models are keyed by a hash of the model
+ * file, the ONNX Runtime version, the provider with its options and the
+ * optimization level. Only the cpu and cuda providers are cached. The
+ * directory must exist.
+ */
+void SetOptimizedModelCacheDir(const std::string &dir);
+
+std::string GetOptimizedModelCacheDir();
+
+/** Create a session from a model in memory. If the global context is
+ * enabled with share_prepacked_weights, prepacked weights are shared with
+ * other sessions. If the optimized model cache is enabled, the
+ * optimized model is loaded from or saved to it.
+ */
+std::unique_ptr<Ort::Session> CreateSession(const Ort::Env &env,
+                                            const void *model_data,
+                                            size_t model_data_length,
+                                            const Ort::SessionOptions &opts);
+
+/** Return options for a session that is created only to read the metadata
+ * or the inputs/outputs of a model. Such a session never runs, so graph
+ * optimizations are disabled.
+ */
+Ort::SessionOptions GetMetadataSessionOptions();
+
 Ort::SessionOptions GetSessionOptionsImpl(
     int32_t num_threads, const std::string &provider_str,
     const ProviderConfig *provider_config = nullptr);
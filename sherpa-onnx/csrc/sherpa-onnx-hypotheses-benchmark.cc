@@ -0,0 +1,115 @@
+// sherpa-onnx/csrc/sherpa-onnx-hypotheses-benchmark.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "sherpa-onnx/csrc/hypothesis.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+
+// Simulate modified beam search on a long stream and return the time in
+// microseconds spent in Hypotheses::Add() per frame in the first and in the
+// last minute of the stream
+static std::pair<double, double> Run(int32_t num_frames,
+                                     int32_t max_active_paths,
+                                     int32_t *num_tokens) {
+  std::mt19937 mt(0);
+  std::uniform_int_distribution<int32_t> token_dist(1, 499);
+  std::uniform_real_distribution<float> prob_dist(0, 1);
+
+  // 40 ms per frame after subsampling
+  int32_t num_report_frames = std::min(60 * 25, num_frames);
+  int32_t context_size = 2;
+
+  sherpa_onnx::Hypotheses cur({sherpa_onnx::Hypothesis(
+      std::vector<int64_t>(context_size, 0), 0)});
+  double first_us = 0;
+  double last_us = 0;
+
+  for (int32_t t = 0; t != num_frames; ++t) {
+    std::vector<sherpa_onnx::Hypothesis> prev =
+        cur.GetTopK(max_active_paths, false);
+
+    // Build the new hyps before timing. The copy of Hypothesis is
+    // done by the decoder anyway.
+    std::vector<sherpa_onnx::Hypothesis> new_hyps;
+    new_hyps.reserve(max_active_paths);
+    for (int32_t k = 0; k != max_active_paths; ++k) {
+      sherpa_onnx::Hypothesis new_hyp = prev[k % prev.size()];
+      if (prob_dist(mt) > 0.7) {
+        new_hyp.AppendToken(token_dist(mt));
+      }
+      new_hyp.log_prob -= prob_dist(mt);
+      new_hyps.push_back(std::move(new_hyp));
+    }
+
+    // Freeing the hyps of the previous frame is not part of Add()
+    cur.Clear();
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto &h : new_hyps) {
+      cur.Add(std::move(h));
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double us =
+        std::chrono::duration<double, std::micro>(stop - start).count();
+    if (t < num_report_frames) {
+      first_us += us;
+    }
+
+    if (t >= num_frames - num_report_frames) {
+      last_us += us;
+    }
+  }
+
+  *num_tokens = cur.GetMostProbable(false).ys.size() - context_size;
+
+  return {first_us / num_report_frames, last_us / num_report_frames};
+}
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Measure the time spent in Hypotheses::Add() per frame at the beginning and
+at the end of a long stream, with random tokens as in modified beam search.
+
+It is built only if cmake is run with -DSHERPA_ONNX_BUILD_BENCHMARKS=ON.
+
+Usage:
+
+  ./bin/sherpa-onnx-hypotheses-benchmark --minutes=10
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  int32_t minutes = 10;
+  po.Register("minutes", &minutes, "Length of the simulated stream");
+
+  po.Read(argc, argv);
+  if (po.NumArgs() != 0 || minutes < 1) {
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t num_frames = minutes * 60 * 25;
+
+  for (int32_t max_active_paths = 4; max_active_paths <= 16;
+       max_active_paths *= 2) {
+    int32_t num_tokens = 0;
+    auto r = Run(num_frames, max_active_paths, &num_tokens);
+
+    fprintf(stderr,
+            "max_active_paths %d, %d tokens: Add() takes %.3f us per frame "
+            "in the first minute and %.3f us per frame in the last minute\n",
+            max_active_paths, num_tokens, r.first, r.second);
+  }
+
+  return 0;
+}
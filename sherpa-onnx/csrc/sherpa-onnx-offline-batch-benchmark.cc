@@ -0,0 +1,164 @@
+// sherpa-onnx/csrc/sherpa-onnx-offline-batch-benchmark.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+struct Wave {
+  int32_t sampling_rate = 0;
+  std::vector<float> samples;
+};
+
+// Decode all waves, batch_size waves per DecodeStreams() call, and return
+// the elapsed seconds
+static float Decode(const sherpa_onnx::OfflineRecognizer &recognizer,
+                    const std::vector<Wave> &waves, int32_t batch_size) {
+  const auto begin = std::chrono::steady_clock::now();
+
+  for (size_t start = 0; start < waves.size(); start += batch_size) {
+    std::vector<std::unique_ptr<sherpa_onnx::OfflineStream>> ss;
+    std::vector<sherpa_onnx::OfflineStream *> ss_pointers;
+
+    for (size_t i = start; i < waves.size() && i < start + batch_size; ++i) {
+      auto s = recognizer.CreateStream();
+      s->AcceptWaveform(waves[i].sampling_rate, waves[i].samples.data(),
+                        waves[i].samples.size());
+
+      ss_pointers.push_back(s.get());
+      ss.push_back(std::move(s));
+    }
+
+    recognizer.DecodeStreams(ss_pointers.data(), ss_pointers.size());
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+             .count() /
+         1000.;
+}
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Measure the throughput of a non-streaming recognizer when decoding a set of
+wave files one at a time and in batches.
+
+It is built only if cmake is run with -DSHERPA_ONNX_BUILD_BENCHMARKS=ON.
+
+Usage:
+
+  ./bin/sherpa-onnx-offline-batch-benchmark \
+    --batch-size=16 \
+    --wav-list=/path/to/wav.list \
+    --tokens=/path/to/tokens.txt \
+    --moonshine-preprocessor=/path/to/preprocess.onnx \
+    --moonshine-encoder=/path/to/encode.int8.onnx \
+    --moonshine-uncached-decoder=/path/to/uncached_decode.int8.onnx \
+    --moonshine-cached-decoder=/path/to/cached_decode.int8.onnx
+
+--wav-list is a text file containing one wave filename per line. Wave
+files can also be given as positional arguments.
+
+The other options are the same as the ones of sherpa-onnx-offline.
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  sherpa_onnx::OfflineRecognizerConfig config;
+  config.Register(&po);
+
+  std::string wav_list;
+  int32_t batch_size = 16;
+  po.Register("wav-list", &wav_list,
+              "A text file containing one wave filename per line");
+  po.Register("batch-size", &batch_size,
+              "Number of waves per DecodeStreams() call in the batched run");
+
+  po.Read(argc, argv);
+
+  std::vector<std::string> filenames;
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    filenames.push_back(po.GetArg(i));
+  }
+
+  if (!wav_list.empty()) {
+    std::ifstream is(wav_list);
+    if (!is) {
+      fprintf(stderr, "Failed to open '%s'\n", wav_list.c_str());
+      return -1;
+    }
+
+    std::string line;
+    while (std::getline(is, line)) {
+      if (!line.empty()) {
+        filenames.push_back(line);
+      }
+    }
+  }
+
+  if (filenames.empty()) {
+    fprintf(stderr, "Error: Please provide at least 1 wave file.\n\n");
+    po.PrintUsage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (batch_size < 1) {
+    fprintf(stderr, "--batch-size should be >= 1. Given: %d\n", batch_size);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(stderr, "%s\n", config.ToString().c_str());
+
+  if (!config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
+    return -1;
+  }
+
+  std::vector<Wave> waves;
+  waves.reserve(filenames.size());
+
+  float duration = 0;
+  for (const auto &f : filenames) {
+    Wave w;
+    bool is_ok = false;
+    w.samples = sherpa_onnx::ReadWave(f, &w.sampling_rate, &is_ok);
+    if (!is_ok) {
+      fprintf(stderr, "Failed to read '%s'\n", f.c_str());
+      return -1;
+    }
+
+    duration += w.samples.size() / static_cast<float>(w.sampling_rate);
+    waves.push_back(std::move(w));
+  }
+
+  sherpa_onnx::OfflineRecognizer recognizer(config);
+
+  // Warm up so that the first run does not pay for lazy initialization
+  Decode(recognizer, {waves[0]}, 1);
+
+  float one_by_one = Decode(recognizer, waves, 1);
+  float batched = Decode(recognizer, waves, batch_size);
+
+  fprintf(stderr, "Number of waves:           %d\n",
+          static_cast<int32_t>(waves.size()));
+  fprintf(stderr, "Audio duration:            %.3f s\n", duration);
+  fprintf(stderr, "Batch size 1:              %.3f s, RTF %.4f\n", one_by_one,
+          one_by_one / duration);
+  fprintf(stderr, "Batch size %-4d            %.3f s, RTF %.4f\n", batch_size,
+          batched, batched / duration);
+  if (batched > 0) {
+    fprintf(stderr, "Speedup:                   %.2f\n", one_by_one / batched);
+  }
+
+  return 0;
+}
@@ -10,6 +10,7 @@
 
 #include "sherpa-onnx/csrc/offline-recognizer.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
 int main(int32_t argc, char *argv[]) {
@@ -107,6 +108,12 @@ for a list of pre-trained models to download.
   sherpa_onnx::OfflineRecognizerConfig config;
   config.Register(&po);
 
+  std::string model_cache_dir;
+  po.Register("model-cache-dir", &model_cache_dir,
+              "If not empty, optimized models are cached in this existing "
+              "directory to speed up later startups. It overrides the "
+              "environment variable SHERPA_ONNX_MODEL_CACHE_DIR.");
+
   po.Read(argc, argv);
   if (po.NumArgs() < 1) {
     fprintf(stderr, "Error: Please provide at least 1 wave file.\n\n");
@@ -121,6 +128,10 @@ for a list of pre-trained models to download.
     return -1;
   }
 
+  if (!model_cache_dir.empty()) {
+    sherpa_onnx::SetOptimizedModelCacheDir(model_cache_dir);
+  }
+
   fprintf(stderr, "Creating recognizer ...\n");
   sherpa_onnx::OfflineRecognizer recognizer(config);
 
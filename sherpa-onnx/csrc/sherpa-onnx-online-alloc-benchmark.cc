@@ -0,0 +1,247 @@
+// sherpa-onnx/csrc/sherpa-onnx-online-alloc-benchmark.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/online-stream.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/wave-reader.h"
+
+static std::atomic<int64_t> g_num_allocs{0};
+static std::atomic<int64_t> g_num_bytes{0};
+
+static void CountAlloc(std::size_t n) {
+  g_num_allocs.fetch_add(1, std::memory_order_relaxed);
+  g_num_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+// Count at the allocator level by interposing the C allocation functions.
+// onnxruntime allocates its tensors with malloc()/posix_memalign() and
+// operator new is implemented on top of malloc(), so this covers the
+// allocations made by both onnxruntime and sherpa-onnx. Memory served
+// from an already allocated onnxruntime arena chunk is not counted.
+extern "C" {
+void *__libc_malloc(std::size_t n);
+void *__libc_calloc(std::size_t num, std::size_t n);
+void *__libc_realloc(void *p, std::size_t n);
+void *__libc_memalign(std::size_t alignment, std::size_t n);
+
+void *malloc(std::size_t n) {
+  CountAlloc(n);
+  return __libc_malloc(n);
+}
+
+void *calloc(std::size_t num, std::size_t n) {
+  CountAlloc(num * n);
+  return __libc_calloc(num, n);
+}
+
+void *realloc(void *p, std::size_t n) {
+  CountAlloc(n);
+  return __libc_realloc(p, n);
+}
+
+void *memalign(std::size_t alignment, std::size_t n) {
+  CountAlloc(n);
+  return __libc_memalign(alignment, n);
+}
+
+void *aligned_alloc(std::size_t alignment, std::size_t n) {
+  CountAlloc(n);
+  return __libc_memalign(alignment, n);
+}
+
+int posix_memalign(void **p, std::size_t alignment, std::size_t n) {
+  if (alignment % sizeof(void *) != 0 ||
+      (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+
+  CountAlloc(n);
+  *p = __libc_memalign(alignment, n);
+  return *p ? 0 : ENOMEM;
+}
+}  // extern "C"
+#else
+// Without glibc we cannot interpose the C allocator portably, so only
+// the global operator new is counted. Allocations made by onnxruntime
+// itself, e.g., the outputs of each Run() call, are missed.
+void *operator new(std::size_t n) {
+  CountAlloc(n);
+
+  if (void *p = std::malloc(n == 0 ? 1 : n)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+struct BenchmarkResult {
+  int64_t num_chunks = 0;
+  int64_t num_allocs = 0;
+  int64_t num_bytes = 0;
+  float elapsed_seconds = 0;
+};
+
+static BenchmarkResult Run(const sherpa_onnx::OnlineRecognizerConfig &config,
+                           const std::vector<std::vector<float>> &waves,
+                           int32_t sampling_rate) {
+  sherpa_onnx::OnlineRecognizer recognizer(config);
+
+  std::vector<std::unique_ptr<sherpa_onnx::OnlineStream>> ss;
+  for (const auto &samples : waves) {
+    auto s = recognizer.CreateStream();
+    s->AcceptWaveform(sampling_rate, samples.data(), samples.size());
+
+    std::vector<float> tail_paddings(static_cast<int>(0.8 * sampling_rate));
+    s->AcceptWaveform(sampling_rate, tail_paddings.data(),
+                      tail_paddings.size());
+    s->InputFinished();
+
+    ss.push_back(std::move(s));
+  }
+
+  BenchmarkResult ans;
+
+  std::vector<sherpa_onnx::OnlineStream *> ready_streams;
+  ready_streams.reserve(ss.size());
+
+  const auto begin = std::chrono::steady_clock::now();
+
+  for (;;) {
+    ready_streams.clear();
+    for (auto &s : ss) {
+      if (recognizer.IsReady(s.get())) {
+        ready_streams.push_back(s.get());
+      }
+    }
+
+    if (ready_streams.empty()) {
+      break;
+    }
+
+    int64_t num_allocs = g_num_allocs.load();
+    int64_t num_bytes = g_num_bytes.load();
+
+    recognizer.DecodeStreams(ready_streams.data(), ready_streams.size());
+
+    ans.num_allocs += g_num_allocs.load() - num_allocs;
+    ans.num_bytes += g_num_bytes.load() - num_bytes;
+    ans.num_chunks += 1;
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+  ans.elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+          .count() /
+      1000.;
+
+  for (size_t i = 0; i != ss.size(); ++i) {
+    fprintf(stderr, "%d: %s\n", static_cast<int32_t>(i),
+            recognizer.GetResult(ss[i].get()).text.c_str());
+  }
+
+  return ans;
+}
+
+static void Print(const char *name, const BenchmarkResult &r) {
+  fprintf(stderr,
+          "%-12s chunks: %lld, allocations per chunk: %.1f, "
+          "bytes per chunk: %.1f, elapsed seconds: %.3f\n",
+          name, static_cast<long long>(r.num_chunks),  // NOLINT
+          r.num_chunks ? static_cast<float>(r.num_allocs) / r.num_chunks : 0,
+          r.num_chunks ? static_cast<float>(r.num_bytes) / r.num_chunks : 0,
+          r.elapsed_seconds);
+}
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Count heap allocations per chunk in OnlineRecognizer::DecodeStreams()
+with and without --use-io-binding.
+
+It is built only if cmake is run with -DSHERPA_ONNX_BUILD_BENCHMARKS=ON.
+
+Usage:
+
+  ./bin/sherpa-onnx-online-alloc-benchmark \
+    --tokens=/path/to/tokens.txt \
+    --encoder=/path/to/encoder.onnx \
+    --decoder=/path/to/decoder.onnx \
+    --joiner=/path/to/joiner.onnx \
+    --decoding-method=greedy_search \
+    /path/to/foo.wav [bar.wav foobar.wav ...]
+
+All wave files are decoded in a batch. They must have the same sampling rate.
+The value of --use-io-binding is ignored; both modes are benchmarked.
+)usage";
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+  sherpa_onnx::OnlineRecognizerConfig config;
+
+  config.Register(&po);
+
+  po.Read(argc, argv);
+  if (po.NumArgs() < 1) {
+    po.PrintUsage();
+    fprintf(stderr, "Error! Please provide at lease 1 wav file\n");
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(stderr, "%s\n", config.ToString().c_str());
+
+  if (!config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
+    return -1;
+  }
+
+  std::vector<std::vector<float>> waves;
+  int32_t sampling_rate = -1;
+  for (int32_t i = 1; i <= po.NumArgs(); ++i) {
+    const std::string wav_filename = po.GetArg(i);
+    int32_t this_sampling_rate = -1;
+
+    bool is_ok = false;
+    std::vector<float> samples =
+        sherpa_onnx::ReadWave(wav_filename, &this_sampling_rate, &is_ok);
+
+    if (!is_ok) {
+      fprintf(stderr, "Failed to read '%s'\n", wav_filename.c_str());
+      return -1;
+    }
+
+    if (sampling_rate != -1 && sampling_rate != this_sampling_rate) {
+      fprintf(stderr, "All wave files should have the same sampling rate\n");
+      return -1;
+    }
+
+    sampling_rate = this_sampling_rate;
+    waves.push_back(std::move(samples));
+  }
+
+  config.model_config.transducer.use_io_binding = false;
+  auto before = Run(config, waves, sampling_rate);
+
+  config.model_config.transducer.use_io_binding = true;
+  auto after = Run(config, waves, sampling_rate);
+
+  Print("Default", before);
+  Print("IoBinding", after);
+
+  return 0;
+}
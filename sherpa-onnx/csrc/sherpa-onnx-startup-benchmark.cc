@@ -0,0 +1,179 @@
+// sherpa-onnx/csrc/sherpa-onnx-startup-benchmark.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include <stdio.h>
+
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "sherpa-onnx/csrc/offline-recognizer.h"
+#include "sherpa-onnx/csrc/online-recognizer.h"
+#include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
+
+#if SHERPA_ONNX_ENABLE_TTS == 1
+#include "sherpa-onnx/csrc/offline-tts.h"
+#endif
+
+// Return the average seconds of num_runs calls of f()
+static float Time(const std::function<void()> &f, int32_t num_runs) {
+  const auto begin = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i != num_runs; ++i) {
+    f();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - begin)
+             .count() /
+         1000. / num_runs;
+}
+
+static int32_t Run(const std::string &cache_dir, int32_t num_runs,
+                   const std::function<void()> &create) {
+  sherpa_onnx::SetOptimizedModelCacheDir("");
+  float no_cache = Time(create, num_runs);
+
+  sherpa_onnx::SetOptimizedModelCacheDir(cache_dir);
+
+  // It saves optimized models to the cache if they are not there yet
+  float first_run = Time(create, 1);
+
+  float with_cache = Time(create, num_runs);
+
+  fprintf(stderr, "Without cache:             %.3f s\n", no_cache);
+  fprintf(stderr, "With cache, first run:     %.3f s\n", first_run);
+  fprintf(stderr, "With cache:                %.3f s\n", with_cache);
+  if (with_cache > 0) {
+    fprintf(stderr, "Speedup:                   %.2f\n",
+            no_cache / with_cache);
+  }
+
+  return 0;
+}
+
+int main(int32_t argc, char *argv[]) {
+  const char *kUsageMessage = R"usage(
+Measure the time to create a recognizer or a TTS engine with and without
+the optimized model cache. See SetOptimizedModelCacheDir() in
+sherpa-onnx/csrc/session.h
+
+It is built only if cmake is run with -DSHERPA_ONNX_BUILD_BENCHMARKS=ON.
+
+Usage:
+
+  ./bin/sherpa-onnx-startup-benchmark online \
+    --model-cache-dir=/tmp/sherpa-onnx-cache \
+    --tokens=/path/to/tokens.txt \
+    --encoder=/path/to/encoder.onnx \
+    --decoder=/path/to/decoder.onnx \
+    --joiner=/path/to/joiner.onnx
+
+  ./bin/sherpa-onnx-startup-benchmark offline \
+    --model-cache-dir=/tmp/sherpa-onnx-cache \
+    --tokens=/path/to/tokens.txt \
+    --whisper-encoder=/path/to/encoder.onnx \
+    --whisper-decoder=/path/to/decoder.onnx
+
+  ./bin/sherpa-onnx-startup-benchmark tts \
+    --model-cache-dir=/tmp/sherpa-onnx-cache \
+    --vits-model=/path/to/model.onnx \
+    --vits-tokens=/path/to/tokens.txt \
+    --vits-data-dir=/path/to/espeak-ng-data
+
+The first argument selects the model type: online, offline or tts.
+The other options are the same as the ones of sherpa-onnx, sherpa-onnx-offline
+and sherpa-onnx-offline-tts, respectively.
+
+The directory given by --model-cache-dir must exist.
+)usage";
+
+  if (argc < 2) {
+    fprintf(stderr, "%s\n", kUsageMessage);
+    exit(EXIT_FAILURE);
+  }
+
+  // argv[1] is the model type. It is used as the program name below, so
+  // that the remaining options are parsed as usual.
+  std::string type = argv[1];
+
+  sherpa_onnx::ParseOptions po(kUsageMessage);
+
+  std::string cache_dir;
+  int32_t num_runs = 3;
+  po.Register("model-cache-dir", &cache_dir,
+              "An existing directory for the optimized model cache");
+  po.Register("num-runs", &num_runs,
+              "Number of runs to average for each measurement");
+
+  sherpa_onnx::OnlineRecognizerConfig online_config;
+  sherpa_onnx::OfflineRecognizerConfig offline_config;
+#if SHERPA_ONNX_ENABLE_TTS == 1
+  sherpa_onnx::OfflineTtsConfig tts_config;
+#endif
+
+  if (type == "online") {
+    online_config.Register(&po);
+  } else if (type == "offline") {
+    offline_config.Register(&po);
+#if SHERPA_ONNX_ENABLE_TTS == 1
+  } else if (type == "tts") {
+    tts_config.Register(&po);
+#endif
+  } else {
+    fprintf(stderr, "Unsupported model type: %s\n\n%s\n", type.c_str(),
+            kUsageMessage);
+    exit(EXIT_FAILURE);
+  }
+
+  po.Read(argc - 1, argv + 1);
+
+  if (cache_dir.empty()) {
+    fprintf(stderr, "Please provide --model-cache-dir\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (num_runs < 1) {
+    fprintf(stderr, "--num-runs should be >= 1. Given: %d\n", num_runs);
+    exit(EXIT_FAILURE);
+  }
+
+  if (type == "online") {
+    fprintf(stderr, "%s\n", online_config.ToString().c_str());
+    if (!online_config.Validate()) {
+      fprintf(stderr, "Errors in config!\n");
+      return -1;
+    }
+
+    return Run(cache_dir, num_runs, [&online_config]() {
+      sherpa_onnx::OnlineRecognizer recognizer(online_config);
+    });
+  }
+
+  if (type == "offline") {
+    fprintf(stderr, "%s\n", offline_config.ToString().c_str());
+    if (!offline_config.Validate()) {
+      fprintf(stderr, "Errors in config!\n");
+      return -1;
+    }
+
+    return Run(cache_dir, num_runs, [&offline_config]() {
+      sherpa_onnx::OfflineRecognizer recognizer(offline_config);
+    });
+  }
+
+#if SHERPA_ONNX_ENABLE_TTS == 1
+  fprintf(stderr, "%s\n", tts_config.ToString().c_str());
+  if (!tts_config.Validate()) {
+    fprintf(stderr, "Errors in config!\n");
+    return -1;
+  }
+
+  return Run(cache_dir, num_runs,
+             [&tts_config]() { sherpa_onnx::OfflineTts tts(tts_config); });
+#else
+  return 0;
+#endif
+}
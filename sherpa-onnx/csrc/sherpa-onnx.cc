@@ -13,6 +13,7 @@
 #include "sherpa-onnx/csrc/online-recognizer.h"
 #include "sherpa-onnx/csrc/online-stream.h"
 #include "sherpa-onnx/csrc/parse-options.h"
+#include "sherpa-onnx/csrc/session.h"
 #include "sherpa-onnx/csrc/symbol-table.h"
 #include "sherpa-onnx/csrc/wave-reader.h"
 
@@ -80,6 +81,12 @@ for a list of pre-trained models to download.
 
   config.Register(&po);
 
+  std::string model_cache_dir;
+  po.Register("model-cache-dir", &model_cache_dir,
+              "If not empty, optimized models are cached in this existing "
+              "directory to speed up later startups. It overrides the "
+              "environment variable SHERPA_ONNX_MODEL_CACHE_DIR.");
+
   po.Read(argc, argv);
   if (po.NumArgs() < 1) {
     po.PrintUsage();
@@ -94,6 +101,10 @@ for a list of pre-trained models to download.
     return -1;
   }
 
+  if (!model_cache_dir.empty()) {
+    sherpa_onnx::SetOptimizedModelCacheDir(model_cache_dir);
+  }
+
   sherpa_onnx::OnlineRecognizer recognizer(config);
 
   std::vector<Stream> ss;
@@ -0,0 +1,109 @@
+// sherpa-onnx/csrc/spsc-ring-buffer-test.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/spsc-ring-buffer.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace sherpa_onnx {
+
+TEST(SpscRingBuffer, WrapAround) {
+  SpscRingBuffer buffer(3);
+  EXPECT_EQ(buffer.Capacity(), 4);
+  EXPECT_TRUE(buffer.Empty());
+
+  std::vector<float> a = {1, 2, 3};
+  EXPECT_TRUE(buffer.Push(a.data(), a.size()));
+  EXPECT_EQ(buffer.Size(), 3);
+
+  // There is no room for 2 more samples
+  EXPECT_FALSE(buffer.Push(a.data(), 2));
+  EXPECT_EQ(buffer.Size(), 3);
+
+  const float *p = nullptr;
+  ASSERT_EQ(buffer.Front(&p), 3);
+  EXPECT_EQ(p[0], 1);
+  buffer.Pop(2);
+
+  std::vector<float> b = {4, 5, 6};
+  EXPECT_TRUE(buffer.Push(b.data(), b.size()));
+  EXPECT_EQ(buffer.Size(), 4);
+
+  // The samples 3, 4 are at the end of the underlying array and 5, 6 are
+  // at the beginning
+  ASSERT_EQ(buffer.Front(&p), 2);
+  EXPECT_EQ(p[0], 3);
+  EXPECT_EQ(p[1], 4);
+  buffer.Pop(2);
+
+  ASSERT_EQ(buffer.Front(&p), 2);
+  EXPECT_EQ(p[0], 5);
+  EXPECT_EQ(p[1], 6);
+
+  buffer.Clear();
+  EXPECT_TRUE(buffer.Empty());
+  EXPECT_EQ(buffer.Front(&p), 0);
+}
+
+TEST(SpscRingBuffer, Int16) {
+  SpscRingBuffer buffer(4);
+  std::vector<int16_t> a = {-32768, 0, 16384, 32767};
+  EXPECT_TRUE(buffer.PushInt16(a.data(), a.size()));
+
+  const float *p = nullptr;
+  ASSERT_EQ(buffer.Front(&p), 4);
+  EXPECT_EQ(p[0], -1);
+  EXPECT_EQ(p[1], 0);
+  EXPECT_EQ(p[2], 0.5);
+  EXPECT_NEAR(p[3], 1, 1e-4);
+}
+
+TEST(SpscRingBuffer, Concurrent) {
+  SpscRingBuffer buffer(64);
+  constexpr int32_t kNumSamples = 100000;
+
+  std::thread producer([&buffer]() {
+    std::vector<float> chunk(7);
+    int32_t next = 0;
+    while (next < kNumSamples) {
+      int32_t n = std::min<int32_t>(chunk.size(), kNumSamples - next);
+      for (int32_t i = 0; i != n; ++i) {
+        chunk[i] = next + i;
+      }
+
+      while (!buffer.Push(chunk.data(), n)) {
+        std::this_thread::yield();
+      }
+      next += n;
+    }
+  });
+
+  int32_t expected = 0;
+  bool ok = true;
+  while (expected < kNumSamples) {
+    const float *p = nullptr;
+    int32_t n = buffer.Front(&p);
+    if (n == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    for (int32_t i = 0; i != n; ++i) {
+      ok = ok && (p[i] == expected + i);
+    }
+    buffer.Pop(n);
+    expected += n;
+  }
+
+  producer.join();
+
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(buffer.Empty());
+}
+
+}  // namespace sherpa_onnx
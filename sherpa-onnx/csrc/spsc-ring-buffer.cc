@@ -0,0 +1,97 @@
+// sherpa-onnx/csrc/spsc-ring-buffer.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/csrc/spsc-ring-buffer.h"
+
+#include <algorithm>
+
+#include "sherpa-onnx/csrc/math.h"
+
+namespace sherpa_onnx {
+
+static int64_t RoundUpToPowerOfTwo(int64_t n) {
+  int64_t ans = 1;
+  while (ans < n) {
+    ans <<= 1;
+  }
+  return ans;
+}
+
+SpscRingBuffer::SpscRingBuffer(int32_t capacity)
+    : buffer_(RoundUpToPowerOfTwo(std::max(capacity, 1))),
+      mask_(static_cast<int64_t>(buffer_.size()) - 1) {}
+
+int32_t SpscRingBuffer::Size() const {
+  int64_t head = head_.load(std::memory_order_acquire);
+  int64_t tail = tail_.load(std::memory_order_acquire);
+  return static_cast<int32_t>(tail - head);
+}
+
+int64_t SpscRingBuffer::Reserve(int32_t n) const {
+  int64_t tail = tail_.load(std::memory_order_relaxed);
+
+  // Acquire so that the consumer has finished reading the slots it popped
+  // before we overwrite them
+  int64_t head = head_.load(std::memory_order_acquire);
+  if (tail - head + n > static_cast<int64_t>(buffer_.size())) {
+    return -1;
+  }
+
+  return tail;
+}
+
+template <typename F>
+void SpscRingBuffer::Write(int64_t tail, int32_t n, F f) {
+  int64_t start = tail & mask_;
+  int32_t n1 =
+      static_cast<int32_t>(std::min<int64_t>(n, buffer_.size() - start));
+
+  f(0, n1, buffer_.data() + start);
+  f(n1, n - n1, buffer_.data());
+
+  // Release so that the consumer sees the samples once it sees the new tail
+  tail_.store(tail + n, std::memory_order_release);
+}
+
+bool SpscRingBuffer::Push(const float *p, int32_t n) {
+  int64_t tail = Reserve(n);
+  if (tail < 0) {
+    return false;
+  }
+
+  Write(tail, n, [p](int32_t i, int32_t k, float *dst) {
+    std::copy(p + i, p + i + k, dst);
+  });
+  return true;
+}
+
+bool SpscRingBuffer::PushInt16(const int16_t *p, int32_t n) {
+  int64_t tail = Reserve(n);
+  if (tail < 0) {
+    return false;
+  }
+
+  Write(tail, n, [p](int32_t i, int32_t k, float *dst) {
+    VecInt16ToFloat(p + i, k, 1.0f / 32768, dst);
+  });
+  return true;
+}
+
+int32_t SpscRingBuffer::Front(const float **p) const {
+  int64_t head = head_.load(std::memory_order_relaxed);
+  int64_t tail = tail_.load(std::memory_order_acquire);
+
+  int64_t start = head & mask_;
+  *p = buffer_.data() + start;
+
+  return static_cast<int32_t>(
+      std::min<int64_t>(tail - head, buffer_.size() - start));
+}
+
+void SpscRingBuffer::Pop(int32_t n) {
+  int64_t head = head_.load(std::memory_order_relaxed);
+  head_.store(head + n, std::memory_order_release);
+}
+
+}  // namespace sherpa_onnx
@@ -0,0 +1,88 @@
+// sherpa-onnx/csrc/spsc-ring-buffer.h
+//
+// Copyright (c)  2025  Xiaomi Corporation
+#ifndef SHERPA_ONNX_CSRC_SPSC_RING_BUFFER_H_
+#define SHERPA_ONNX_CSRC_SPSC_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace sherpa_onnx {
+
+/** A lock-free ring buffer of audio samples with a single producer and
+ * a single consumer.
+ *
+ * Push() and PushInt16() may only be called by the producer, while Front(),
+ * Pop() and Clear() may only be called by the consumer. The producer and the
+ * consumer can run concurrently in different threads without locks.
+ * Different threads can take turns being the producer (or the consumer)
+ * as long as they are synchronized with each other, e.g., by a mutex or
+ * an asio strand.
+ */
+class SpscRingBuffer {
+ public:
+  // capacity is rounded up to a power of 2
+  explicit SpscRingBuffer(int32_t capacity);
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+  int32_t Capacity() const { return static_cast<int32_t>(buffer_.size()); }
+
+  // Number of samples in the buffer. It is exact when called by the consumer
+  // and is an upper bound when called by the producer.
+  int32_t Size() const;
+
+  bool Empty() const { return Size() == 0; }
+
+  /** Append n samples.
+   *
+   * @return Return false without writing anything if there is no room for
+   *         all of the n samples.
+   */
+  bool Push(const float *p, int32_t n);
+
+  // Same as Push() but it converts 16-bit PCM samples to floats in the
+  // range [-1, 1)
+  bool PushInt16(const int16_t *p, int32_t n);
+
+  /** Get the longest contiguous run of samples at the front of the buffer.
+   *
+   * @param p On return, it points to the first sample.
+   * @return Return the number of samples *p points to. Return 0 if the
+   *         buffer is empty. There may be more samples after them once
+   *         they are popped since the buffer wraps around.
+   */
+  int32_t Front(const float **p) const;
+
+  // Remove n samples from the front. n must not exceed Size().
+  void Pop(int32_t n);
+
+  // Remove all samples
+  void Clear() { Pop(Size()); }
+
+ private:
+  // Return the index into buffer_ of the first free slot, or -1 if there is
+  // no room for n samples
+  int64_t Reserve(int32_t n) const;
+
+  // Write n samples to the slot returned by Reserve(). f(i, k, dst) writes
+  // the samples [i, i + k) of the input to dst.
+  template <typename F>
+  void Write(int64_t tail, int32_t n, F f);
+
+ private:
+  std::vector<float> buffer_;
+  int64_t mask_;
+
+  // Linear indexes that never wrap around. head_ is written only by the
+  // consumer and tail_ only by the producer. They are on different cache
+  // lines to avoid false sharing.
+  alignas(64) std::atomic<int64_t> head_{0};
+  alignas(64) std::atomic<int64_t> tail_{0};
+};
+
+}  // namespace sherpa_onnx
+
+#endif  // SHERPA_ONNX_CSRC_SPSC_RING_BUFFER_H_
@@ -120,7 +120,7 @@ void TransducerKeywordDecoder::Decode(
         // blank is hardcoded to 0
         // also, it treats unk as blank
         if (new_token != 0 && new_token != unk_id_) {
-          new_hyp.ys.push_back(new_token);
+          new_hyp.AppendToken(new_token);
           new_hyp.timestamps.push_back(t + frame_offset);
           new_hyp.ys_probs.push_back(
               exp(logprobs[hyp_index * vocab_size + new_token]));
@@ -132,7 +132,7 @@ void TransducerKeywordDecoder::Decode(
           new_hyp.context_state = std::get<1>(context_res);
           // Start matching from the start state, forget the decoder history.
           if (new_hyp.context_state->token == -1) {
-            new_hyp.ys = blanks;
+            new_hyp.SetYs(blanks);
             new_hyp.timestamps.clear();
             new_hyp.ys_probs.clear();
           }
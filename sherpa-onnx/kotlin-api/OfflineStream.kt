@@ -4,6 +4,10 @@ class OfflineStream(var ptr: Long) {
     fun acceptWaveform(samples: FloatArray, sampleRate: Int) =
         acceptWaveform(ptr, samples, sampleRate)
 
+    // samples are 16-bit PCM. They are converted to float in C++
+    fun acceptWaveform(samples: ShortArray, sampleRate: Int) =
+        acceptWaveformInt16(ptr, samples, sampleRate)
+
     protected fun finalize() {
         if (ptr != 0L) {
             delete(ptr)
@@ -22,6 +26,7 @@ class OfflineStream(var ptr: Long) {
     }
 
     private external fun acceptWaveform(ptr: Long, samples: FloatArray, sampleRate: Int)
+    private external fun acceptWaveformInt16(ptr: Long, samples: ShortArray, sampleRate: Int)
     private external fun delete(ptr: Long)
 
     companion object {
@@ -4,6 +4,10 @@ class OnlineStream(var ptr: Long = 0) {
     fun acceptWaveform(samples: FloatArray, sampleRate: Int) =
         acceptWaveform(ptr, samples, sampleRate)
 
+    // samples are 16-bit PCM. They are converted to float in C++
+    fun acceptWaveform(samples: ShortArray, sampleRate: Int) =
+        acceptWaveformInt16(ptr, samples, sampleRate)
+
     fun inputFinished() = inputFinished(ptr)
 
     protected fun finalize() {
@@ -24,6 +28,7 @@ class OnlineStream(var ptr: Long = 0) {
     }
 
     private external fun acceptWaveform(ptr: Long, samples: FloatArray, sampleRate: Int)
+    private external fun acceptWaveformInt16(ptr: Long, samples: ShortArray, sampleRate: Int)
     private external fun inputFinished(ptr: Long)
     private external fun delete(ptr: Long)
 
@@ -19,7 +19,9 @@ Args:
     expected by the model, we will do resampling inside.
   waveform:
     A 1-D float32 tensor containing audio samples. It must be normalized
-    to the range [-1, 1].
+    to the range [-1, 1]. It can also be a 1-D numpy array of dtype int16
+    containing 16-bit PCM samples, which are converted to float32 inside
+    sherpa-onnx.
 )";
 
 static void PybindOfflineRecognitionResult(py::module *m) {  // NOLINT
@@ -59,6 +61,16 @@ void PybindOfflineStream(py::module *m) {
           },
           py::arg("sample_rate"), py::arg("waveform"), kAcceptWaveformUsage,
           py::call_guard<py::gil_scoped_release>())
+      // It has to be defined after the float overload above. Otherwise,
+      // pybind11 would cast float arrays to int16.
+      .def(
+          "accept_waveform",
+          [](PyClass &self, float sample_rate,
+             py::array_t<int16_t, py::array::c_style> waveform) {
+            self.AcceptWaveform(sample_rate, waveform.data(), waveform.size());
+          },
+          py::arg("sample_rate"), py::arg("waveform"), kAcceptWaveformUsage,
+          py::call_guard<py::gil_scoped_release>())
       .def_property_readonly("result", &PyClass::GetResult);
 }
 
@@ -15,14 +15,17 @@ void PybindOfflineWhisperModelConfig(py::module *m) {
   using PyClass = OfflineWhisperModelConfig;
   py::class_<PyClass>(*m, "OfflineWhisperModelConfig")
       .def(py::init<const std::string &, const std::string &,
-                    const std::string &, const std::string &, int32_t>(),
+                    const std::string &, const std::string &, int32_t,
+                    int32_t>(),
            py::arg("encoder"), py::arg("decoder"), py::arg("language"),
-           py::arg("task"), py::arg("tail_paddings") = -1)
+           py::arg("task"), py::arg("tail_paddings") = -1,
+           py::arg("max_batch_size") = 8)
       .def_readwrite("encoder", &PyClass::encoder)
       .def_readwrite("decoder", &PyClass::decoder)
       .def_readwrite("language", &PyClass::language)
       .def_readwrite("task", &PyClass::task)
       .def_readwrite("tail_paddings", &PyClass::tail_paddings)
+      .def_readwrite("max_batch_size", &PyClass::max_batch_size)
       .def("__str__", &PyClass::ToString);
 }
 
@@ -51,6 +51,36 @@ static void PybindOnlineRecognizerResult(py::module *m) {
            py::call_guard<py::gil_scoped_release>());
 }
 
+static void PybindOnlineRecognizerStats(py::module *m) {
+  {
+    using PyClass = OnlineRecognizerStageStats;
+    py::class_<PyClass>(*m, "OnlineRecognizerStageStats")
+        .def_readonly("name", &PyClass::name)
+        .def_readonly("count", &PyClass::count)
+        .def_readonly("total_seconds", &PyClass::total_seconds)
+        .def_readonly("mean_ms", &PyClass::mean_ms)
+        .def_readonly("p50_ms", &PyClass::p50_ms)
+        .def_readonly("p95_ms", &PyClass::p95_ms)
+        .def_readonly("p99_ms", &PyClass::p99_ms)
+        .def_readonly("max_ms", &PyClass::max_ms)
+        .def_readonly("rtf", &PyClass::rtf)
+        .def("__str__", &PyClass::ToString);
+  }
+
+  using PyClass = OnlineRecognizerStats;
+  py::class_<PyClass>(*m, "OnlineRecognizerStats")
+      .def_readonly("stages", &PyClass::stages)
+      .def_readonly("decode", &PyClass::decode)
+      .def_readonly("queue_wait", &PyClass::queue_wait)
+      .def_readonly("num_batches", &PyClass::num_batches)
+      .def_readonly("mean_batch_size", &PyClass::mean_batch_size)
+      .def_readonly("max_batch_size", &PyClass::max_batch_size)
+      .def_readonly("audio_seconds", &PyClass::audio_seconds)
+      .def_readonly("rtf", &PyClass::rtf)
+      .def("__str__", &PyClass::ToString)
+      .def("as_json_string", &PyClass::ToString);
+}
+
 static void PybindOnlineRecognizerConfig(py::module *m) {
   using PyClass = OnlineRecognizerConfig;
   py::class_<PyClass>(*m, "OnlineRecognizerConfig")
@@ -85,12 +115,15 @@ static void PybindOnlineRecognizerConfig(py::module *m) {
       .def_readwrite("rule_fsts", &PyClass::rule_fsts)
       .def_readwrite("rule_fars", &PyClass::rule_fars)
       .def_readwrite("reset_encoder", &PyClass::reset_encoder)
+      .def_readwrite("decoder_out_cache_size",
+                     &PyClass::decoder_out_cache_size)
       .def_readwrite("hr", &PyClass::hr)
       .def("__str__", &PyClass::ToString);
 }
 
 void PybindOnlineRecognizer(py::module *m) {
   PybindOnlineRecognizerResult(m);
+  PybindOnlineRecognizerStats(m);
   PybindOnlineRecognizerConfig(m);
 
   using PyClass = OnlineRecognizer;
@@ -121,7 +154,11 @@ void PybindOnlineRecognizer(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("is_endpoint", &PyClass::IsEndpoint,
            py::call_guard<py::gil_scoped_release>())
-      .def("reset", &PyClass::Reset, py::call_guard<py::gil_scoped_release>());
+      .def("reset", &PyClass::Reset, py::call_guard<py::gil_scoped_release>())
+      .def("enable_stats", &PyClass::EnableStats, py::arg("enable") = true)
+      .def("get_stats", &PyClass::GetStats,
+           py::call_guard<py::gil_scoped_release>())
+      .def("reset_stats", &PyClass::ResetStats);
 }
 
 }  // namespace sherpa_onnx
@@ -19,6 +19,7 @@ void PybindOnlineTransducerModelConfig(py::module *m) {
       .def_readwrite("encoder", &PyClass::encoder)
       .def_readwrite("decoder", &PyClass::decoder)
       .def_readwrite("joiner", &PyClass::joiner)
+      .def_readwrite("use_io_binding", &PyClass::use_io_binding)
       .def("__str__", &PyClass::ToString);
 }
 
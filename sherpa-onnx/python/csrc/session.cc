@@ -0,0 +1,57 @@
+// sherpa-onnx/python/csrc/session.cc
+//
+// Copyright (c)  2025  Xiaomi Corporation
+
+#include "sherpa-onnx/python/csrc/session.h"
+
+#include "sherpa-onnx/csrc/session.h"
+
+namespace sherpa_onnx {
+
+void PybindOrtGlobalContext(py::module *m) {
+  using PyClass = OrtGlobalContextConfig;
+  py::class_<PyClass>(*m, "OrtGlobalContextConfig")
+      .def(py::init([](int32_t num_threads, bool share_prepacked_weights) {
+             PyClass config;
+             config.num_threads = num_threads;
+             config.share_prepacked_weights = share_prepacked_weights;
+             return config;
+           }),
+           py::arg("num_threads") = 1,
+           py::arg("share_prepacked_weights") = true)
+      .def_readwrite("num_threads", &PyClass::num_threads)
+      .def_readwrite("share_prepacked_weights",
+                     &PyClass::share_prepacked_weights);
+
+  m->def("init_ort_global_context", &InitOrtGlobalContext, py::arg("config"),
+         "Enable a process-wide ONNX Runtime context with global thread "
+         "pools and shared prepacked weights. It must be called before "
+         "creating any model.");
+
+  m->def(
+      "init_ort_global_context",
+      [](int32_t num_threads, bool share_prepacked_weights) -> bool {
+        PyClass config;
+        config.num_threads = num_threads;
+        config.share_prepacked_weights = share_prepacked_weights;
+        return InitOrtGlobalContext(config);
+      },
+      py::arg("num_threads") = 1, py::arg("share_prepacked_weights") = true,
+      "Enable a process-wide ONNX Runtime context with global thread pools "
+      "and shared prepacked weights. It must be called before creating any "
+      "model.");
+
+  m->def("set_optimized_model_cache_dir", &SetOptimizedModelCacheDir,
+         py::arg("dir"),
+         "Cache optimized models in the given existing directory to speed up "
+         "later loads of the same models. An empty string disables the "
+         "cache. If it is never called, the environment variable "
+         "SHERPA_ONNX_MODEL_CACHE_DIR is used. It should be called before "
+         "creating any model.");
+
+  m->def("get_optimized_model_cache_dir", &GetOptimizedModelCacheDir,
+         "Return the directory of the optimized model cache. It is empty if "
+         "the cache is disabled.");
+}
+
+}  // namespace sherpa_onnx
@@ -33,6 +33,7 @@ from _sherpa_onnx import (
     OnlinePunctuationConfig,
     OnlinePunctuationModelConfig,
     OnlineStream,
+    OrtGlobalContextConfig,
     SileroVadModelConfig,
     SpeakerEmbeddingExtractor,
     SpeakerEmbeddingExtractorConfig,
@@ -44,6 +45,9 @@ from _sherpa_onnx import (
     VadModel,
     VadModelConfig,
     VoiceActivityDetector,
+    get_optimized_model_cache_dir,
+    init_ort_global_context,
+    set_optimized_model_cache_dir,
     write_wave,
 )
 
@@ -627,6 +627,8 @@ class OfflineRecognizer(object):
         hr_dict_dir: str = "",
         hr_rule_fsts: str = "",
         hr_lexicon: str = "",
+        max_batch_size: int = 8,
+        max_active_paths: int = 4,
     ):
         """
         Please refer to
@@ -658,7 +660,9 @@ class OfflineRecognizer(object):
           num_threads:
             Number of threads for neural network computation.
           decoding_method:
-            Valid values: greedy_search.
+            Valid values: greedy_search, beam_search.
+          max_active_paths:
+            Beam size. Used only when decoding_method is beam_search.
           debug:
             True to show debug messages.
           provider:
@@ -669,6 +673,10 @@ class OfflineRecognizer(object):
           rule_fars:
             If not empty, it specifies fst archives for inverse text normalization.
             If there are multiple archives, they are separated by a comma.
+          max_batch_size:
+            Audio longer than 30 seconds is split into windows of at most 30
+            seconds. It is the maximum number of windows that are run through
+            the model together.
         """
         self = cls.__new__(cls)
         model_config = OfflineModelConfig(
@@ -678,6 +686,7 @@ class OfflineRecognizer(object):
                 language=language,
                 task=task,
                 tail_paddings=tail_paddings,
+                max_batch_size=max_batch_size,
             ),
             tokens=tokens,
             num_threads=num_threads,
@@ -695,6 +704,7 @@ class OfflineRecognizer(object):
             feat_config=feat_config,
             model_config=model_config,
             decoding_method=decoding_method,
+            max_active_paths=max_active_paths,
             rule_fsts=rule_fsts,
             rule_fars=rule_fars,
             hr=HomophoneReplacerConfig(
@@ -17,6 +17,7 @@ from _sherpa_onnx import OnlineRecognizer as _Recognizer
 from _sherpa_onnx import (
     OnlineRecognizerConfig,
     OnlineRecognizerResult,
+    OnlineRecognizerStats,
     OnlineStream,
     OnlineTransducerModelConfig,
     OnlineWenetCtcModelConfig,
@@ -900,3 +901,17 @@ class OnlineRecognizer(object):
 
     def reset(self, s: OnlineStream) -> bool:
         return self.recognizer.reset(s)
+
+    def enable_stats(self, enable: bool = True):
+        """Enable or disable the latency statistics of decoding.
+
+        Use :meth:`get_stats` to get p50/p95/p99 latencies and the
+        real-time factor of each stage of decoding.
+        """
+        self.recognizer.enable_stats(enable)
+
+    def get_stats(self) -> OnlineRecognizerStats:
+        return self.recognizer.get_stats()
+
+    def reset_stats(self):
+        self.recognizer.reset_stats()